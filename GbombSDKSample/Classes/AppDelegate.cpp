@@ -1,5 +1,8 @@
 #include "AppDelegate.h"
 #include "HelloWorldScene.h"
+#include "GbombAsyncClient.h"
+#include "2d/CCFontAtlas.h"
+#include "2d/CCFontAtlasCache.h"
 
 #ifdef __ANDROID_API__
 #include "GbombClient.h"
@@ -44,14 +47,17 @@ bool AppDelegate::applicationDidFinishLaunching() {
     // set FPS. the default value is 1.0/60 if you don't call this
     director->setAnimationInterval(1.0 / 60);
 
+    // TTF glyphs rendered by the previous runs are loaded from the writable path
+    FontAtlas::setDiskCacheEnabled(true);
+
     // create a scene. it's an autorelease object
     auto scene = HelloWorld::createScene();
 
     // run
     director->runWithScene(scene);
 
-	IGbombClient *client = GbombClient::getInstance();
-	client->init("dxccs");
+	// queued, so it always reaches the SDK before any call made through GbombAsyncClient
+	GbombAsyncClient::getInstance()->init("dxccs");
 
     return true;
 }
@@ -60,6 +66,9 @@ bool AppDelegate::applicationDidFinishLaunching() {
 void AppDelegate::applicationDidEnterBackground() {
     Director::getInstance()->stopAnimation();
 
+    // the app may be killed in the background
+    FontAtlasCache::saveDiskCache();
+
     // if you use SimpleAudioEngine, it must be pause
     // SimpleAudioEngine::getInstance()->pauseBackgroundMusic();
 }
@@ -0,0 +1,442 @@
+#include "GbombAsyncClient.h"
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <deque>
+#include <vector>
+#include <chrono>
+
+#include "cocos2d.h"
+#include "GbombProductCache.h"
+
+#ifdef __ANDROID_API__
+#include "GbombClient.h"
+#endif
+#if ((defined __APPLE__) || (defined(TARGET_OS_IPHONE)) || defined(TARGET_IPHONE_SIMULATOR))
+#include <PlatformSDK/GbombClient.h>
+#endif
+
+USING_NS_CC;
+
+enum RequestKind {
+	REQUEST_LOGIN,
+	REQUEST_CALL_SERVICE,
+	REQUEST_PRODUCT_LIST,
+	REQUEST_PURCHASE,
+	REQUEST_SUB_PUSH,
+	REQUEST_UNSUB_PUSH,
+	REQUEST_KIND_COUNT
+};
+
+struct GbombAsyncClient::Request {
+	RequestKind kind;
+	// arguments of the SDK call, in the order of IGbombClient
+	std::vector<std::string> args;
+	// every caller waiting for this round trip
+	std::vector<GbombAsyncCallback> callbacks;
+	// game the request was made for, part of the product cache key
+	std::string gameId;
+	std::chrono::steady_clock::time_point issueTime;
+
+	int code;
+	std::string data;
+};
+
+GbombAsyncClient* GbombAsyncClient::s_sharedClient = nullptr;
+
+static std::mutex s_queueMutex;
+static std::condition_variable s_sleepCondition;
+static std::thread s_workerThread;
+static bool s_needQuit = false;
+
+// requests waiting to be issued to the SDK
+static std::deque<GbombAsyncClient::Request*> s_requestQueue;
+// requests answered by the SDK, waiting to be dispatched to the cocos thread
+static std::deque<GbombAsyncClient::Request*> s_responseQueue;
+// the request of each kind the SDK is working on
+static GbombAsyncClient::Request* s_inFlight[REQUEST_KIND_COUNT] = { nullptr };
+
+static std::atomic<unsigned int> s_batchedCallCount(0);
+
+// a request the SDK never answers, e.g. a cancelled login, is failed after this long
+static std::chrono::duration<double> s_requestTimeout(120);
+static const char* TIMEOUT_PAYLOAD = "{\"status\":\"error\",\"message\":\"timeout\"}";
+
+static std::string s_gameId;
+static GbombProductCache s_productCache;
+
+// SDK callbacks carry no user data, so there is one trampoline per kind.
+// data is taken by value without const, which still matches APICallback, so it can be moved
+template<RequestKind kind>
+static void onSDKResult(const int code, std::string data) {
+	std::lock_guard<std::mutex> lock(s_queueMutex);
+	GbombAsyncClient::Request* request = s_inFlight[kind];
+	if (request == nullptr) {
+		return;
+	}
+	s_inFlight[kind] = nullptr;
+	request->code = code;
+	request->data = std::move(data);
+	s_responseQueue.push_back(request);
+	s_sleepCondition.notify_one();
+}
+
+static const APICallback s_trampolines[REQUEST_KIND_COUNT] = {
+	&onSDKResult<REQUEST_LOGIN>,
+	&onSDKResult<REQUEST_CALL_SERVICE>,
+	&onSDKResult<REQUEST_PRODUCT_LIST>,
+	&onSDKResult<REQUEST_PURCHASE>,
+	&onSDKResult<REQUEST_SUB_PUSH>,
+	&onSDKResult<REQUEST_UNSUB_PUSH>
+};
+
+static bool isBatchable(RequestKind kind) {
+	return kind == REQUEST_PRODUCT_LIST || kind == REQUEST_SUB_PUSH;
+}
+
+// the product list is always tracked so a stale cache entry can be refreshed
+static bool isTracked(const GbombAsyncClient::Request* request) {
+	return !request->callbacks.empty() || request->kind == REQUEST_PRODUCT_LIST;
+}
+
+static bool isSameRequest(const GbombAsyncClient::Request* a, const GbombAsyncClient::Request* b) {
+	return a->kind == b->kind && a->args == b->args;
+}
+
+// must be called with s_queueMutex held
+static std::deque<GbombAsyncClient::Request*>::iterator findReadyRequest() {
+	for (auto iter = s_requestQueue.begin(); iter != s_requestQueue.end(); ++iter) {
+		if (s_inFlight[(*iter)->kind] == nullptr) {
+			return iter;
+		}
+	}
+	return s_requestQueue.end();
+}
+
+// must be called with s_queueMutex held, return false if no request is in flight
+static bool findInFlightDeadline(std::chrono::steady_clock::time_point& deadline) {
+	bool found = false;
+	for (int i = 0; i < REQUEST_KIND_COUNT; ++i) {
+		if (s_inFlight[i] != nullptr && (!found || s_inFlight[i]->issueTime < deadline)) {
+			deadline = s_inFlight[i]->issueTime;
+			found = true;
+		}
+	}
+	if (found) {
+		deadline += std::chrono::duration_cast<std::chrono::steady_clock::duration>(s_requestTimeout);
+	}
+	return found;
+}
+
+// must be called with s_queueMutex held, answer the requests in flight for too long with a timeout.
+// A late SDK answer is then dropped by onSDKResult, unless the next request of the kind is already
+// in flight, as the trampolines cannot tell two requests of a kind apart
+static void failExpiredRequests() {
+	auto now = std::chrono::steady_clock::now();
+	for (int i = 0; i < REQUEST_KIND_COUNT; ++i) {
+		GbombAsyncClient::Request* request = s_inFlight[i];
+		if (request != nullptr && now - request->issueTime >= s_requestTimeout) {
+			s_inFlight[i] = nullptr;
+			request->code = GbombResult::CODE_TIMEOUT;
+			request->data = TIMEOUT_PAYLOAD;
+			s_responseQueue.push_back(request);
+		}
+	}
+}
+
+static void issueRequest(RequestKind kind, const std::vector<std::string>& args, APICallback callback) {
+	IGbombClient *client = GbombClient::getInstance();
+
+	switch (kind) {
+	case REQUEST_LOGIN:
+		client->login(callback);
+		break;
+	case REQUEST_CALL_SERVICE:
+		client->callService(args[0], callback);
+		break;
+	case REQUEST_PRODUCT_LIST:
+		client->getProductList(args[0], callback);
+		break;
+	case REQUEST_PURCHASE:
+		client->purchase(args[0], args[1], args[2], args[3], args[4], args[5], args[6], callback);
+		break;
+	case REQUEST_SUB_PUSH:
+		client->subPush(args[0], callback);
+		break;
+	case REQUEST_UNSUB_PUSH:
+		client->unsubPush(args[0], callback);
+		break;
+	default:
+		break;
+	}
+}
+
+GbombAsyncClient* GbombAsyncClient::getInstance() {
+	if (s_sharedClient == nullptr) {
+		s_sharedClient = new GbombAsyncClient();
+	}
+	return s_sharedClient;
+}
+
+void GbombAsyncClient::destroyInstance() {
+	CC_SAFE_DELETE(s_sharedClient);
+}
+
+GbombAsyncClient::GbombAsyncClient() {
+	// loaded before any call can be made, so a getProductList right after a cold start hits the cache
+	s_productCache.load();
+	s_needQuit = false;
+	s_workerThread = std::thread(&GbombAsyncClient::workerThread, this);
+}
+
+GbombAsyncClient::~GbombAsyncClient() {
+	{
+		std::lock_guard<std::mutex> lock(s_queueMutex);
+		s_needQuit = true;
+	}
+	s_sleepCondition.notify_one();
+	if (s_workerThread.joinable()) {
+		s_workerThread.join();
+	}
+
+	std::lock_guard<std::mutex> lock(s_queueMutex);
+	for (auto request : s_requestQueue) {
+		delete request;
+	}
+	s_requestQueue.clear();
+	for (auto request : s_responseQueue) {
+		delete request;
+	}
+	s_responseQueue.clear();
+	for (int i = 0; i < REQUEST_KIND_COUNT; ++i) {
+		CC_SAFE_DELETE(s_inFlight[i]);
+	}
+}
+
+void GbombAsyncClient::enqueue(Request* request) {
+	GbombResultPtr cached;
+	std::vector<GbombAsyncCallback> cachedCallbacks;
+	{
+		std::lock_guard<std::mutex> lock(s_queueMutex);
+		request->gameId = s_gameId;
+
+		// answer from the cache before batching, a hit never waits behind a round trip
+		bool stale = false;
+		if (request->kind == REQUEST_PRODUCT_LIST
+				&& s_productCache.lookup(request->gameId, request->args[0], cached, stale)) {
+			cachedCallbacks.swap(request->callbacks);
+			// a stale entry is served now and refreshed by a round trip nobody waits for
+			if (!stale) {
+				delete request;
+				request = nullptr;
+			}
+		}
+
+		if (request != nullptr && isBatchable(request->kind)) {
+			Request* pending = s_inFlight[request->kind];
+			if (pending == nullptr || !isSameRequest(pending, request)) {
+				pending = nullptr;
+				for (auto queued : s_requestQueue) {
+					if (isSameRequest(queued, request)) {
+						pending = queued;
+						break;
+					}
+				}
+			}
+			if (pending != nullptr) {
+				// a revalidation merged into a pending round trip has no caller to count
+				if (!request->callbacks.empty()) {
+					pending->callbacks.insert(pending->callbacks.end(),
+							request->callbacks.begin(), request->callbacks.end());
+					++s_batchedCallCount;
+				}
+				delete request;
+				request = nullptr;
+			}
+		}
+		if (request != nullptr) {
+			s_requestQueue.push_back(request);
+		}
+	}
+
+	if (!cachedCallbacks.empty()) {
+		Director::getInstance()->getScheduler()->performFunctionInCocosThread([cachedCallbacks, cached] {
+			for (const auto& callback : cachedCallbacks) {
+				callback(cached);
+			}
+		});
+	}
+	if (request != nullptr) {
+		s_sleepCondition.notify_one();
+	}
+}
+
+void GbombAsyncClient::workerThread() {
+	auto scheduler = Director::getInstance()->getScheduler();
+
+	while (true) {
+		Request* request = nullptr;
+		Request* response = nullptr;
+		APICallback trampoline = nullptr;
+
+		// step 1: wait for an answered request, or a request the SDK can take now
+		{
+			std::unique_lock<std::mutex> lock(s_queueMutex);
+			while (true) {
+				failExpiredRequests();
+				if (s_needQuit || !s_responseQueue.empty()
+						|| findReadyRequest() != s_requestQueue.end()) {
+					break;
+				}
+				std::chrono::steady_clock::time_point deadline;
+				if (findInFlightDeadline(deadline)) {
+					s_sleepCondition.wait_until(lock, deadline);
+				} else {
+					s_sleepCondition.wait(lock);
+				}
+			}
+			if (s_needQuit) {
+				break;
+			}
+
+			if (!s_responseQueue.empty()) {
+				response = s_responseQueue.front();
+				s_responseQueue.pop_front();
+			} else {
+				auto iter = findReadyRequest();
+				request = *iter;
+				s_requestQueue.erase(iter);
+
+				request->issueTime = std::chrono::steady_clock::now();
+				if (isTracked(request)) {
+					s_inFlight[request->kind] = request;
+					trampoline = s_trampolines[request->kind];
+				}
+			}
+		}
+
+		// step 2: parse the result here, then hand it to the cocos thread
+		if (response != nullptr) {
+			std::vector<GbombAsyncCallback> callbacks;
+			callbacks.swap(response->callbacks);
+			GbombResultPtr result = std::make_shared<GbombResult>(response->code, std::move(response->data));
+			if (response->kind == REQUEST_PRODUCT_LIST) {
+				std::chrono::duration<double> fetchTime = std::chrono::steady_clock::now() - response->issueTime;
+				s_productCache.store(response->gameId, response->args[0], result, fetchTime.count());
+			}
+			delete response;
+
+			if (!callbacks.empty()) {
+				scheduler->performFunctionInCocosThread([callbacks, result] {
+					for (const auto& callback : callbacks) {
+						callback(result);
+					}
+				});
+			}
+			continue;
+		}
+
+		// step 3: issue the request, the answer comes back through a trampoline.
+		// Only the batchable network calls are issued here, the others may open SDK UI,
+		// which must be driven from the main thread
+		if (isBatchable(request->kind)) {
+			issueRequest(request->kind, request->args, trampoline);
+		} else {
+			RequestKind kind = request->kind;
+			std::vector<std::string> args = request->args;
+			scheduler->performFunctionInCocosThread([kind, args, trampoline] {
+				issueRequest(kind, args, trampoline);
+			});
+		}
+		if (trampoline == nullptr) {
+			delete request;
+		}
+	}
+}
+
+void GbombAsyncClient::init(const std::string& gameId) {
+	{
+		std::lock_guard<std::mutex> lock(s_queueMutex);
+		s_gameId = gameId;
+	}
+	GbombClient::getInstance()->init(gameId);
+}
+
+void GbombAsyncClient::login(const GbombAsyncCallback& callback) {
+	Request* request = new Request();
+	request->kind = REQUEST_LOGIN;
+	request->callbacks.push_back(callback);
+	enqueue(request);
+}
+
+void GbombAsyncClient::callService(const std::string& character_profile, const GbombAsyncCallback& callback) {
+	Request* request = new Request();
+	request->kind = REQUEST_CALL_SERVICE;
+	request->args.push_back(character_profile);
+	if (callback) {
+		request->callbacks.push_back(callback);
+	}
+	enqueue(request);
+}
+
+void GbombAsyncClient::getProductList(const std::string& character_profile, const GbombAsyncCallback& callback) {
+	Request* request = new Request();
+	request->kind = REQUEST_PRODUCT_LIST;
+	request->args.push_back(character_profile);
+	request->callbacks.push_back(callback);
+	enqueue(request);
+}
+
+void GbombAsyncClient::purchase(const std::string& cid,
+		const std::string& server_id,
+		const std::string& item_id,
+		const std::string& onsales_id,
+		const std::string& provider_id,
+		const std::string& character_profile,
+		const std::string& token,
+		const GbombAsyncCallback& callback) {
+	Request* request = new Request();
+	request->kind = REQUEST_PURCHASE;
+	request->args = { cid, server_id, item_id, onsales_id, provider_id, character_profile, token };
+	request->callbacks.push_back(callback);
+	enqueue(request);
+}
+
+void GbombAsyncClient::subPush(const std::string& regid, const GbombAsyncCallback& callback) {
+	Request* request = new Request();
+	request->kind = REQUEST_SUB_PUSH;
+	request->args.push_back(regid);
+	request->callbacks.push_back(callback);
+	enqueue(request);
+}
+
+void GbombAsyncClient::unsubPush(const std::string& regid, const GbombAsyncCallback& callback) {
+	Request* request = new Request();
+	request->kind = REQUEST_UNSUB_PUSH;
+	request->args.push_back(regid);
+	request->callbacks.push_back(callback);
+	enqueue(request);
+}
+
+void GbombAsyncClient::setRequestTimeout(double seconds) {
+	{
+		std::lock_guard<std::mutex> lock(s_queueMutex);
+		s_requestTimeout = std::chrono::duration<double>(seconds);
+	}
+	s_sleepCondition.notify_one();
+}
+
+double GbombAsyncClient::getRequestTimeout() const {
+	std::lock_guard<std::mutex> lock(s_queueMutex);
+	return s_requestTimeout.count();
+}
+
+unsigned int GbombAsyncClient::getBatchedCallCount() const {
+	return s_batchedCallCount;
+}
+
+GbombProductCache* GbombAsyncClient::getProductCache() {
+	return &s_productCache;
+}
@@ -0,0 +1,99 @@
+#ifndef __GBOMB_ASYNC_CLIENT_H__
+#define __GBOMB_ASYNC_CLIENT_H__
+
+#include <string>
+#include <functional>
+
+#include "GbombResult.h"
+
+class GbombProductCache;
+
+/**
+ * Callback of GbombAsyncClient, always invoked in the cocos thread.
+ * @param result, the parsed result, shared by every caller of a batched round trip.
+ *        Read it through GbombProductListView, GbombLoginView or GbombPurchaseReceiptView.
+ */
+typedef std::function<void(const GbombResultPtr& result)> GbombAsyncCallback;
+
+/**
+ * @brief Asynchronous front end of IGbombClient.
+ *
+ * Every call is queued on a dedicated worker thread, so the cocos thread
+ * never blocks on the SDK. The batchable network calls, getProductList and
+ * subPush, are issued from the worker. The others may open SDK UI and are
+ * issued from the cocos thread. Results are delivered back to the cocos
+ * thread through Scheduler::performFunctionInCocosThread. The json payload
+ * is parsed once on the worker thread, see GbombResult.
+ *
+ * The SDK only accepts a plain function pointer as callback, so the client
+ * keeps at most one call of each kind in flight. Calls of getProductList
+ * with the same character_profile, and calls of subPush with the same regid,
+ * that arrive while one is still pending are merged into a single round trip
+ * and every caller receives the same result. A call the SDK does not answer
+ * within the request timeout, e.g. a cancelled login, fails with
+ * GbombResult::CODE_TIMEOUT so later calls of its kind are not held back.
+ */
+class GbombAsyncClient
+{
+public:
+    /** Return the shared instance, the worker thread is started lazily. */
+    static GbombAsyncClient* getInstance();
+
+    /** Stop the worker thread and release the shared instance. Pending callbacks are dropped. */
+    static void destroyInstance();
+
+    /** Same as IGbombClient::init, issued right away so it comes before every later call. */
+    void init(const std::string& gameId);
+
+    void login(const GbombAsyncCallback& callback);
+
+    /**
+     * Open the service dialog.
+     * @param callback, may be nullptr, in which case the call is fire-and-forget.
+     */
+    void callService(const std::string& character_profile, const GbombAsyncCallback& callback);
+
+    /**
+     * Get the product list, answered from the product cache when possible.
+     * Concurrent calls with the same character_profile are batched into one request.
+     */
+    void getProductList(const std::string& character_profile, const GbombAsyncCallback& callback);
+
+    void purchase(const std::string& cid,
+                  const std::string& server_id,
+                  const std::string& item_id,
+                  const std::string& onsales_id,
+                  const std::string& provider_id,
+                  const std::string& character_profile,
+                  const std::string& token,
+                  const GbombAsyncCallback& callback);
+
+    /** Concurrent calls with the same regid are batched into one request. */
+    void subPush(const std::string& regid, const GbombAsyncCallback& callback);
+
+    void unsubPush(const std::string& regid, const GbombAsyncCallback& callback);
+
+    /** Seconds a call may stay unanswered before it fails with GbombResult::CODE_TIMEOUT. Default 120. */
+    void setRequestTimeout(double seconds);
+    double getRequestTimeout() const;
+
+    /** Number of calls that were merged into an already queued request since start up. */
+    unsigned int getBatchedCallCount() const;
+
+    /** The cache answering getProductList, to tune its TTL and read its hit/miss counters. */
+    GbombProductCache* getProductCache();
+
+    /** A queued SDK call, defined in GbombAsyncClient.cpp. */
+    struct Request;
+
+private:
+    GbombAsyncClient();
+    ~GbombAsyncClient();
+
+    void enqueue(Request* request);
+    void workerThread();
+
+    static GbombAsyncClient* s_sharedClient;
+};
+
+#endif // __GBOMB_ASYNC_CLIENT_H__
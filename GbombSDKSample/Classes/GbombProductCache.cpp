@@ -0,0 +1,119 @@
+#include "GbombProductCache.h"
+
+#include <chrono>
+
+#include "cocos2d.h"
+
+USING_NS_CC;
+
+static const char* CACHE_FILE_NAME = "gbomb_product_cache.plist";
+
+static double now() {
+	using namespace std::chrono;
+	return duration_cast<duration<double>>(system_clock::now().time_since_epoch()).count();
+}
+
+GbombProductCache::GbombProductCache()
+: _ttl(300)
+, _maxStaleTime(24 * 60 * 60)
+, _hitCount(0)
+, _staleHitCount(0)
+, _missCount(0)
+, _totalFetchTime(0)
+, _fetchCount(0) {
+}
+
+std::string GbombProductCache::makeKey(const std::string& gameId, const std::string& character_profile) {
+	return gameId + "|" + character_profile;
+}
+
+bool GbombProductCache::lookup(const std::string& gameId, const std::string& character_profile,
+		GbombResultPtr& result, bool& stale) {
+	std::lock_guard<std::mutex> lock(_mutex);
+	auto iter = _entries.find(makeKey(gameId, character_profile));
+	if (iter != _entries.end()) {
+		double age = now() - iter->second.storedTime;
+		double ttl = _ttl;
+		if (age < ttl) {
+			++_hitCount;
+			result = iter->second.result;
+			stale = false;
+			return true;
+		}
+		if (age < ttl + _maxStaleTime) {
+			++_staleHitCount;
+			result = iter->second.result;
+			stale = true;
+			return true;
+		}
+	}
+	++_missCount;
+	return false;
+}
+
+void GbombProductCache::store(const std::string& gameId, const std::string& character_profile,
+		const GbombResultPtr& result, double fetchTime) {
+	if (!result->isSuccess()) {
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock(_mutex);
+	Entry& entry = _entries[makeKey(gameId, character_profile)];
+	entry.result = result;
+	entry.storedTime = now();
+	_totalFetchTime += fetchTime;
+	++_fetchCount;
+	save();
+}
+
+void GbombProductCache::clear() {
+	std::lock_guard<std::mutex> lock(_mutex);
+	_entries.clear();
+	save();
+}
+
+double GbombProductCache::getAverageFetchTime() const {
+	std::lock_guard<std::mutex> lock(_mutex);
+	return _fetchCount > 0 ? _totalFetchTime / _fetchCount : 0;
+}
+
+void GbombProductCache::load() {
+	std::lock_guard<std::mutex> lock(_mutex);
+	if (_filePath.empty()) {
+		_filePath = FileUtils::getInstance()->getWritablePath() + CACHE_FILE_NAME;
+	}
+	if (!FileUtils::getInstance()->isFileExist(_filePath)) {
+		return;
+	}
+
+	ValueMap dict = FileUtils::getInstance()->getValueMapFromFile(_filePath);
+	for (auto& pair : dict) {
+		if (pair.second.getType() != Value::Type::MAP) {
+			continue;
+		}
+		ValueMap& saved = pair.second.asValueMap();
+		std::string data = saved["data"].asString();
+		Entry entry;
+		entry.result = std::make_shared<GbombResult>(saved["code"].asInt(), std::move(data));
+		entry.storedTime = saved["time"].asDouble();
+		if (entry.result->isSuccess()) {
+			_entries[pair.first] = entry;
+		}
+	}
+}
+
+void GbombProductCache::save() {
+	if (_filePath.empty()) {
+		_filePath = FileUtils::getInstance()->getWritablePath() + CACHE_FILE_NAME;
+	}
+
+	ValueMap dict;
+	for (const auto& pair : _entries) {
+		ValueMap saved;
+		saved["code"] = pair.second.result->getCode();
+		saved["data"] = pair.second.result->toJson();
+		saved["time"] = pair.second.storedTime;
+		dict[pair.first] = saved;
+	}
+	FileUtils::getInstance()->writeToFile(dict, _filePath);
+}
@@ -0,0 +1,89 @@
+#ifndef __GBOMB_PRODUCT_CACHE_H__
+#define __GBOMB_PRODUCT_CACHE_H__
+
+#include <string>
+#include <mutex>
+#include <atomic>
+#include <unordered_map>
+
+#include "GbombResult.h"
+
+/**
+ * @brief Cache of getProductList results, keyed by gameId and character_profile.
+ *
+ * An entry younger than the TTL is fresh and answers the call without a round
+ * trip. An entry older than the TTL but younger than TTL + max stale time is
+ * returned at once while GbombAsyncClient refreshes it in the background
+ * (stale-while-revalidate). Older entries are misses.
+ *
+ * Entries are persisted under FileUtils::getWritablePath(), so the shop can be
+ * rendered from the cache right after a cold start. The cache is owned by
+ * GbombAsyncClient and is thread safe.
+ */
+class GbombProductCache
+{
+public:
+    GbombProductCache();
+
+    /** Default 300 seconds. */
+    void setTTL(double seconds) { _ttl = seconds; }
+    double getTTL() const { return _ttl; }
+
+    /** How long an expired entry may still be served while it is refreshed. Default one day. */
+    void setMaxStaleTime(double seconds) { _maxStaleTime = seconds; }
+    double getMaxStaleTime() const { return _maxStaleTime; }
+
+    /**
+     * Look up an entry.
+     * @param result, set to the cached result on a hit.
+     * @param stale, set to true if the entry is expired and should be refreshed.
+     * @return false on a miss.
+     */
+    bool lookup(const std::string& gameId, const std::string& character_profile, GbombResultPtr& result, bool& stale);
+
+    /**
+     * Store a successful result and save the cache to disk.
+     * @param fetchTime, seconds the round trip took, used for getAverageFetchTime().
+     */
+    void store(const std::string& gameId, const std::string& character_profile, const GbombResultPtr& result, double fetchTime);
+
+    /** Drop every entry, in memory and on disk. */
+    void clear();
+
+    /** Load the entries saved by a previous run, GbombAsyncClient calls it before starting its worker thread. */
+    void load();
+
+    unsigned int getHitCount() const { return _hitCount; }
+    unsigned int getStaleHitCount() const { return _staleHitCount; }
+    unsigned int getMissCount() const { return _missCount; }
+
+    /** Average seconds of the round trips that filled the cache, i.e. the latency a hit saves. */
+    double getAverageFetchTime() const;
+
+private:
+    struct Entry {
+        GbombResultPtr result;
+        // seconds since epoch, persisted across runs
+        double storedTime;
+    };
+
+    static std::string makeKey(const std::string& gameId, const std::string& character_profile);
+    // must be called with _mutex held
+    void save();
+
+    std::string _filePath;
+    std::unordered_map<std::string, Entry> _entries;
+    mutable std::mutex _mutex;
+
+    std::atomic<double> _ttl;
+    std::atomic<double> _maxStaleTime;
+
+    std::atomic<unsigned int> _hitCount;
+    std::atomic<unsigned int> _staleHitCount;
+    std::atomic<unsigned int> _missCount;
+
+    double _totalFetchTime;
+    unsigned int _fetchCount;
+};
+
+#endif // __GBOMB_PRODUCT_CACHE_H__
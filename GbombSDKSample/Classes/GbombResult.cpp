@@ -0,0 +1,108 @@
+#include "GbombResult.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "json/stringbuffer.h"
+#include "json/writer.h"
+
+static const rapidjson::Value s_nullValue;
+
+GbombResult::GbombResult(int code, std::string&& data)
+: _code(code)
+, _payload(std::move(data)) {
+	_document.ParseInsitu<0>(&_payload[0]);
+}
+
+std::string GbombResult::toJson() const {
+	if (_document.HasParseError()) {
+		return "";
+	}
+	rapidjson::StringBuffer buffer;
+	rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+	_document.Accept(writer);
+	return buffer.GetString();
+}
+
+bool GbombResult::isSuccess() const {
+	return _code == CODE_OK && strcmp(getStatus(), "success") == 0;
+}
+
+const char* GbombResult::getStatus() const {
+	if (!_document.HasParseError() && _document.IsObject()) {
+		return GbombObjectView(_document).getString("status");
+	}
+	return "";
+}
+
+const char* GbombResult::getMessage() const {
+	if (!_document.HasParseError() && _document.IsObject()) {
+		return GbombObjectView(_document).getString("message");
+	}
+	return "";
+}
+
+const rapidjson::Value& GbombResult::getData() const {
+	if (!_document.HasParseError() && _document.IsObject()) {
+		// operator[] returns a null value for a missing member
+		return _document["data"];
+	}
+	return s_nullValue;
+}
+
+bool GbombObjectView::hasMember(const char* name) const {
+	return _value->IsObject() && _value->HasMember(name);
+}
+
+const char* GbombObjectView::getString(const char* name, const char* defaultValue) const {
+	if (_value->IsObject()) {
+		const rapidjson::Value& member = (*_value)[name];
+		if (member.IsString()) {
+			return member.GetString();
+		}
+	}
+	return defaultValue;
+}
+
+double GbombObjectView::getNumber(const char* name, double defaultValue) const {
+	if (_value->IsObject()) {
+		const rapidjson::Value& member = (*_value)[name];
+		if (member.IsNumber()) {
+			return member.GetDouble();
+		}
+		if (member.IsString()) {
+			return atof(member.GetString());
+		}
+	}
+	return defaultValue;
+}
+
+GbombProductListView::GbombProductListView(const GbombResultPtr& result)
+: _result(result) {
+}
+
+size_t GbombProductListView::size() const {
+	const rapidjson::Value& data = _result->getData();
+	return data.IsArray() ? data.Size() : 0;
+}
+
+GbombProductView GbombProductListView::at(size_t index) const {
+	const rapidjson::Value& data = _result->getData();
+	if (data.IsArray() && index < data.Size()) {
+		return GbombProductView(data[(rapidjson::SizeType) index]);
+	}
+	return GbombProductView(s_nullValue);
+}
+
+GbombProductView GbombProductListView::findByOnsaleId(const char* onsaleId) const {
+	const rapidjson::Value& data = _result->getData();
+	if (data.IsArray()) {
+		for (rapidjson::SizeType i = 0; i < data.Size(); ++i) {
+			GbombProductView product(data[i]);
+			if (strcmp(product.getOnsaleId(), onsaleId) == 0) {
+				return product;
+			}
+		}
+	}
+	return GbombProductView(s_nullValue);
+}
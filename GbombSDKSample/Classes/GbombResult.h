@@ -0,0 +1,146 @@
+#ifndef __GBOMB_RESULT_H__
+#define __GBOMB_RESULT_H__
+
+#include <string>
+#include <memory>
+
+#include "json/document.h"
+
+class GbombResult;
+
+/** Results are immutable once parsed and shared by every callback of a round trip. */
+typedef std::shared_ptr<const GbombResult> GbombResultPtr;
+
+/**
+ * @brief Parsed result of a Gbomb SDK call.
+ *
+ * The JSend payload is parsed exactly once, on the GbombAsyncClient worker
+ * thread, in place: the strings of the document point into the payload the
+ * result owns, nothing is copied. Views below read straight from the parsed
+ * document, strings are valid as long as the result lives.
+ */
+class GbombResult
+{
+public:
+    /** Result code of a successful call. */
+    static const int CODE_OK = 100;
+    /** Result code of a call the SDK did not answer in time, see GbombAsyncClient::setRequestTimeout. */
+    static const int CODE_TIMEOUT = -1;
+
+    /** Parse data in place, it is moved into the result. */
+    GbombResult(int code, std::string&& data);
+
+    int getCode() const { return _code; }
+
+    /** True if the code is CODE_OK and the JSend status is "success". */
+    bool isSuccess() const;
+
+    /** JSend status, "success", "fail" or "error". Empty if the payload could not be parsed. */
+    const char* getStatus() const;
+
+    /** JSend message, only present when the status is "error". */
+    const char* getMessage() const;
+
+    /** The JSend "data" member, a null value if it is missing. */
+    const rapidjson::Value& getData() const;
+
+    /**
+     * The document written back to json, empty if the payload could not be parsed.
+     * The payload itself is overwritten by the parse, it is only used to save results.
+     */
+    std::string toJson() const;
+
+    bool hasParseError() const { return _document.HasParseError(); }
+
+private:
+    int _code;
+    // the buffer the document was parsed in, its strings point into it
+    std::string _payload;
+    rapidjson::Document _document;
+};
+
+/** Read-only accessors over a json object of a result. */
+class GbombObjectView
+{
+public:
+    explicit GbombObjectView(const rapidjson::Value& value) : _value(&value) {}
+
+    bool isValid() const { return _value->IsObject(); }
+    bool hasMember(const char* name) const;
+
+    /** Return the string member, or defaultValue if it is missing or not a string. */
+    const char* getString(const char* name, const char* defaultValue = "") const;
+
+    /** Return the number member, or defaultValue if it is missing. Numbers sent as strings are converted. */
+    double getNumber(const char* name, double defaultValue = 0) const;
+
+protected:
+    const rapidjson::Value* _value;
+};
+
+/** One product of getProductList. */
+class GbombProductView : public GbombObjectView
+{
+public:
+    explicit GbombProductView(const rapidjson::Value& value) : GbombObjectView(value) {}
+
+    const char* getItemId() const { return getString("item_id"); }
+    const char* getOnsaleId() const { return getString("onsale_id"); }
+    const char* getTitle() const { return getString("title"); }
+    const char* getDescription() const { return getString("description"); }
+    const char* getCurrencyCode() const { return getString("currency_code"); }
+    const char* getImageUrl() const { return getString("image_url"); }
+    double getPrice() const { return getNumber("price"); }
+};
+
+/** The product list returned by getProductList, it keeps the result alive. */
+class GbombProductListView
+{
+public:
+    explicit GbombProductListView(const GbombResultPtr& result);
+
+    bool isValid() const { return _result->getData().IsArray(); }
+    size_t size() const;
+    GbombProductView at(size_t index) const;
+
+    /** Return the product with the given onsale_id, or an invalid view. */
+    GbombProductView findByOnsaleId(const char* onsaleId) const;
+
+private:
+    GbombResultPtr _result;
+};
+
+/** The account returned by login, it keeps the result alive. */
+class GbombLoginView : public GbombObjectView
+{
+public:
+    explicit GbombLoginView(const GbombResultPtr& result)
+    : GbombObjectView(result->getData()), _result(result) {}
+
+    const char* getUid() const { return getString("uid"); }
+    const char* getToken() const { return getString("token"); }
+    const char* getUserId() const { return getString("user_id"); }
+    const char* getExpires() const { return getString("expires"); }
+    const char* getProviderId() const { return getString("provider_id"); }
+
+private:
+    GbombResultPtr _result;
+};
+
+/**
+ * The receipt returned by purchase, it keeps the result alive.
+ * Fields are the members of the JSend data object sent by the server.
+ */
+class GbombPurchaseReceiptView : public GbombObjectView
+{
+public:
+    explicit GbombPurchaseReceiptView(const GbombResultPtr& result)
+    : GbombObjectView(result->getData()), _result(result) {}
+
+    bool isPurchased() const { return _result->isSuccess(); }
+
+private:
+    GbombResultPtr _result;
+};
+
+#endif // __GBOMB_RESULT_H__
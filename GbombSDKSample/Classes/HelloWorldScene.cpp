@@ -1,7 +1,12 @@
 #define COCOS2D_DEBUG 1
 
 #include "HelloWorldScene.h"
-
+#include "GbombAsyncClient.h"
+#include "GbombProductCache.h"
+#include "SpriteBenchmarkScene.h"
+#include "RenderQueueSortBenchmarkScene.h"
+#include "MatrixStackBenchmarkScene.h"
+#include "SchedulerBenchmarkScene.h"
 
 #ifdef __ANDROID_API__
 #include "GbombClient.h"
@@ -57,11 +62,20 @@ bool HelloWorld::init() {
 	this->addChild(menu, 1);
 
 	auto item1 = MenuItemFont::create("GetProductList", [&](Ref* sender) {
-		IGbombClient *client = GbombClient::getInstance();
-		client->getProductList("", [](const int code, const std:: string data) {
+		GbombAsyncClient *client = GbombAsyncClient::getInstance();
+		client->getProductList("", [](const GbombResultPtr& result) {
 					CCLOG("start callback");
-					CCLOG("code: %d", code);
-					CCLOG("%s", data.c_str());
+					CCLOG("code: %d", result->getCode());
+					GbombProductListView products(result);
+					for (size_t i = 0; i < products.size(); ++i) {
+						GbombProductView product = products.at(i);
+						CCLOG("%s: %s %g %s", product.getOnsaleId(), product.getTitle(),
+								product.getPrice(), product.getCurrencyCode());
+					}
+					GbombProductCache* cache = GbombAsyncClient::getInstance()->getProductCache();
+					CCLOG("product cache: %u hits, %u stale hits, %u misses, %.3fs per fetch",
+							cache->getHitCount(), cache->getStaleHitCount(), cache->getMissCount(),
+							cache->getAverageFetchTime());
 				});
 	});
 	item1->setFontSize(40);
@@ -116,6 +130,42 @@ bool HelloWorld::init() {
 	menu4->setPosition(Point(item4->getContentSize().width / 2, 600));
 	addChild(menu4);
 
+	auto item5 = MenuItemFont::create("SpriteBenchmark", [](Ref* sender) {
+		Director::getInstance()->pushScene(SpriteBenchmark::createScene());
+	});
+	item5->setFontSize(40);
+	item5->setFontName("Marker Felt");
+	auto menu5 = Menu::create(item5, NULL);
+	menu5->setPosition(Point(item5->getContentSize().width / 2, 200));
+	addChild(menu5);
+
+	auto item6 = MenuItemFont::create("RenderQueueSortBenchmark", [](Ref* sender) {
+		Director::getInstance()->pushScene(RenderQueueSortBenchmark::createScene());
+	});
+	item6->setFontSize(40);
+	item6->setFontName("Marker Felt");
+	auto menu6 = Menu::create(item6, NULL);
+	menu6->setPosition(Point(origin.x + visibleSize.width - item6->getContentSize().width / 2, 200));
+	addChild(menu6);
+
+	auto item7 = MenuItemFont::create("MatrixStackBenchmark", [](Ref* sender) {
+		Director::getInstance()->pushScene(MatrixStackBenchmark::createScene());
+	});
+	item7->setFontSize(40);
+	item7->setFontName("Marker Felt");
+	auto menu7 = Menu::create(item7, NULL);
+	menu7->setPosition(Point(origin.x + visibleSize.width - item7->getContentSize().width / 2, 300));
+	addChild(menu7);
+
+	auto item8 = MenuItemFont::create("SchedulerBenchmark", [](Ref* sender) {
+		Director::getInstance()->pushScene(SchedulerBenchmark::createScene());
+	});
+	item8->setFontSize(40);
+	item8->setFontName("Marker Felt");
+	auto menu8 = Menu::create(item8, NULL);
+	menu8->setPosition(Point(origin.x + visibleSize.width - item8->getContentSize().width / 2, 400));
+	addChild(menu8);
+
 	/////////////////////////////
 	// 3. add your codes below...
 
@@ -0,0 +1,136 @@
+#include "MatrixStackBenchmarkScene.h"
+
+#include <chrono>
+
+USING_NS_CC;
+
+static const int kRuns = 100;
+
+// count chains of depth nodes under root
+static void addChains(Node* root, int count, int depth) {
+	for (int i = 0; i < count; i++) {
+		Node* parent = root;
+		for (int j = 0; j < depth; j++) {
+			auto node = Node::create();
+			node->setPosition(1, 1);
+			parent->addChild(node);
+			parent = node;
+		}
+	}
+}
+
+// a full tree, every node but the leaves has fanOut children
+static void addTree(Node* parent, int fanOut, int depth) {
+	if (depth == 0) {
+		return;
+	}
+	for (int i = 0; i < fanOut; i++) {
+		auto node = Node::create();
+		node->setPosition(1, 1);
+		parent->addChild(node);
+		addTree(node, fanOut, depth - 1);
+	}
+}
+
+static int countNodes(Node* node) {
+	int count = 1;
+	for (auto child : node->getChildren()) {
+		count += countNodes(child);
+	}
+	return count;
+}
+
+// best time of kRuns visits of root, per node
+static double visitNanoseconds(Node* root, bool legacyMatrixStack) {
+	auto renderer = Director::getInstance()->getRenderer();
+	Node::setLegacyMatrixStackEnabled(legacyMatrixStack);
+
+	// the first visit computes the transforms, the next ones visit an unchanged hierarchy
+	root->visit(renderer, Mat4::IDENTITY, Node::FLAGS_TRANSFORM_DIRTY);
+	double best = 0;
+	for (int i = 0; i < kRuns; i++) {
+		auto start = std::chrono::steady_clock::now();
+		root->visit(renderer, Mat4::IDENTITY, 0);
+		std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+		if (i == 0 || elapsed.count() < best) {
+			best = elapsed.count();
+		}
+	}
+	return best / countNodes(root);
+}
+
+Scene* MatrixStackBenchmark::createScene() {
+	auto scene = Scene::create();
+	scene->addChild(MatrixStackBenchmark::create());
+	return scene;
+}
+
+MatrixStackBenchmark::MatrixStackBenchmark() :
+		_resultsLabel(nullptr) {
+}
+
+bool MatrixStackBenchmark::init() {
+	if (!Layer::init()) {
+		return false;
+	}
+
+	Size visibleSize = Director::getInstance()->getVisibleSize();
+	Vec2 origin = Director::getInstance()->getVisibleOrigin();
+
+	auto runItem = MenuItemFont::create("Run", [this](Ref* sender) {
+		runBenchmark();
+	});
+	auto backItem = MenuItemFont::create("Back", [](Ref* sender) {
+		Director::getInstance()->popScene();
+	});
+	auto menu = Menu::create(runItem, backItem, NULL);
+	menu->alignItemsHorizontallyWithPadding(40);
+	menu->setPosition(Vec2(origin.x + visibleSize.width / 2, origin.y + 40));
+	addChild(menu, 1);
+
+	auto titleLabel = LabelTTF::create("Node::visit, legacy matrix stack (ns/node)", "Arial", 24);
+	titleLabel->setPosition(
+			Vec2(origin.x + visibleSize.width / 2,
+					origin.y + visibleSize.height - 30));
+	addChild(titleLabel, 1);
+
+	_resultsLabel = LabelTTF::create("", "Arial", 20);
+	_resultsLabel->setPosition(
+			Vec2(origin.x + visibleSize.width / 2,
+					origin.y + visibleSize.height / 2));
+	addChild(_resultsLabel, 1);
+
+	return true;
+}
+
+void MatrixStackBenchmark::runBenchmark() {
+	bool wasEnabled = Node::isLegacyMatrixStackEnabled();
+
+	Vector<Node*> roots;
+	std::vector<std::string> names;
+	roots.pushBack(Node::create());
+	addChains(roots.back(), 16, 64);
+	names.push_back("16 chains of 64");
+	roots.pushBack(Node::create());
+	addTree(roots.back(), 2, 12);
+	names.push_back("binary, depth 12");
+	roots.pushBack(Node::create());
+	addTree(roots.back(), 4, 6);
+	names.push_back("fan out 4, depth 6");
+
+	std::string results;
+	for (ssize_t i = 0; i < roots.size(); i++) {
+		double withStack = visitNanoseconds(roots.at(i), true);
+		double withoutStack = visitNanoseconds(roots.at(i), false);
+		results += StringUtils::format(
+				"%s, %d nodes: stack %.1f, no stack %.1f, saved %.1f (%.0f%%)\n",
+				names[i].c_str(), countNodes(roots.at(i)), withStack,
+				withoutStack, withStack - withoutStack,
+				100 * (withStack - withoutStack) / withStack);
+	}
+
+	Node::setLegacyMatrixStackEnabled(wasEnabled);
+
+	CCLOG("%s", results.c_str());
+	_resultsLabel->setString(results);
+}
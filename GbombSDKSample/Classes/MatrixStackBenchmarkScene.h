@@ -0,0 +1,31 @@
+#ifndef __MATRIX_STACK_BENCHMARK_SCENE_H__
+#define __MATRIX_STACK_BENCHMARK_SCENE_H__
+
+#include "cocos2d.h"
+
+/**
+ * @brief Times Node::visit on deep hierarchies with and without the legacy
+ * matrix stack, see Node::setLegacyMatrixStackEnabled.
+ *
+ * The hierarchies are made of plain nodes, which draw nothing, so the time
+ * is the cost of the visit itself. They are visited off screen, outside the
+ * frame. The time is per node, the best of a few visits, in nanoseconds.
+ */
+class MatrixStackBenchmark : public cocos2d::Layer
+{
+public:
+	static cocos2d::Scene* createScene();
+
+	virtual bool init();
+
+	CREATE_FUNC(MatrixStackBenchmark);
+
+private:
+	MatrixStackBenchmark();
+
+	void runBenchmark();
+
+	cocos2d::LabelTTF* _resultsLabel;
+};
+
+#endif // __MATRIX_STACK_BENCHMARK_SCENE_H__
@@ -0,0 +1,124 @@
+#include "RenderQueueSortBenchmarkScene.h"
+
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+USING_NS_CC;
+
+static const int kCommandCounts[] = { 1000, 5000, 10000, 50000 };
+static const int kRuns = 5;
+
+// best time of kRuns calls of prepare() then run(), only run() is timed
+template<typename Prepare, typename Run>
+static double bestMicroseconds(Prepare prepare, Run run) {
+	double best = 0;
+	for (int i = 0; i < kRuns; i++) {
+		prepare();
+		auto start = std::chrono::steady_clock::now();
+		run();
+		std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+		if (i == 0 || elapsed.count() < best) {
+			best = elapsed.count();
+		}
+	}
+	return best;
+}
+
+Scene* RenderQueueSortBenchmark::createScene() {
+	auto scene = Scene::create();
+	scene->addChild(RenderQueueSortBenchmark::create());
+	return scene;
+}
+
+RenderQueueSortBenchmark::RenderQueueSortBenchmark() :
+		_resultsLabel(nullptr) {
+}
+
+bool RenderQueueSortBenchmark::init() {
+	if (!Layer::init()) {
+		return false;
+	}
+
+	Size visibleSize = Director::getInstance()->getVisibleSize();
+	Vec2 origin = Director::getInstance()->getVisibleOrigin();
+
+	auto runItem = MenuItemFont::create("Run", [this](Ref* sender) {
+		runBenchmark();
+	});
+	auto backItem = MenuItemFont::create("Back", [](Ref* sender) {
+		Director::getInstance()->popScene();
+	});
+	auto menu = Menu::create(runItem, backItem, NULL);
+	menu->alignItemsHorizontallyWithPadding(40);
+	menu->setPosition(Vec2(origin.x + visibleSize.width / 2, origin.y + 40));
+	addChild(menu, 1);
+
+	auto titleLabel = LabelTTF::create("RenderQueue sort, best of 5 (us)", "Arial", 24);
+	titleLabel->setPosition(
+			Vec2(origin.x + visibleSize.width / 2,
+					origin.y + visibleSize.height - 30));
+	addChild(titleLabel, 1);
+
+	_resultsLabel = LabelTTF::create("", "Arial", 20);
+	_resultsLabel->setPosition(
+			Vec2(origin.x + visibleSize.width / 2,
+					origin.y + visibleSize.height / 2));
+	addChild(_resultsLabel, 1);
+
+	return true;
+}
+
+void RenderQueueSortBenchmark::runBenchmark() {
+	std::string results;
+	for (int count : kCommandCounts) {
+		// positive orders, so every command goes to the sorted part of RenderQueue
+		std::vector<CustomCommand> commands(count);
+		std::vector<RenderCommand*> shuffled(count);
+		for (int i = 0; i < count; i++) {
+			commands[i].init(1 + CCRANDOM_0_1() * 1000);
+			shuffled[i] = &commands[i];
+		}
+
+		std::vector<RenderCommand*> copy;
+		double stdSortTime = bestMicroseconds([&] {
+			copy = shuffled;
+		}, [&] {
+			std::sort(copy.begin(), copy.end(), [](RenderCommand* a, RenderCommand* b) {
+				return a->getGlobalOrder() < b->getGlobalOrder();
+			});
+		});
+
+		RenderQueue queue;
+		auto fillQueue = [&] {
+			queue.clear();
+			for (auto command : shuffled) {
+				queue.push_back(command);
+			}
+		};
+		double sortTime = bestMicroseconds(fillQueue, [&] {
+			queue.sort();
+		});
+		// the queue is left sorted by the last run
+		double sortedTime = bestMicroseconds([] {}, [&] {
+			queue.sort();
+		});
+
+		TransparentRenderQueue transparentQueue;
+		double transparentTime = bestMicroseconds([&] {
+			transparentQueue.clear();
+			for (auto command : shuffled) {
+				transparentQueue.push_back(command);
+			}
+		}, [&] {
+			transparentQueue.sort();
+		});
+
+		results += StringUtils::format(
+				"%d cmds: std::sort %.0f, RenderQueue %.0f, already sorted %.1f, transparent %.0f\n",
+				count, stdSortTime, sortTime, sortedTime, transparentTime);
+	}
+
+	CCLOG("%s", results.c_str());
+	_resultsLabel->setString(results);
+}
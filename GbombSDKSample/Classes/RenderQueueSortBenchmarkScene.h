@@ -0,0 +1,32 @@
+#ifndef __RENDER_QUEUE_SORT_BENCHMARK_SCENE_H__
+#define __RENDER_QUEUE_SORT_BENCHMARK_SCENE_H__
+
+#include "cocos2d.h"
+
+/**
+ * @brief Times the sort of the Renderer queues over 1k to 50k commands.
+ *
+ * The commands get random global orders and are sorted by RenderQueue and
+ * TransparentRenderQueue, then sorted again in the order they were left in,
+ * like the next frame of an unchanged scene. std::sort with the comparator
+ * the queues used before is timed on the same commands for reference. Every
+ * time is the best of a few runs, in microseconds.
+ */
+class RenderQueueSortBenchmark : public cocos2d::Layer
+{
+public:
+	static cocos2d::Scene* createScene();
+
+	virtual bool init();
+
+	CREATE_FUNC(RenderQueueSortBenchmark);
+
+private:
+	RenderQueueSortBenchmark();
+
+	void runBenchmark();
+
+	cocos2d::LabelTTF* _resultsLabel;
+};
+
+#endif // __RENDER_QUEUE_SORT_BENCHMARK_SCENE_H__
@@ -0,0 +1,100 @@
+#include "SchedulerBenchmarkScene.h"
+
+#include <chrono>
+#include <vector>
+
+USING_NS_CC;
+
+static const int kTimerCounts[] = { 1000, 10000, 50000 };
+static const int kTimersPerTarget = 10;
+static const int kFrames = 600;
+static const float kFrameTime = 1.0f / 60;
+
+// average time of a frame in microseconds, calls is set to the number of callbacks made
+static double updateMicroseconds(const std::vector<float>& intervals, bool timerQueue, unsigned int& calls) {
+	auto scheduler = new Scheduler();
+	scheduler->setTimerQueueEnabled(timerQueue);
+
+	std::vector<char> targets(intervals.size() / kTimersPerTarget + 1);
+	calls = 0;
+	for (size_t i = 0; i < intervals.size(); i++) {
+		scheduler->schedule([&calls](float dt) {
+			calls++;
+		}, &targets[i / kTimersPerTarget], intervals[i], false,
+				StringUtils::toString(i));
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	for (int frame = 0; frame < kFrames; frame++) {
+		scheduler->update(kFrameTime);
+	}
+	std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+
+	scheduler->release();
+	return elapsed.count() / kFrames;
+}
+
+Scene* SchedulerBenchmark::createScene() {
+	auto scene = Scene::create();
+	scene->addChild(SchedulerBenchmark::create());
+	return scene;
+}
+
+SchedulerBenchmark::SchedulerBenchmark() :
+		_resultsLabel(nullptr) {
+}
+
+bool SchedulerBenchmark::init() {
+	if (!Layer::init()) {
+		return false;
+	}
+
+	Size visibleSize = Director::getInstance()->getVisibleSize();
+	Vec2 origin = Director::getInstance()->getVisibleOrigin();
+
+	auto runItem = MenuItemFont::create("Run", [this](Ref* sender) {
+		runBenchmark();
+	});
+	auto backItem = MenuItemFont::create("Back", [](Ref* sender) {
+		Director::getInstance()->popScene();
+	});
+	auto menu = Menu::create(runItem, backItem, NULL);
+	menu->alignItemsHorizontallyWithPadding(40);
+	menu->setPosition(Vec2(origin.x + visibleSize.width / 2, origin.y + 40));
+	addChild(menu, 1);
+
+	auto titleLabel = LabelTTF::create("Scheduler::update, 600 frames (us/frame)", "Arial", 24);
+	titleLabel->setPosition(
+			Vec2(origin.x + visibleSize.width / 2,
+					origin.y + visibleSize.height - 30));
+	addChild(titleLabel, 1);
+
+	_resultsLabel = LabelTTF::create("", "Arial", 20);
+	_resultsLabel->setPosition(
+			Vec2(origin.x + visibleSize.width / 2,
+					origin.y + visibleSize.height / 2));
+	addChild(_resultsLabel, 1);
+
+	return true;
+}
+
+void SchedulerBenchmark::runBenchmark() {
+	std::string results;
+	for (int count : kTimerCounts) {
+		std::vector<float> intervals(count);
+		for (int i = 0; i < count; i++) {
+			intervals[i] = 0.05f + CCRANDOM_0_1() * 9.95f;
+		}
+
+		unsigned int hashCalls = 0;
+		unsigned int queueCalls = 0;
+		double hashTime = updateMicroseconds(intervals, false, hashCalls);
+		double queueTime = updateMicroseconds(intervals, true, queueCalls);
+		results += StringUtils::format(
+				"%d timers: hash %.1f (%u calls), timer queue %.1f (%u calls)\n",
+				count, hashTime, hashCalls, queueTime, queueCalls);
+	}
+
+	CCLOG("%s", results.c_str());
+	_resultsLabel->setString(results);
+}
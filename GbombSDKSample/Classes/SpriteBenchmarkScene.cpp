@@ -0,0 +1,207 @@
+#include "SpriteBenchmarkScene.h"
+
+USING_NS_CC;
+
+static const int kSpriteCountStep = 2000;
+
+static const char* getModeName(SpriteBenchmark::Mode mode) {
+	switch (mode) {
+	case SpriteBenchmark::Mode::AUTO_BATCHING:
+		return "Sprite (auto-batching)";
+	case SpriteBenchmark::Mode::SPRITE_BATCH_NODE:
+		return "SpriteBatchNode";
+	case SpriteBenchmark::Mode::INSTANCED:
+		return InstancedSpriteNode::isInstancingSupported() ?
+				"InstancedSpriteNode" : "InstancedSpriteNode (unsupported)";
+	default:
+		return "InstancedSpriteNode (fallback)";
+	}
+}
+
+Scene* SpriteBenchmark::createScene() {
+	auto scene = Scene::create();
+	scene->addChild(SpriteBenchmark::create());
+	return scene;
+}
+
+SpriteBenchmark::SpriteBenchmark() :
+		_mode(Mode::AUTO_BATCHING), _spriteCount(kSpriteCountStep), _spritesParent(
+				nullptr), _instancedNode(nullptr), _modeLabel(nullptr), _statsLabel(
+				nullptr), _afterUpdateListener(nullptr), _afterDrawListener(
+				nullptr), _statsTime(0), _statsFrames(0) {
+}
+
+bool SpriteBenchmark::init() {
+	if (!Layer::init()) {
+		return false;
+	}
+
+	Size visibleSize = Director::getInstance()->getVisibleSize();
+	Vec2 origin = Director::getInstance()->getVisibleOrigin();
+
+	auto modeItem = MenuItemFont::create("Mode", [this](Ref* sender) {
+		_mode = (Mode) (((int) _mode + 1) % (int) Mode::COUNT);
+		createSprites();
+	});
+	auto moreItem = MenuItemFont::create("+", [this](Ref* sender) {
+		_spriteCount += kSpriteCountStep;
+		createSprites();
+	});
+	auto lessItem = MenuItemFont::create("-", [this](Ref* sender) {
+		if (_spriteCount > kSpriteCountStep) {
+			_spriteCount -= kSpriteCountStep;
+			createSprites();
+		}
+	});
+	auto backItem = MenuItemFont::create("Back", [](Ref* sender) {
+		Director::getInstance()->popScene();
+	});
+	auto menu = Menu::create(modeItem, lessItem, moreItem, backItem, NULL);
+	menu->alignItemsHorizontallyWithPadding(40);
+	menu->setPosition(
+			Vec2(origin.x + visibleSize.width / 2, origin.y + 40));
+	addChild(menu, 1);
+
+	_modeLabel = LabelTTF::create("", "Arial", 24);
+	_modeLabel->setPosition(
+			Vec2(origin.x + visibleSize.width / 2,
+					origin.y + visibleSize.height - 30));
+	addChild(_modeLabel, 1);
+
+	_statsLabel = LabelTTF::create("", "Arial", 24);
+	_statsLabel->setPosition(
+			Vec2(origin.x + visibleSize.width / 2,
+					origin.y + visibleSize.height - 60));
+	addChild(_statsLabel, 1);
+
+	createSprites();
+	return true;
+}
+
+void SpriteBenchmark::onEnter() {
+	Layer::onEnter();
+
+	auto dispatcher = Director::getInstance()->getEventDispatcher();
+	_afterUpdateListener = dispatcher->addCustomEventListener(
+			Director::EVENT_AFTER_UPDATE,
+			[this](EventCustom* event) {onAfterUpdate();});
+	_afterDrawListener = dispatcher->addCustomEventListener(
+			Director::EVENT_AFTER_DRAW,
+			[this](EventCustom* event) {onAfterDraw();});
+
+	scheduleUpdate();
+}
+
+void SpriteBenchmark::onExit() {
+	auto dispatcher = Director::getInstance()->getEventDispatcher();
+	dispatcher->removeEventListener(_afterUpdateListener);
+	dispatcher->removeEventListener(_afterDrawListener);
+
+	unscheduleUpdate();
+	Layer::onExit();
+}
+
+void SpriteBenchmark::createSprites() {
+	if (_spritesParent) {
+		removeChild(_spritesParent);
+	}
+	_sprites.clear();
+	_instancedNode = nullptr;
+
+	Size visibleSize = Director::getInstance()->getVisibleSize();
+	Vec2 origin = Director::getInstance()->getVisibleOrigin();
+	auto texture = Director::getInstance()->getTextureCache()->addImage(
+			"CloseNormal.png");
+	Rect rect(0, 0, texture->getContentSize().width,
+			texture->getContentSize().height);
+
+	switch (_mode) {
+	case Mode::AUTO_BATCHING:
+		_spritesParent = Node::create();
+		break;
+	case Mode::SPRITE_BATCH_NODE:
+		_spritesParent = SpriteBatchNode::createWithTexture(texture,
+				_spriteCount);
+		break;
+	default:
+		_instancedNode = InstancedSpriteNode::createWithTexture(texture,
+				_spriteCount);
+		_instancedNode->setInstancingEnabled(_mode == Mode::INSTANCED);
+		_spritesParent = _instancedNode;
+		break;
+	}
+	addChild(_spritesParent, 0);
+
+	_velocities.resize(_spriteCount);
+	for (int i = 0; i < _spriteCount; i++) {
+		Vec2 position(origin.x + CCRANDOM_0_1() * visibleSize.width,
+				origin.y + CCRANDOM_0_1() * visibleSize.height);
+		_velocities[i] = Vec2(CCRANDOM_MINUS1_1() * 100,
+				CCRANDOM_MINUS1_1() * 100);
+
+		if (_instancedNode) {
+			// the ids are 0 to _spriteCount - 1
+			_instancedNode->addInstance(rect, position);
+		} else {
+			auto sprite = Sprite::createWithTexture(texture, rect);
+			sprite->setPosition(position);
+			_spritesParent->addChild(sprite);
+			_sprites.push_back(sprite);
+		}
+	}
+
+	_modeLabel->setString(
+			StringUtils::format("%s, %d sprites", getModeName(_mode),
+					_spriteCount));
+	_statsTime = 0;
+	_statsFrames = 0;
+}
+
+void SpriteBenchmark::update(float dt) {
+	Size visibleSize = Director::getInstance()->getVisibleSize();
+	Vec2 origin = Director::getInstance()->getVisibleOrigin();
+	Rect bounds(origin.x, origin.y, visibleSize.width, visibleSize.height);
+
+	for (int i = 0; i < _spriteCount; i++) {
+		Vec2 position =
+				_instancedNode ?
+						_instancedNode->getInstancePosition(i) :
+						_sprites[i]->getPosition();
+		Vec2& velocity = _velocities[i];
+		position += velocity * dt;
+
+		// bounce on the sides of the screen
+		if (position.x < bounds.getMinX() || position.x > bounds.getMaxX()) {
+			velocity.x = -velocity.x;
+		}
+		if (position.y < bounds.getMinY() || position.y > bounds.getMaxY()) {
+			velocity.y = -velocity.y;
+		}
+
+		if (_instancedNode) {
+			_instancedNode->setInstancePosition(i, position);
+		} else {
+			_sprites[i]->setPosition(position);
+		}
+	}
+}
+
+void SpriteBenchmark::onAfterUpdate() {
+	_frameStart = std::chrono::steady_clock::now();
+}
+
+void SpriteBenchmark::onAfterDraw() {
+	// waits for the GPU, the instanced draw moves the work there
+	glFinish();
+	auto elapsed = std::chrono::steady_clock::now() - _frameStart;
+	_statsTime += std::chrono::duration<float, std::milli>(elapsed).count();
+	_statsFrames++;
+	if (_statsFrames == 30) {
+		float frameTime = _statsTime / _statsFrames;
+		_statsLabel->setString(
+				StringUtils::format("%.2f ms/frame, %.0f sprites/ms",
+						frameTime, _spriteCount / frameTime));
+		_statsTime = 0;
+		_statsFrames = 0;
+	}
+}
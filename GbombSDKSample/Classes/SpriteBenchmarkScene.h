@@ -0,0 +1,64 @@
+#ifndef __SPRITE_BENCHMARK_SCENE_H__
+#define __SPRITE_BENCHMARK_SCENE_H__
+
+#include <chrono>
+#include <vector>
+
+#include "cocos2d.h"
+
+/**
+ * @brief Draws many moving sprites of one texture and shows how many are
+ * drawn per millisecond.
+ *
+ * The same sprites are drawn as Sprite children of the layer (batched by the
+ * Renderer), as children of a SpriteBatchNode, and as instances of an
+ * InstancedSpriteNode, with and without instancing. The time of a frame is
+ * measured from the end of the update to the end of the draw, glFinish()
+ * included, so the time spent by the GPU counts as well.
+ */
+class SpriteBenchmark : public cocos2d::Layer
+{
+public:
+	enum class Mode {
+		AUTO_BATCHING,
+		SPRITE_BATCH_NODE,
+		INSTANCED,
+		INSTANCED_FALLBACK,
+		COUNT
+	};
+
+	static cocos2d::Scene* createScene();
+
+	virtual bool init();
+	virtual void onEnter();
+	virtual void onExit();
+	virtual void update(float dt);
+
+	CREATE_FUNC(SpriteBenchmark);
+
+private:
+	SpriteBenchmark();
+
+	void createSprites();
+	void onAfterUpdate();
+	void onAfterDraw();
+
+	Mode _mode;
+	int _spriteCount;
+
+	cocos2d::Node* _spritesParent;
+	std::vector<cocos2d::Sprite*> _sprites;
+	cocos2d::InstancedSpriteNode* _instancedNode;
+	std::vector<cocos2d::Vec2> _velocities;
+
+	cocos2d::LabelTTF* _modeLabel;
+	cocos2d::LabelTTF* _statsLabel;
+	cocos2d::EventListenerCustom* _afterUpdateListener;
+	cocos2d::EventListenerCustom* _afterDrawListener;
+
+	std::chrono::steady_clock::time_point _frameStart;
+	float _statsTime;
+	int _statsFrames;
+};
+
+#endif // __SPRITE_BENCHMARK_SCENE_H__
@@ -112,22 +112,7 @@ bool ActionInterval::isDone() const
 
 void ActionInterval::step(float dt)
 {
-    if (_firstTick)
-    {
-        _firstTick = false;
-        _elapsed = 0;
-    }
-    else
-    {
-        _elapsed += dt;
-    }
-    
-    this->update(MAX (0,                                  // needed for rewind. elapsed could be negative
-                      MIN(1, _elapsed /
-                          MAX(_duration, FLT_EPSILON)   // division by 0
-                          )
-                      )
-                 );
+    this->update(advance(dt));
 }
 
 void ActionInterval::setAmplitudeRate(float amp)
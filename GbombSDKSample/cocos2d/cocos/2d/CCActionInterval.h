@@ -28,6 +28,7 @@ THE SOFTWARE.
 #ifndef __ACTION_CCINTERVAL_ACTION_H__
 #define __ACTION_CCINTERVAL_ACTION_H__
 
+#include <cfloat>
 #include <vector>
 
 #include "2d/CCAction.h"
@@ -69,6 +70,24 @@ public:
     /** how many seconds had elapsed since the actions started to run. */
     inline float getElapsed(void) { return _elapsed; }
 
+    /** Advances the elapsed time like step() does, and returns the time to pass to update(), between 0 and 1 */
+    inline float advance(float dt)
+    {
+        if (_firstTick)
+        {
+            _firstTick = false;
+            _elapsed = 0;
+        }
+        else
+        {
+            _elapsed += dt;
+        }
+
+        float time = _elapsed / (_duration < FLT_EPSILON ? FLT_EPSILON : _duration);  // division by 0
+        // needed for rewind. elapsed could be negative
+        return time > 0 ? (time < 1 ? time : 1) : 0;
+    }
+
     //extension in GridAction
     void setAmplitudeRate(float amp);
     float getAmplitudeRate(void);
@@ -27,30 +27,116 @@ THE SOFTWARE.
 ****************************************************************************/
 
 #include "2d/CCActionManager.h"
+
+#include <algorithm>
+#include <typeinfo>
+
 #include "2d/CCNode.h"
 #include "2d/CCAction.h"
+#include "2d/CCActionInterval.h"
 #include "base/CCScheduler.h"
 #include "base/ccMacros.h"
-#include "base/ccCArray.h"
-#include "base/uthash.h"
 
 NS_CC_BEGIN
+
+// the actions of these types are stepped without virtual calls
+enum
+{
+    kActionGeneric,
+    kActionMoveTo,
+    kActionScaleTo,
+    kActionFadeTo,
+    kActionRotateTo,
+};
+
+struct ActionEntry
+{
+    Action              *action;
+    int                 type;
+};
+
 //
 // singleton stuff
 //
 typedef struct _hashElement
 {
-    struct _ccArray     *actions;
+    std::vector<ActionEntry> actions;
     Node                *target;
-    int                 actionIndex;
+    ssize_t             targetIndex;
+    ssize_t             actionIndex;
     Action              *currentAction;
     bool                currentActionSalvaged;
     bool                paused;
-    UT_hash_handle      hh;
 } tHashElement;
 
+static int getActionType(Action *action)
+{
+    // only the exact classes, as their subclasses may override update()
+    const std::type_info& type = typeid(*action);
+    if (type == typeid(MoveTo))
+        return kActionMoveTo;
+    if (type == typeid(ScaleTo))
+        return kActionScaleTo;
+    if (type == typeid(FadeTo))
+        return kActionFadeTo;
+    if (type == typeid(RotateTo))
+        return kActionRotateTo;
+    return kActionGeneric;
+}
+
+// steps the action and returns whether it is done
+static bool stepAction(Action *action, int type, float dt)
+{
+    if (type == kActionGeneric)
+    {
+        action->step(dt);
+        return action->isDone();
+    }
+
+    ActionInterval *interval = static_cast<ActionInterval*>(action);
+    float time = interval->advance(dt);
+    switch (type)
+    {
+        case kActionMoveTo:
+            static_cast<MoveTo*>(action)->MoveBy::update(time);
+            break;
+        case kActionScaleTo:
+            static_cast<ScaleTo*>(action)->ScaleTo::update(time);
+            break;
+        case kActionFadeTo:
+            static_cast<FadeTo*>(action)->FadeTo::update(time);
+            break;
+        case kActionRotateTo:
+            static_cast<RotateTo*>(action)->RotateTo::update(time);
+            break;
+    }
+    // ActionInterval::isDone()
+    return interval->getElapsed() >= interval->getDuration();
+}
+
+static ssize_t getIndexOfAction(const tHashElement *element, const Action *action)
+{
+    for (size_t i = 0; i < element->actions.size(); ++i)
+    {
+        if (element->actions[i].action == action)
+        {
+            return i;
+        }
+    }
+    return CC_INVALID_INDEX;
+}
+
+static size_t getTableIndex(const Node *target, size_t mask)
+{
+    // mixes the bits of the address, its low bits are the same for all the targets
+    size_t key = (size_t)target;
+    key = (key ^ (key >> 16)) * 0x45d9f3b;
+    key = key ^ (key >> 16);
+    return key & mask;
+}
+
 ActionManager::ActionManager()
-: _targets(nullptr),
+: _removedTargets(0),
   _currentTarget(nullptr),
   _currentTargetSalvaged(false)
 {
@@ -62,35 +148,150 @@ ActionManager::~ActionManager()
     CCLOGINFO("deallocing ActionManager: %p", this);
 
     removeAllActions();
+
+    for (auto element : _freeElements)
+    {
+        delete element;
+    }
 }
 
 // private
 
-void ActionManager::deleteHashElement(tHashElement *element)
+tHashElement* ActionManager::findHashElement(const Node *target) const
 {
-    ccArrayFree(element->actions);
-    HASH_DEL(_targets, element);
-    element->target->release();
-    free(element);
+    if (_table.empty())
+    {
+        return nullptr;
+    }
+
+    size_t mask = _table.size() - 1;
+    for (size_t i = getTableIndex(target, mask); _table[i] != nullptr; i = (i + 1) & mask)
+    {
+        if (_table[i]->target == target)
+        {
+            return _table[i];
+        }
+    }
+    return nullptr;
+}
+
+void ActionManager::insertInTable(tHashElement *element)
+{
+    // at most half full, the table only grows
+    ssize_t count = (ssize_t)_targets.size() - _removedTargets;
+    if (count * 2 > (ssize_t)_table.size())
+    {
+        std::vector<tHashElement*> table(std::max<size_t>(_table.size() * 2, 64), nullptr);
+        _table.swap(table);
+        for (auto other : table)
+        {
+            if (other)
+            {
+                insertInTable(other);
+            }
+        }
+    }
+
+    size_t mask = _table.size() - 1;
+    size_t i = getTableIndex(element->target, mask);
+    while (_table[i] != nullptr)
+    {
+        i = (i + 1) & mask;
+    }
+    _table[i] = element;
+}
+
+void ActionManager::removeFromTable(tHashElement *element)
+{
+    size_t mask = _table.size() - 1;
+    size_t hole = getTableIndex(element->target, mask);
+    while (_table[hole] != element)
+    {
+        hole = (hole + 1) & mask;
+    }
+
+    // moves back the next elements which wouldn't be found past the hole
+    for (size_t i = (hole + 1) & mask; _table[i] != nullptr; i = (i + 1) & mask)
+    {
+        size_t home = getTableIndex(_table[i]->target, mask);
+        if (((i - home) & mask) >= ((i - hole) & mask))
+        {
+            _table[hole] = _table[i];
+            hole = i;
+        }
+    }
+    _table[hole] = nullptr;
 }
 
-void ActionManager::actionAllocWithHashElement(tHashElement *element)
+tHashElement* ActionManager::createHashElement(Node *target, bool paused)
 {
-    // 4 actions per Node by default
-    if (element->actions == nullptr)
+    // not while update() walks the targets
+    if (_currentTarget == nullptr && _removedTargets > (ssize_t)_targets.size() / 2)
     {
-        element->actions = ccArrayNew(4);
-    }else 
-    if (element->actions->num == element->actions->max)
+        compactTargets();
+    }
+
+    tHashElement *element = nullptr;
+    if (_freeElements.empty())
     {
-        ccArrayDoubleCapacity(element->actions);
+        element = new (std::nothrow) tHashElement();
+    }
+    else
+    {
+        element = _freeElements.back();
+        _freeElements.pop_back();
     }
 
+    target->retain();
+    element->target = target;
+    element->targetIndex = _targets.size();
+    element->actionIndex = 0;
+    element->currentAction = nullptr;
+    element->currentActionSalvaged = false;
+    element->paused = paused;
+
+    _targets.push_back(element);
+    insertInTable(element);
+    return element;
+}
+
+void ActionManager::deleteHashElement(tHashElement *element)
+{
+    removeFromTable(element);
+    _targets[element->targetIndex] = nullptr;
+    ++_removedTargets;
+
+    // the element isn't found any more, deleting the actions or the target may add actions
+    while (!element->actions.empty())
+    {
+        Action *action = element->actions.back().action;
+        element->actions.pop_back();
+        action->release();
+    }
+    element->target->release();
+    element->target = nullptr;
+
+    _freeElements.push_back(element);
+}
+
+void ActionManager::compactTargets()
+{
+    size_t count = 0;
+    for (auto element : _targets)
+    {
+        if (element)
+        {
+            element->targetIndex = count;
+            _targets[count++] = element;
+        }
+    }
+    _targets.resize(count);
+    _removedTargets = 0;
 }
 
 void ActionManager::removeActionAtIndex(ssize_t index, tHashElement *element)
 {
-    Action *action = (Action*)element->actions->arr[index];
+    Action *action = element->actions[index].action;
 
     if (action == element->currentAction && (! element->currentActionSalvaged))
     {
@@ -98,7 +299,7 @@ void ActionManager::removeActionAtIndex(ssize_t index, tHashElement *element)
         element->currentActionSalvaged = true;
     }
 
-    ccArrayRemoveObjectAtIndex(element->actions, index, true);
+    element->actions.erase(element->actions.begin() + index);
 
     // update actionIndex in case we are in tick. looping over the actions
     if (element->actionIndex >= index)
@@ -106,7 +307,9 @@ void ActionManager::removeActionAtIndex(ssize_t index, tHashElement *element)
         element->actionIndex--;
     }
 
-    if (element->actions->num == 0)
+    action->release();
+
+    if (element->actions.empty())
     {
         if (_currentTarget == element)
         {
@@ -123,8 +326,7 @@ void ActionManager::removeActionAtIndex(ssize_t index, tHashElement *element)
 
 void ActionManager::pauseTarget(Node *target)
 {
-    tHashElement *element = nullptr;
-    HASH_FIND_PTR(_targets, &target, element);
+    tHashElement *element = findHashElement(target);
     if (element)
     {
         element->paused = true;
@@ -133,8 +335,7 @@ void ActionManager::pauseTarget(Node *target)
 
 void ActionManager::resumeTarget(Node *target)
 {
-    tHashElement *element = nullptr;
-    HASH_FIND_PTR(_targets, &target, element);
+    tHashElement *element = findHashElement(target);
     if (element)
     {
         element->paused = false;
@@ -145,9 +346,9 @@ Vector<Node*> ActionManager::pauseAllRunningActions()
 {
     Vector<Node*> idsWithActions;
     
-    for (tHashElement *element=_targets; element != nullptr; element = (tHashElement *)element->hh.next) 
+    for (auto element : _targets)
     {
-        if (! element->paused) 
+        if (element && ! element->paused)
         {
             element->paused = true;
             idsWithActions.pushBack(element->target);
@@ -171,36 +372,32 @@ void ActionManager::addAction(Action *action, Node *target, bool paused)
     CCASSERT(action != nullptr, "");
     CCASSERT(target != nullptr, "");
 
-    tHashElement *element = nullptr;
-    // we should convert it to Ref*, because we save it as Ref*
-    Ref *tmp = target;
-    HASH_FIND_PTR(_targets, &tmp, element);
+    tHashElement *element = findHashElement(target);
     if (! element)
     {
-        element = (tHashElement*)calloc(sizeof(*element), 1);
-        element->paused = paused;
-        target->retain();
-        element->target = target;
-        HASH_ADD_PTR(_targets, target, element);
+        element = createHashElement(target, paused);
     }
 
-     actionAllocWithHashElement(element);
- 
-     CCASSERT(! ccArrayContainsObject(element->actions, action), "");
-     ccArrayAppendObject(element->actions, action);
- 
-     action->startWithTarget(target);
+    CCASSERT(getIndexOfAction(element, action) == CC_INVALID_INDEX, "");
+    ActionEntry entry = { action, getActionType(action) };
+    element->actions.push_back(entry);
+    action->retain();
+
+    action->startWithTarget(target);
 }
 
 // remove
 
 void ActionManager::removeAllActions()
 {
-    for (tHashElement *element = _targets; element != nullptr; )
+    // the targets added meanwhile are kept
+    size_t count = _targets.size();
+    for (size_t i = 0; i < count; ++i)
     {
-        auto target = element->target;
-        element = (tHashElement*)element->hh.next;
-        removeAllActionsFromTarget(target);
+        if (_targets[i])
+        {
+            removeAllActionsFromTarget(_targets[i]->target);
+        }
     }
 }
 
@@ -212,19 +409,23 @@ void ActionManager::removeAllActionsFromTarget(Node *target)
         return;
     }
 
-    tHashElement *element = nullptr;
-    HASH_FIND_PTR(_targets, &target, element);
+    tHashElement *element = findHashElement(target);
     if (element)
     {
-        if (ccArrayContainsObject(element->actions, element->currentAction) && (! element->currentActionSalvaged))
+        if (getIndexOfAction(element, element->currentAction) != CC_INVALID_INDEX && (! element->currentActionSalvaged))
         {
             element->currentAction->retain();
             element->currentActionSalvaged = true;
         }
 
-        ccArrayRemoveAllObjects(element->actions);
         if (_currentTarget == element)
         {
+            while (!element->actions.empty())
+            {
+                Action *action = element->actions.back().action;
+                element->actions.pop_back();
+                action->release();
+            }
             _currentTargetSalvaged = true;
         }
         else
@@ -246,12 +447,10 @@ void ActionManager::removeAction(Action *action)
         return;
     }
 
-    tHashElement *element = nullptr;
-    Ref *target = action->getOriginalTarget();
-    HASH_FIND_PTR(_targets, &target, element);
+    tHashElement *element = findHashElement(action->getOriginalTarget());
     if (element)
     {
-        auto i = ccArrayGetIndexOfObject(element->actions, action);
+        auto i = getIndexOfAction(element, action);
         if (i != CC_INVALID_INDEX)
         {
             removeActionAtIndex(i, element);
@@ -268,15 +467,14 @@ void ActionManager::removeActionByTag(int tag, Node *target)
     CCASSERT(tag != Action::INVALID_TAG, "");
     CCASSERT(target != nullptr, "");
 
-    tHashElement *element = nullptr;
-    HASH_FIND_PTR(_targets, &target, element);
+    tHashElement *element = findHashElement(target);
 
     if (element)
     {
-        auto limit = element->actions->num;
+        ssize_t limit = element->actions.size();
         for (int i = 0; i < limit; ++i)
         {
-            Action *action = (Action*)element->actions->arr[i];
+            Action *action = element->actions[i].action;
 
             if (action->getTag() == (int)tag && action->getOriginalTarget() == target)
             {
@@ -292,15 +490,14 @@ void ActionManager::removeAllActionsByTag(int tag, Node *target)
     CCASSERT(tag != Action::INVALID_TAG, "");
     CCASSERT(target != nullptr, "");
     
-    tHashElement *element = nullptr;
-    HASH_FIND_PTR(_targets, &target, element);
+    tHashElement *element = findHashElement(target);
     
     if (element)
     {
-        auto limit = element->actions->num;
+        ssize_t limit = element->actions.size();
         for (int i = 0; i < limit;)
         {
-            Action *action = (Action*)element->actions->arr[i];
+            Action *action = element->actions[i].action;
             
             if (action->getTag() == (int)tag && action->getOriginalTarget() == target)
             {
@@ -323,22 +520,18 @@ Action* ActionManager::getActionByTag(int tag, const Node *target) const
 {
     CCASSERT(tag != Action::INVALID_TAG, "");
 
-    tHashElement *element = nullptr;
-    HASH_FIND_PTR(_targets, &target, element);
+    tHashElement *element = findHashElement(target);
 
     if (element)
     {
-        if (element->actions != nullptr)
+        ssize_t limit = element->actions.size();
+        for (int i = 0; i < limit; ++i)
         {
-            auto limit = element->actions->num;
-            for (int i = 0; i < limit; ++i)
-            {
-                Action *action = (Action*)element->actions->arr[i];
+            Action *action = element->actions[i].action;
 
-                if (action->getTag() == (int)tag)
-                {
-                    return action;
-                }
+            if (action->getTag() == (int)tag)
+            {
+                return action;
             }
         }
         //CCLOG("cocos2d : getActionByTag(tag = %d): Action not found", tag);
@@ -355,11 +548,10 @@ Action* ActionManager::getActionByTag(int tag, const Node *target) const
 // and, it is not possible to get the address of a reference
 ssize_t ActionManager::getNumberOfRunningActionsInTarget(const Node *target) const
 {
-    tHashElement *element = nullptr;
-    HASH_FIND_PTR(_targets, &target, element);
+    tHashElement *element = findHashElement(target);
     if (element)
     {
-        return element->actions ? element->actions->num : 0;
+        return element->actions.size();
     }
 
     return 0;
@@ -368,54 +560,65 @@ ssize_t ActionManager::getNumberOfRunningActionsInTarget(const Node *target) con
 // main loop
 void ActionManager::update(float dt)
 {
-    for (tHashElement *elt = _targets; elt != nullptr; )
+    // the targets added during the loop are updated too
+    for (size_t targetIndex = 0; targetIndex < _targets.size(); ++targetIndex)
     {
+        tHashElement *elt = _targets[targetIndex];
+        if (elt == nullptr)
+        {
+            continue;
+        }
+
         _currentTarget = elt;
         _currentTargetSalvaged = false;
 
         if (! _currentTarget->paused)
         {
-            // The 'actions' MutableArray may change while inside this loop.
-            for (_currentTarget->actionIndex = 0; _currentTarget->actionIndex < _currentTarget->actions->num;
+            // The 'actions' array may change while inside this loop.
+            for (_currentTarget->actionIndex = 0; _currentTarget->actionIndex < (ssize_t)_currentTarget->actions.size();
                 _currentTarget->actionIndex++)
             {
-                _currentTarget->currentAction = (Action*)_currentTarget->actions->arr[_currentTarget->actionIndex];
-                if (_currentTarget->currentAction == nullptr)
-                {
-                    continue;
-                }
+                const ActionEntry& entry = _currentTarget->actions[_currentTarget->actionIndex];
+                Action *action = entry.action;
+                int type = entry.type;
 
+                _currentTarget->currentAction = action;
                 _currentTarget->currentActionSalvaged = false;
 
-                _currentTarget->currentAction->step(dt);
+                bool done = stepAction(action, type, dt);
 
                 if (_currentTarget->currentActionSalvaged)
                 {
                     // The currentAction told the node to remove it. To prevent the action from
                     // accidentally deallocating itself before finishing its step, we retained
                     // it. Now that step is done, it's safe to release it.
-                    _currentTarget->currentAction->release();
+                    action->release();
                 } else
-                if (_currentTarget->currentAction->isDone())
+                if (done)
                 {
-                    _currentTarget->currentAction->stop();
+                    action->stop();
 
-                    Action *action = _currentTarget->currentAction;
                     // Make currentAction nil to prevent removeAction from salvaging it.
                     _currentTarget->currentAction = nullptr;
-                    removeAction(action);
+
+                    // stop() may have changed the actions
+                    ssize_t index = _currentTarget->actionIndex;
+                    if (index < (ssize_t)_currentTarget->actions.size() && _currentTarget->actions[index].action == action)
+                    {
+                        removeActionAtIndex(index, _currentTarget);
+                    }
+                    else
+                    {
+                        removeAction(action);
+                    }
                 }
 
                 _currentTarget->currentAction = nullptr;
             }
         }
 
-        // elt, at this moment, is still valid
-        // so it is safe to ask this here (issue #490)
-        elt = (tHashElement*)(elt->hh.next);
-
         // only delete currentTarget if no actions were scheduled during the cycle (issue #481)
-        if (_currentTargetSalvaged && _currentTarget->actions->num == 0)
+        if (_currentTargetSalvaged && _currentTarget->actions.empty())
         {
             deleteHashElement(_currentTarget);
         }
@@ -423,6 +626,11 @@ void ActionManager::update(float dt)
 
     // issue #635
     _currentTarget = nullptr;
+
+    if (_removedTargets > 0)
+    {
+        compactTargets();
+    }
 }
 
 NS_CC_END
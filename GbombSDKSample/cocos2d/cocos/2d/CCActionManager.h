@@ -29,6 +29,8 @@ THE SOFTWARE.
 #ifndef __ACTION_CCACTION_MANAGER_H__
 #define __ACTION_CCACTION_MANAGER_H__
 
+#include <vector>
+
 #include "2d/CCAction.h"
 #include "base/CCVector.h"
 #include "base/CCRef.h"
@@ -53,6 +55,11 @@ struct _hashElement;
     - When you want to run an action where the target is different from a Node. 
     - When you want to pause / resume the actions
  
+ The actions of a target are kept in an array, in the order they were added, and the targets in an
+ array updated in order. The storage of the removed targets is reused by the next ones, so adding
+ and removing actions doesn't allocate memory once the arrays have grown.
+ MoveTo, ScaleTo, FadeTo and RotateTo are stepped without virtual calls, not their subclasses.
+
  @since v0.8
  */
 class CC_DLL ActionManager : public Ref
@@ -134,10 +141,20 @@ protected:
 
     void removeActionAtIndex(ssize_t index, struct _hashElement *element);
     void deleteHashElement(struct _hashElement *element);
-    void actionAllocWithHashElement(struct _hashElement *element);
+    struct _hashElement* findHashElement(const Node *target) const;
+    struct _hashElement* createHashElement(Node *target, bool paused);
+    void insertInTable(struct _hashElement *element);
+    void removeFromTable(struct _hashElement *element);
+    void compactTargets();
 
 protected:
-    struct _hashElement    *_targets;
+    // the targets in the order they were added, the removed ones are null until compactTargets()
+    std::vector<struct _hashElement*> _targets;
+    ssize_t         _removedTargets;
+    // open addressing table finding the element of a target, its size is a power of 2
+    std::vector<struct _hashElement*> _table;
+    // elements of the removed targets, they keep the capacity of their action arrays
+    std::vector<struct _hashElement*> _freeElements;
     struct _hashElement    *_currentTarget;
     bool            _currentTargetSalvaged;
 };
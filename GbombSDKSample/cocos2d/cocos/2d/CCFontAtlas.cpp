@@ -24,12 +24,29 @@
  ****************************************************************************/
 
 #include "2d/CCFontAtlas.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <vector>
+
 #include "2d/CCFontFreeType.h"
 #include "base/ccUTF8.h"
 #include "base/CCDirector.h"
 #include "base/CCEventListenerCustom.h"
 #include "base/CCEventDispatcher.h"
 #include "base/CCEventType.h"
+#include "platform/CCFileUtils.h"
+#include "deprecated/CCString.h" // For StringUtils::format
+
+#if (CC_TARGET_PLATFORM != CC_PLATFORM_WIN32) && (CC_TARGET_PLATFORM != CC_PLATFORM_WINRT) && (CC_TARGET_PLATFORM != CC_PLATFORM_WP8)
+#define CC_FONT_ATLAS_USE_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 
 NS_CC_BEGIN
@@ -38,6 +55,164 @@ const int FontAtlas::CacheTextureWidth = 512;
 const int FontAtlas::CacheTextureHeight = 512;
 const char* FontAtlas::EVENT_PURGE_TEXTURES = "__cc_FontAtlasPurgeTextures";
 
+bool FontAtlas::_diskCacheEnabled = false;
+
+// MARK: disk cache
+
+// A font is saved as <key>.atlas, with the header and the letters, and <key>_<page>.page, with the pixels of a texture.
+// The files are written on the device that reads them, in its byte order.
+static const char DISK_CACHE_MAGIC[4] = { 'C', 'C', 'F', 'A' };
+static const uint32_t DISK_CACHE_VERSION = 1;
+
+struct DiskCacheHeader
+{
+    char magic[4];
+    uint32_t version;
+    uint32_t fontDataHash;
+    int32_t fontSize;
+    float contentScaleFactor;
+    float outlineSize;
+    uint32_t distanceFieldEnabled;
+    int32_t textureWidth;
+    int32_t textureHeight;
+    int32_t pageDataSize;
+    float commonLineHeight;
+    int32_t fontAscender;
+    int32_t pageCount;
+    float currentPageOrigX;
+    float currentPageOrigY;
+    uint32_t letterCount;
+};
+
+struct DiskCacheLetter
+{
+    uint16_t letteCharUTF16;
+    uint16_t validDefinition;
+    float U;
+    float V;
+    float width;
+    float height;
+    float offsetX;
+    float offsetY;
+    int32_t textureID;
+    int32_t xAdvance;
+    int32_t clipBottom;
+};
+
+// Read only view of a file, mapped in memory where the platform has mmap()
+class DiskCacheFile
+{
+public:
+    DiskCacheFile()
+    : _bytes(nullptr)
+    , _size(0)
+    {
+    }
+
+    ~DiskCacheFile()
+    {
+#if CC_FONT_ATLAS_USE_MMAP
+        if (_bytes)
+        {
+            munmap((void*)_bytes, _size);
+        }
+#endif
+    }
+
+    bool open(const std::string& path)
+    {
+#if CC_FONT_ATLAS_USE_MMAP
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            return false;
+
+        struct stat info;
+        if (fstat(fd, &info) == 0 && info.st_size > 0)
+        {
+            void* bytes = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (bytes != MAP_FAILED)
+            {
+                _bytes = (const unsigned char*)bytes;
+                _size = info.st_size;
+            }
+        }
+        // the mapping stays valid once the file is closed
+        ::close(fd);
+#else
+        _data = FileUtils::getInstance()->getDataFromFile(path);
+        _bytes = _data.getBytes();
+        _size = _data.getSize();
+#endif
+        return _bytes != nullptr;
+    }
+
+    const unsigned char* getBytes() const { return _bytes; }
+    size_t getSize() const { return _size; }
+
+private:
+    const unsigned char* _bytes;
+    size_t _size;
+#if !CC_FONT_ATLAS_USE_MMAP
+    Data _data;
+#endif
+};
+
+// written to a temporary file first, so that a file is never left half written
+static bool writeDiskCacheFile(const std::string& path, const void* data, size_t size)
+{
+    std::string tempPath = path + ".tmp";
+    FILE* file = fopen(tempPath.c_str(), "wb");
+    if (!file)
+        return false;
+
+    bool written = fwrite(data, 1, size, file) == size;
+    written = (fclose(file) == 0) && written;
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_WIN32) || (CC_TARGET_PLATFORM == CC_PLATFORM_WINRT) || (CC_TARGET_PLATFORM == CC_PLATFORM_WP8)
+    // rename() doesn't replace an existing file there
+    remove(path.c_str());
+#endif
+    if (!written || rename(tempPath.c_str(), path.c_str()) != 0)
+    {
+        remove(tempPath.c_str());
+        CCLOG("FontAtlas: failed to write %s", path.c_str());
+        return false;
+    }
+    return true;
+}
+
+static void fillDiskCacheHeader(DiskCacheHeader& header, FontFreeType* fontTTf, int pageDataSize, float commonLineHeight, int fontAscender)
+{
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, DISK_CACHE_MAGIC, sizeof(header.magic));
+    header.version = DISK_CACHE_VERSION;
+    header.fontDataHash = fontTTf->getFontDataHash();
+    header.fontSize = fontTTf->getFontSize();
+    header.contentScaleFactor = CC_CONTENT_SCALE_FACTOR();
+    header.outlineSize = fontTTf->getOutlineSize();
+    header.distanceFieldEnabled = fontTTf->isDistanceFieldEnabled();
+    header.textureWidth = FontAtlas::CacheTextureWidth;
+    header.textureHeight = FontAtlas::CacheTextureHeight;
+    header.pageDataSize = pageDataSize;
+    header.commonLineHeight = commonLineHeight;
+    header.fontAscender = fontAscender;
+}
+
+static bool isSameDiskCacheFont(const DiskCacheHeader& header, const DiskCacheHeader& expected)
+{
+    return memcmp(header.magic, expected.magic, sizeof(header.magic)) == 0
+        && header.version == expected.version
+        && header.fontDataHash == expected.fontDataHash
+        && header.fontSize == expected.fontSize
+        && header.contentScaleFactor == expected.contentScaleFactor
+        && header.outlineSize == expected.outlineSize
+        && header.distanceFieldEnabled == expected.distanceFieldEnabled
+        && header.textureWidth == expected.textureWidth
+        && header.textureHeight == expected.textureHeight
+        && header.pageDataSize == expected.pageDataSize
+        && header.commonLineHeight == expected.commonLineHeight
+        && header.fontAscender == expected.fontAscender;
+}
+
 FontAtlas::FontAtlas(Font &theFont) 
 : _font(&theFont)
 , _currentPageData(nullptr)
@@ -45,6 +220,8 @@ FontAtlas::FontAtlas(Font &theFont)
 , _rendererRecreatedListener(nullptr)
 , _antialiasEnabled(true)
 , _rendererRecreate(false)
+, _diskCacheDirty(false)
+, _diskCacheDetached(false)
 {
     _font->retain();
 
@@ -122,6 +299,13 @@ void FontAtlas::purgeTexturesAtlas()
     FontFreeType* fontTTf = dynamic_cast<FontFreeType*>(_font);
     if (fontTTf && _atlasTextures.size() > 1)
     {
+        // the saved glyphs are kept for the next runs, the layout starting over isn't saved
+        if (_diskCacheEnabled && !_diskCacheDetached)
+        {
+            saveDiskCache();
+            _diskCacheDetached = true;
+        }
+
         for( auto &item: _atlasTextures)
         {
             if (item.first != 0)
@@ -149,6 +333,12 @@ void FontAtlas::listenRendererRecreated(EventCustom *event)
     FontFreeType* fontTTf = dynamic_cast<FontFreeType*>(_font);
     if (fontTTf)
     {
+        bool useDiskCache = _diskCacheEnabled && !_diskCacheDetached;
+        if (useDiskCache)
+        {
+            saveDiskCache();
+        }
+
         for( auto &item: _atlasTextures)
         {
             if (item.first != 0)
@@ -166,6 +356,12 @@ void FontAtlas::listenRendererRecreated(EventCustom *event)
         _currentPageOrigX = 0;
         _currentPageOrigY = 0;
 
+        // the textures come back from the disk, the labels only render the glyphs that weren't saved
+        if (useDiskCache)
+        {
+            loadDiskCache();
+        }
+
         _rendererRecreate = true;
         auto eventDispatcher = Director::getInstance()->getEventDispatcher();
         eventDispatcher->dispatchCustomEvent(EVENT_PURGE_TEXTURES,this);
@@ -255,6 +451,12 @@ bool FontAtlas::prepareLetterDefinitions(const std::u16string& utf16String)
 
                         startY = 0.0f;
 
+                        // no glyph is added to the page anymore
+                        if (_diskCacheEnabled && !_diskCacheDetached)
+                        {
+                            saveDiskCachePage(_currentPage);
+                        }
+
                         _currentPageOrigY = 0;
                         memset(_currentPageData, 0, _currentPageDataSize);
                         _currentPage++;
@@ -309,6 +511,8 @@ bool FontAtlas::prepareLetterDefinitions(const std::u16string& utf16String)
 
     if(existNewLetter)
     {
+        _diskCacheDirty = true;
+
         if (_rendererRecreate)
         {
             _atlasTextures[_currentPage]->initWithData(_currentPageData, _currentPageDataSize, 
@@ -382,4 +586,200 @@ void FontAtlas::setAntiAliasTexParameters()
     }
 }
 
+void FontAtlas::setDiskCacheEnabled(bool enabled)
+{
+    _diskCacheEnabled = enabled;
+}
+
+bool FontAtlas::isDiskCacheEnabled()
+{
+    return _diskCacheEnabled;
+}
+
+std::string FontAtlas::getDiskCacheDirectory()
+{
+    return FileUtils::getInstance()->getWritablePath() + "fontatlas/";
+}
+
+std::string FontAtlas::getDiskCachePath() const
+{
+    FontFreeType* fontTTf = static_cast<FontFreeType*>(_font);
+    return getDiskCacheDirectory() + StringUtils::format("%08x_%d_%d%s_%d",
+                                                        fontTTf->getFontDataHash(),
+                                                        fontTTf->getFontSize(),
+                                                        (int)fontTTf->getOutlineSize(),
+                                                        fontTTf->isDistanceFieldEnabled() ? "_df" : "",
+                                                        (int)(CC_CONTENT_SCALE_FACTOR() * 100));
+}
+
+bool FontAtlas::loadDiskCache()
+{
+    FontFreeType* fontTTf = dynamic_cast<FontFreeType*>(_font);
+    if (fontTTf == nullptr || !_fontLetterDefinitions.empty())
+        return false;
+
+    std::string path = getDiskCachePath();
+    DiskCacheFile file;
+    if (!file.open(path + ".atlas") || file.getSize() < sizeof(DiskCacheHeader))
+        return false;
+
+    DiskCacheHeader header;
+    DiskCacheHeader expected;
+    memcpy(&header, file.getBytes(), sizeof(header));
+    fillDiskCacheHeader(expected, fontTTf, _currentPageDataSize, _commonLineHeight, _fontAscender);
+    if (!isSameDiskCacheFont(header, expected)
+        || header.pageCount < 1
+        || header.letterCount > file.getSize() / sizeof(DiskCacheLetter)
+        || file.getSize() != sizeof(DiskCacheHeader) + header.letterCount * sizeof(DiskCacheLetter)
+        || header.currentPageOrigX < 0 || header.currentPageOrigX > CacheTextureWidth
+        || header.currentPageOrigY < 0 || header.currentPageOrigY >= CacheTextureHeight)
+    {
+        return false;
+    }
+
+    const DiskCacheLetter* letters = (const DiskCacheLetter*)(file.getBytes() + sizeof(DiskCacheHeader));
+    for (uint32_t i = 0; i < header.letterCount; ++i)
+    {
+        if (letters[i].textureID < 0 || letters[i].textureID >= header.pageCount)
+            return false;
+    }
+
+    // all the pages are mapped before the atlas changes, it is left empty if one is missing
+    std::unique_ptr<DiskCacheFile[]> pages(new DiskCacheFile[header.pageCount]);
+    for (int i = 0; i < header.pageCount; ++i)
+    {
+        if (!pages[i].open(StringUtils::format("%s_%d.page", path.c_str(), i))
+            || pages[i].getSize() != (size_t)_currentPageDataSize)
+        {
+            return false;
+        }
+    }
+
+    // the next glyphs are rendered in the last page
+    _currentPage = header.pageCount - 1;
+    _currentPageOrigX = header.currentPageOrigX;
+    _currentPageOrigY = header.currentPageOrigY;
+    memcpy(_currentPageData, pages[_currentPage].getBytes(), _currentPageDataSize);
+
+    // a full page is saved at once but the header only by saveDiskCache(), so a run killed in between leaves
+    // glyphs past the origin the header knows: they are cleared so that new glyphs aren't packed over them
+    auto  pixelFormat = fontTTf->getOutlineSize() > 0 ? Texture2D::PixelFormat::AI88 : Texture2D::PixelFormat::A8;
+    int bytesPerPixel = pixelFormat == Texture2D::PixelFormat::AI88 ? 2 : 1;
+    int originX = (int)_currentPageOrigX;
+    int originY = (int)_currentPageOrigY;
+    int nextLineY = std::min((int)(_currentPageOrigY + _commonLineHeight), CacheTextureHeight);
+    for (int y = originY; y < nextLineY; ++y)
+    {
+        memset(_currentPageData + (y * CacheTextureWidth + originX) * bytesPerPixel, 0,
+               (CacheTextureWidth - originX) * bytesPerPixel);
+    }
+    memset(_currentPageData + nextLineY * CacheTextureWidth * bytesPerPixel, 0,
+           (CacheTextureHeight - nextLineY) * CacheTextureWidth * bytesPerPixel);
+
+    // the full pages are uploaded straight from the mapped files
+    for (int i = 0; i < header.pageCount; ++i)
+    {
+        const unsigned char* pageData = i == _currentPage ? _currentPageData : pages[i].getBytes();
+        if (i == 0)
+        {
+            _atlasTextures[0]->initWithData(pageData, _currentPageDataSize,
+                pixelFormat, CacheTextureWidth, CacheTextureHeight, Size(CacheTextureWidth,CacheTextureHeight) );
+            continue;
+        }
+
+        auto tex = new (std::nothrow) Texture2D;
+        if (_antialiasEnabled)
+        {
+            tex->setAntiAliasTexParameters();
+        }
+        else
+        {
+            tex->setAliasTexParameters();
+        }
+        tex->initWithData(pageData, _currentPageDataSize,
+            pixelFormat, CacheTextureWidth, CacheTextureHeight, Size(CacheTextureWidth,CacheTextureHeight) );
+        addTexture(tex, i);
+        tex->release();
+    }
+
+    _fontLetterDefinitions.reserve(header.letterCount);
+    FontLetterDefinition definition;
+    for (uint32_t i = 0; i < header.letterCount; ++i)
+    {
+        const DiskCacheLetter& letter = letters[i];
+        definition.letteCharUTF16 = letter.letteCharUTF16;
+        definition.validDefinition = letter.validDefinition != 0;
+        definition.U = letter.U;
+        definition.V = letter.V;
+        definition.width = letter.width;
+        definition.height = letter.height;
+        definition.offsetX = letter.offsetX;
+        definition.offsetY = letter.offsetY;
+        definition.textureID = letter.textureID;
+        definition.xAdvance = letter.xAdvance;
+        definition.clipBottom = letter.clipBottom;
+        _fontLetterDefinitions[definition.letteCharUTF16] = definition;
+    }
+
+    _diskCacheDirty = false;
+    return true;
+}
+
+bool FontAtlas::saveDiskCachePage(int page)
+{
+    auto fileUtils = FileUtils::getInstance();
+    std::string directory = getDiskCacheDirectory();
+    if (!fileUtils->isDirectoryExist(directory) && !fileUtils->createDirectory(directory))
+        return false;
+
+    return writeDiskCacheFile(StringUtils::format("%s_%d.page", getDiskCachePath().c_str(), page),
+                              _currentPageData, _currentPageDataSize);
+}
+
+bool FontAtlas::saveDiskCache()
+{
+    FontFreeType* fontTTf = dynamic_cast<FontFreeType*>(_font);
+    if (fontTTf == nullptr || !_diskCacheEnabled || _diskCacheDetached)
+        return false;
+    if (!_diskCacheDirty)
+        return true;
+
+    // the previous pages were saved when they were filled, the header is written last so that it never
+    // refers to a page that isn't saved
+    if (!saveDiskCachePage(_currentPage))
+        return false;
+
+    std::vector<unsigned char> buffer(sizeof(DiskCacheHeader) + _fontLetterDefinitions.size() * sizeof(DiskCacheLetter));
+    DiskCacheHeader* header = (DiskCacheHeader*)buffer.data();
+    fillDiskCacheHeader(*header, fontTTf, _currentPageDataSize, _commonLineHeight, _fontAscender);
+    header->pageCount = _currentPage + 1;
+    header->currentPageOrigX = _currentPageOrigX;
+    header->currentPageOrigY = _currentPageOrigY;
+    header->letterCount = (uint32_t)_fontLetterDefinitions.size();
+
+    DiskCacheLetter* letter = (DiskCacheLetter*)(buffer.data() + sizeof(DiskCacheHeader));
+    for (const auto& item : _fontLetterDefinitions)
+    {
+        const FontLetterDefinition& definition = item.second;
+        letter->letteCharUTF16 = definition.letteCharUTF16;
+        letter->validDefinition = definition.validDefinition;
+        letter->U = definition.U;
+        letter->V = definition.V;
+        letter->width = definition.width;
+        letter->height = definition.height;
+        letter->offsetX = definition.offsetX;
+        letter->offsetY = definition.offsetY;
+        letter->textureID = definition.textureID;
+        letter->xAdvance = definition.xAdvance;
+        letter->clipBottom = definition.clipBottom;
+        ++letter;
+    }
+
+    if (!writeDiskCacheFile(getDiskCachePath() + ".atlas", buffer.data(), buffer.size()))
+        return false;
+
+    _diskCacheDirty = false;
+    return true;
+}
+
 NS_CC_END
@@ -107,9 +107,30 @@ public:
      */
      void setAliasTexParameters();
 
+    /** Enables the cache of the glyphs of TTF fonts on disk, under FileUtils::getWritablePath(), disabled by default.
+     The glyphs rendered by a previous run are restored with the atlas instead of being rendered again by FreeType.
+     The cache of an atlas is keyed by the content of the font file, the font size, the outline, the distance field
+     and the content scale factor.
+     */
+    static void setDiskCacheEnabled(bool enabled);
+    static bool isDiskCacheEnabled();
+    /** Directory of the disk cache, under FileUtils::getWritablePath() */
+    static std::string getDiskCacheDirectory();
+
+    /** Restores the glyphs and textures saved for the font, called when the atlas is created */
+    bool loadDiskCache();
+
+    /** Saves the glyphs rendered since the atlas was loaded or saved.
+     The full textures are saved as soon as the atlas moves to the next one.
+     */
+    bool saveDiskCache();
+
 private:
 
     void relaseTextures();
+    std::string getDiskCachePath() const;
+    bool saveDiskCachePage(int page);
+
     std::unordered_map<ssize_t, Texture2D*> _atlasTextures;
     std::unordered_map<unsigned short, FontLetterDefinition> _fontLetterDefinitions;
     float _commonLineHeight;
@@ -128,6 +149,12 @@ private:
     EventListenerCustom* _rendererRecreatedListener;
     bool _antialiasEnabled;
     bool _rendererRecreate;
+
+    // glyphs were added since the disk cache was loaded or saved
+    bool _diskCacheDirty;
+    // purged, the layout of the pages no longer matches the saved one
+    bool _diskCacheDetached;
+    static bool _diskCacheEnabled;
 };
 
 
@@ -32,6 +32,7 @@
 #include "2d/CCFontAtlas.h"
 #include "2d/CCFontCharMap.h"
 #include "base/CCDirector.h"
+#include "platform/CCFileUtils.h"
 
 NS_CC_BEGIN
 
@@ -45,6 +46,22 @@ void FontAtlasCache::purgeCachedData()
     }
 }
 
+void FontAtlasCache::saveDiskCache()
+{
+    if (!FontAtlas::isDiskCacheEnabled())
+        return;
+
+    for (auto & atlas:_atlasMap)
+    {
+        atlas.second->saveDiskCache();
+    }
+}
+
+void FontAtlasCache::removeDiskCache()
+{
+    FileUtils::getInstance()->removeDirectory(FontAtlas::getDiskCacheDirectory());
+}
+
 FontAtlas * FontAtlasCache::getFontAtlasTTF(const TTFConfig & config)
 {  
     bool useDistanceField = config.distanceFieldEnabled;
@@ -251,6 +268,10 @@ bool FontAtlasCache::releaseFontAtlas(FontAtlas *atlas)
             {
                 if (atlas->getReferenceCount() == 1)
                 {
+                  if (FontAtlas::isDiskCacheEnabled())
+                  {
+                      atlas->saveDiskCache();
+                  }
                   _atlasMap.erase(item.first);
                 }
                 
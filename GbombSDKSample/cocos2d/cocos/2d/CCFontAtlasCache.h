@@ -50,6 +50,15 @@ public:
      It will purge the textures atlas and if multiple texture exist in one FontAtlas.
      */
     static void purgeCachedData();
+
+    /** Saves the glyphs rendered since the last save in the disk cache, if it is enabled.
+     Call it before the app can be killed, like when it enters the background.
+     @see FontAtlas::setDiskCacheEnabled()
+     */
+    static void saveDiskCache();
+
+    /** Removes the glyphs saved on disk by all the runs */
+    static void removeDiskCache();
     
 private: 
     static std::string generateFontName(const std::string& fontFileName, int size, GlyphCollection theGlyphs, bool useDistanceField);
@@ -29,6 +29,7 @@ THE SOFTWARE.
 #include "base/ccUTF8.h"
 #include "platform/CCFileUtils.h"
 #include "edtaa3func.h"
+#include "xxhash.h"
 #include FT_BBOX_H
 
 NS_CC_BEGIN
@@ -42,6 +43,8 @@ typedef struct _DataRef
 {
     Data data;
     unsigned int referenceCount;
+    unsigned int hash;
+    bool hashed;
 }DataRef;
 
 static std::unordered_map<std::string, DataRef> s_cacheFontData;
@@ -94,6 +97,7 @@ FT_Library FontFreeType::getFTLibrary()
 
 FontFreeType::FontFreeType(bool distanceFieldEnabled /* = false */,int outline /* = 0 */)
 : _fontRef(nullptr)
+,_fontSize(0)
 ,_distanceFieldEnabled(distanceFieldEnabled)
 ,_outlineSize(outline)
 ,_stroker(nullptr)
@@ -124,6 +128,7 @@ bool FontFreeType::createFontObject(const std::string &fontName, int fontSize)
     else
     {
         s_cacheFontData[fontName].referenceCount = 1;
+        s_cacheFontData[fontName].hashed = false;
         s_cacheFontData[fontName].data = FileUtils::getInstance()->getDataFromFile(fontName);    
 
         if (s_cacheFontData[fontName].data.isNull())
@@ -147,6 +152,7 @@ bool FontFreeType::createFontObject(const std::string &fontName, int fontSize)
     
     // store the face globally
     _fontRef = face;
+    _fontSize = fontSize;
     
     // done and good
     return true;
@@ -170,9 +176,26 @@ FontFreeType::~FontFreeType()
     }
 }
 
+unsigned int FontFreeType::getFontDataHash() const
+{
+    // hashed once per file, only the disk cache of the atlases needs it
+    DataRef& dataRef = s_cacheFontData[_fontName];
+    if (!dataRef.hashed)
+    {
+        dataRef.hash = XXH32(dataRef.data.getBytes(), (int)dataRef.data.getSize(), 0);
+        dataRef.hashed = true;
+    }
+    return dataRef.hash;
+}
+
 FontAtlas * FontFreeType::createFontAtlas()
 {
     FontAtlas *atlas = new (std::nothrow) FontAtlas(*this);
+    if (FontAtlas::isDiskCacheEnabled())
+    {
+        // the glyphs of the collection found in the cache aren't rendered again
+        atlas->loadDiskCache();
+    }
     if (_usedGlyphs != GlyphCollection::DYNAMIC)
     {
         std::u16string utf16;
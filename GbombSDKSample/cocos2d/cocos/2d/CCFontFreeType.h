@@ -58,6 +58,9 @@ public:
 
     bool     isDistanceFieldEnabled() const { return _distanceFieldEnabled;}
     float    getOutlineSize() const { return _outlineSize; }
+    int      getFontSize() const { return _fontSize; }
+    /** Hash of the content of the font file, the same for the fonts created from the same file */
+    unsigned int getFontDataHash() const;
     void     renderCharAt(unsigned char *dest,int posX, int posY, unsigned char* bitmap,long bitmapWidth,long bitmapHeight); 
 
     virtual FontAtlas   * createFontAtlas() override;
@@ -87,6 +90,7 @@ private:
     FT_Face           _fontRef;
     FT_Stroker        _stroker;
     std::string       _fontName;
+    int               _fontSize;
     bool              _distanceFieldEnabled;
     float             _outlineSize;
 };
@@ -0,0 +1,639 @@
+/****************************************************************************
+Copyright (c) 2014 Chukong Technologies Inc.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+
+#include "2d/CCInstancedSpriteNode.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+#include "2d/CCSpriteFrame.h"
+#include "base/CCConfiguration.h"
+#include "base/CCDirector.h"
+#include "base/CCEventDispatcher.h"
+#include "base/CCEventListenerCustom.h"
+#include "base/CCEventType.h"
+#include "renderer/CCGLProgram.h"
+#include "renderer/CCGLProgramState.h"
+#include "renderer/CCRenderer.h"
+#include "renderer/CCTexture2D.h"
+#include "renderer/CCTextureCache.h"
+#include "renderer/ccGLStateCache.h"
+#include "platform/CCGL.h"
+
+#include "deprecated/CCString.h" // For StringUtils::format
+
+#if CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID
+#include <EGL/egl.h>
+#endif
+
+NS_CC_BEGIN
+
+// MARK: instanced arrays
+
+#if CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID
+
+// the functions of GL_EXT, GL_ANGLE or GL_NV_instanced_arrays, loaded like the VAO functions
+typedef void (GL_APIENTRYP DrawArraysInstancedFunction)(GLenum mode, GLint first, GLsizei count, GLsizei primcount);
+typedef void (GL_APIENTRYP VertexAttribDivisorFunction)(GLuint index, GLuint divisor);
+static DrawArraysInstancedFunction s_drawArraysInstanced = nullptr;
+static VertexAttribDivisorFunction s_vertexAttribDivisor = nullptr;
+
+static bool loadInstancingFunctions()
+{
+    static const char* vendors[] = { "EXT", "ANGLE", "NV" };
+    for (auto vendor : vendors)
+    {
+        if (Configuration::getInstance()->checkForGLExtension(std::string("GL_") + vendor + "_instanced_arrays"))
+        {
+            s_drawArraysInstanced = (DrawArraysInstancedFunction)eglGetProcAddress((std::string("glDrawArraysInstanced") + vendor).c_str());
+            s_vertexAttribDivisor = (VertexAttribDivisorFunction)eglGetProcAddress((std::string("glVertexAttribDivisor") + vendor).c_str());
+            if (s_drawArraysInstanced && s_vertexAttribDivisor)
+                return true;
+        }
+    }
+    return false;
+}
+
+static void drawArraysInstanced(GLenum mode, GLint first, GLsizei count, GLsizei primcount)
+{
+    s_drawArraysInstanced(mode, first, count, primcount);
+}
+
+static void vertexAttribDivisor(GLuint index, GLuint divisor)
+{
+    s_vertexAttribDivisor(index, divisor);
+}
+
+#elif (CC_TARGET_PLATFORM == CC_PLATFORM_IOS && defined(GL_EXT_instanced_arrays)) || CC_TARGET_PLATFORM == CC_PLATFORM_MAC || CC_TARGET_PLATFORM == CC_PLATFORM_WIN32 || CC_TARGET_PLATFORM == CC_PLATFORM_LINUX
+
+static bool loadInstancingFunctions()
+{
+#if CC_TARGET_PLATFORM == CC_PLATFORM_WIN32 || CC_TARGET_PLATFORM == CC_PLATFORM_LINUX
+    // loaded by GLEW
+    return glDrawArraysInstancedARB != nullptr && glVertexAttribDivisorARB != nullptr;
+#else
+    return true;
+#endif
+}
+
+static void drawArraysInstanced(GLenum mode, GLint first, GLsizei count, GLsizei primcount)
+{
+#if CC_TARGET_PLATFORM == CC_PLATFORM_IOS
+    glDrawArraysInstancedEXT(mode, first, count, primcount);
+#else
+    glDrawArraysInstancedARB(mode, first, count, primcount);
+#endif
+}
+
+static void vertexAttribDivisor(GLuint index, GLuint divisor)
+{
+#if CC_TARGET_PLATFORM == CC_PLATFORM_IOS
+    glVertexAttribDivisorEXT(index, divisor);
+#else
+    glVertexAttribDivisorARB(index, divisor);
+#endif
+}
+
+#else
+
+static bool loadInstancingFunctions()
+{
+    return false;
+}
+
+static void drawArraysInstanced(GLenum mode, GLint first, GLsizei count, GLsizei primcount)
+{
+    CCASSERT(false, "Instancing isn't supported");
+}
+
+static void vertexAttribDivisor(GLuint index, GLuint divisor)
+{
+}
+
+#endif
+
+bool InstancedSpriteNode::isInstancingSupported()
+{
+    // checked once, the functions stay valid when the GL context is recreated
+    static bool supported = Configuration::getInstance()->supportsInstancedArrays() && loadInstancingFunctions();
+    return supported;
+}
+
+// the attributes of the shader read once per instance
+static const GLuint INSTANCE_ATTRIBS[] =
+{
+    GLProgram::VERTEX_ATTRIB_COLOR,
+    GLProgram::VERTEX_ATTRIB_TEX_COORD,
+    GLProgram::VERTEX_ATTRIB_TEX_COORD1,
+    GLProgram::VERTEX_ATTRIB_TEX_COORD2,
+};
+
+// MARK: creation
+
+InstancedSpriteNode* InstancedSpriteNode::createWithTexture(Texture2D* tex, ssize_t capacity/* = DEFAULT_CAPACITY*/)
+{
+    InstancedSpriteNode *node = new (std::nothrow) InstancedSpriteNode();
+    if (node && node->initWithTexture(tex, capacity))
+    {
+        node->autorelease();
+        return node;
+    }
+    CC_SAFE_DELETE(node);
+    return nullptr;
+}
+
+InstancedSpriteNode* InstancedSpriteNode::create(const std::string& fileImage, ssize_t capacity/* = DEFAULT_CAPACITY*/)
+{
+    InstancedSpriteNode *node = new (std::nothrow) InstancedSpriteNode();
+    if (node && node->initWithFile(fileImage, capacity))
+    {
+        node->autorelease();
+        return node;
+    }
+    CC_SAFE_DELETE(node);
+    return nullptr;
+}
+
+InstancedSpriteNode::InstancedSpriteNode()
+: _texture(nullptr)
+, _blendFunc(BlendFunc::ALPHA_PREMULTIPLIED)
+, _instancingEnabled(true)
+, _attributesDirty(true)
+, _quadsProgramState(nullptr)
+, _quadsDirty(true)
+{
+    _buffersVBO[0] = _buffersVBO[1] = 0;
+}
+
+InstancedSpriteNode::~InstancedSpriteNode()
+{
+    CC_SAFE_RELEASE(_texture);
+    CC_SAFE_RELEASE(_quadsProgramState);
+
+    glDeleteBuffers(2, _buffersVBO);
+}
+
+bool InstancedSpriteNode::initWithTexture(Texture2D *tex, ssize_t capacity)
+{
+    CCASSERT(tex != nullptr, "Invalid texture");
+    CCASSERT(capacity >= 0, "Capacity must be >= 0");
+
+    _texture = tex;
+    _texture->retain();
+    updateBlendFunc();
+
+    _instances.reserve(capacity);
+    _attributes.reserve(capacity);
+    _indices.reserve(capacity);
+
+    setGLProgramState(GLProgramState::getOrCreateWithGLProgramName(GLProgram::SHADER_NAME_POSITION_TEXTURE_COLOR_INSTANCED));
+    _quadsProgramState = GLProgramState::getOrCreateWithGLProgramName(GLProgram::SHADER_NAME_POSITION_TEXTURE_COLOR_NO_MVP);
+    _quadsProgramState->retain();
+
+    setupBuffers();
+
+#if CC_ENABLE_CACHE_TEXTURE_DATA
+    auto listener = EventListenerCustom::create(EVENT_RENDERER_RECREATED, [this](EventCustom* event){
+        /** listen the event that renderer was recreated on Android/WP8 */
+        this->setupBuffers();
+    });
+
+    _eventDispatcher->addEventListenerWithSceneGraphPriority(listener, this);
+#endif
+
+    return true;
+}
+
+bool InstancedSpriteNode::initWithFile(const std::string& fileImage, ssize_t capacity)
+{
+    Texture2D *texture2D = Director::getInstance()->getTextureCache()->addImage(fileImage);
+    if (texture2D == nullptr)
+    {
+        return false;
+    }
+    return initWithTexture(texture2D, capacity);
+}
+
+void InstancedSpriteNode::setupBuffers()
+{
+    // after the context is recreated, the old names are invalid and not deleted
+    glGenBuffers(2, _buffersVBO);
+
+    // a triangle strip
+    static const GLfloat corners[] = { 0, 0, 1, 0, 0, 1, 1, 1 };
+    glBindBuffer(GL_ARRAY_BUFFER, _buffersVBO[0]);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(corners), corners, GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    _attributesDirty = true;
+
+    CHECK_GL_ERROR_DEBUG();
+}
+
+// MARK: instances
+
+ssize_t InstancedSpriteNode::getIndex(int instanceId) const
+{
+    CCASSERT(instanceId >= 0 && instanceId < (int)_indices.size() && _indices[instanceId] >= 0, "Invalid instance id");
+    return _indices[instanceId];
+}
+
+int InstancedSpriteNode::addInstance(const Rect& rect, const Vec2& position)
+{
+    int instanceId;
+    if (_freeIds.empty())
+    {
+        instanceId = (int)_indices.size();
+        _indices.push_back(-1);
+    }
+    else
+    {
+        instanceId = _freeIds.back();
+        _freeIds.pop_back();
+    }
+
+    ssize_t index = _instances.size();
+    _indices[instanceId] = index;
+
+    Instance instance;
+    instance.id = instanceId;
+    instance.position = position;
+    instance.rotation = 0;
+    instance.scaleX = 1;
+    instance.scaleY = 1;
+    instance.rect = rect;
+    instance.color = Color4B::WHITE;
+    _instances.push_back(instance);
+
+    InstanceAttributes attributes;
+    attributes.color = Color4B::WHITE;
+    _attributes.push_back(attributes);
+
+    updateInstanceTexCoords(index);
+    updateInstanceAxes(index);
+    return instanceId;
+}
+
+int InstancedSpriteNode::addInstanceWithSpriteFrame(SpriteFrame* spriteFrame, const Vec2& position)
+{
+    CCASSERT(spriteFrame != nullptr, "Invalid sprite frame");
+    CCASSERT(spriteFrame->getTexture() == _texture, "The sprite frame must be of the texture of the node");
+    CCASSERT(!spriteFrame->isRotated(), "Rotated sprite frames are not supported");
+
+    return addInstance(spriteFrame->getRect(), position);
+}
+
+void InstancedSpriteNode::removeInstance(int instanceId)
+{
+    ssize_t index = getIndex(instanceId);
+    ssize_t last = _instances.size() - 1;
+    if (index != last)
+    {
+        _instances[index] = _instances[last];
+        _attributes[index] = _attributes[last];
+        _indices[_instances[index].id] = index;
+    }
+    _instances.pop_back();
+    _attributes.pop_back();
+
+    _indices[instanceId] = -1;
+    _freeIds.push_back(instanceId);
+
+    _attributesDirty = _quadsDirty = true;
+}
+
+void InstancedSpriteNode::removeAllInstances()
+{
+    _instances.clear();
+    _attributes.clear();
+    _indices.clear();
+    _freeIds.clear();
+
+    _attributesDirty = _quadsDirty = true;
+}
+
+void InstancedSpriteNode::setInstancePosition(int instanceId, const Vec2& position)
+{
+    ssize_t index = getIndex(instanceId);
+    Instance& instance = _instances[index];
+    InstanceAttributes& attributes = _attributes[index];
+
+    // the axes don't change
+    attributes.origin[0] += position.x - instance.position.x;
+    attributes.origin[1] += position.y - instance.position.y;
+    instance.position = position;
+
+    _attributesDirty = _quadsDirty = true;
+}
+
+const Vec2& InstancedSpriteNode::getInstancePosition(int instanceId) const
+{
+    return _instances[getIndex(instanceId)].position;
+}
+
+void InstancedSpriteNode::setInstanceRotation(int instanceId, float rotation)
+{
+    ssize_t index = getIndex(instanceId);
+    _instances[index].rotation = rotation;
+    updateInstanceAxes(index);
+}
+
+float InstancedSpriteNode::getInstanceRotation(int instanceId) const
+{
+    return _instances[getIndex(instanceId)].rotation;
+}
+
+void InstancedSpriteNode::setInstanceScale(int instanceId, float scaleX, float scaleY)
+{
+    ssize_t index = getIndex(instanceId);
+    _instances[index].scaleX = scaleX;
+    _instances[index].scaleY = scaleY;
+    updateInstanceAxes(index);
+}
+
+void InstancedSpriteNode::setInstanceTransform(int instanceId, const Vec2& position, float rotation, float scaleX, float scaleY)
+{
+    ssize_t index = getIndex(instanceId);
+    Instance& instance = _instances[index];
+    instance.position = position;
+    instance.rotation = rotation;
+    instance.scaleX = scaleX;
+    instance.scaleY = scaleY;
+    updateInstanceAxes(index);
+}
+
+void InstancedSpriteNode::setInstanceColor(int instanceId, const Color4B& color)
+{
+    ssize_t index = getIndex(instanceId);
+    _instances[index].color = color;
+    updateInstanceColor(index);
+}
+
+const Color4B& InstancedSpriteNode::getInstanceColor(int instanceId) const
+{
+    return _instances[getIndex(instanceId)].color;
+}
+
+void InstancedSpriteNode::setInstanceTextureRect(int instanceId, const Rect& rect)
+{
+    ssize_t index = getIndex(instanceId);
+    _instances[index].rect = rect;
+    updateInstanceTexCoords(index);
+    updateInstanceAxes(index);
+}
+
+void InstancedSpriteNode::updateInstanceAxes(ssize_t index)
+{
+    const Instance& instance = _instances[index];
+    InstanceAttributes& attributes = _attributes[index];
+
+    // like Node::getNodeToParentTransform(), centered on the position
+    float radians = -CC_DEGREES_TO_RADIANS(instance.rotation);
+    float c = cosf(radians);
+    float s = sinf(radians);
+    float width = instance.rect.size.width * instance.scaleX;
+    float height = instance.rect.size.height * instance.scaleY;
+
+    attributes.axes[0] = c * width;
+    attributes.axes[1] = s * width;
+    attributes.axes[2] = -s * height;
+    attributes.axes[3] = c * height;
+    attributes.origin[0] = instance.position.x - (attributes.axes[0] + attributes.axes[2]) * 0.5f;
+    attributes.origin[1] = instance.position.y - (attributes.axes[1] + attributes.axes[3]) * 0.5f;
+
+    _attributesDirty = _quadsDirty = true;
+}
+
+void InstancedSpriteNode::updateInstanceTexCoords(ssize_t index)
+{
+    // like Sprite::setTextureCoords()
+    Rect rect = CC_RECT_POINTS_TO_PIXELS(_instances[index].rect);
+    float atlasWidth = (float)_texture->getPixelsWide();
+    float atlasHeight = (float)_texture->getPixelsHigh();
+
+    float left, right, top, bottom;
+#if CC_FIX_ARTIFACTS_BY_STRECHING_TEXEL
+    left    = (2*rect.origin.x+1)/(2*atlasWidth);
+    right   = left + (rect.size.width*2-2)/(2*atlasWidth);
+    top     = (2*rect.origin.y+1)/(2*atlasHeight);
+    bottom  = top + (rect.size.height*2-2)/(2*atlasHeight);
+#else
+    left    = rect.origin.x/atlasWidth;
+    right   = (rect.origin.x + rect.size.width) / atlasWidth;
+    top     = rect.origin.y/atlasHeight;
+    bottom  = (rect.origin.y + rect.size.height) / atlasHeight;
+#endif // ! CC_FIX_ARTIFACTS_BY_STRECHING_TEXEL
+
+    GLfloat* texCoords = _attributes[index].texCoords;
+    texCoords[0] = left;
+    texCoords[1] = bottom;
+    texCoords[2] = right;
+    texCoords[3] = top;
+
+    _attributesDirty = _quadsDirty = true;
+}
+
+void InstancedSpriteNode::updateInstanceColor(ssize_t index)
+{
+    const Color4B& color = _instances[index].color;
+    Color4B& instanceColor = _attributes[index].color;
+    instanceColor = color;
+
+    // like the quads of the sprites
+    if (_texture->hasPremultipliedAlpha())
+    {
+        instanceColor.r = color.r * color.a / 255;
+        instanceColor.g = color.g * color.a / 255;
+        instanceColor.b = color.b * color.a / 255;
+    }
+
+    _attributesDirty = _quadsDirty = true;
+}
+
+// MARK: draw
+
+void InstancedSpriteNode::updateQuads()
+{
+    _quads.resize(_attributes.size());
+
+    for (size_t i = 0; i < _attributes.size(); ++i)
+    {
+        const InstanceAttributes& attributes = _attributes[i];
+        V3F_C4B_T2F_Quad& quad = _quads[i];
+
+        float x = attributes.origin[0];
+        float y = attributes.origin[1];
+        quad.bl.vertices.set(x, y, 0);
+        quad.br.vertices.set(x + attributes.axes[0], y + attributes.axes[1], 0);
+        quad.tl.vertices.set(x + attributes.axes[2], y + attributes.axes[3], 0);
+        quad.tr.vertices.set(x + attributes.axes[0] + attributes.axes[2], y + attributes.axes[1] + attributes.axes[3], 0);
+
+        quad.bl.colors = quad.br.colors = quad.tl.colors = quad.tr.colors = attributes.color;
+
+        const GLfloat* texCoords = attributes.texCoords;
+        quad.bl.texCoords = Tex2F(texCoords[0], texCoords[1]);
+        quad.br.texCoords = Tex2F(texCoords[2], texCoords[1]);
+        quad.tl.texCoords = Tex2F(texCoords[0], texCoords[3]);
+        quad.tr.texCoords = Tex2F(texCoords[2], texCoords[3]);
+    }
+
+    _quadsDirty = false;
+}
+
+void InstancedSpriteNode::draw(Renderer *renderer, const Mat4 &transform, uint32_t flags)
+{
+    if (_instances.empty())
+    {
+        return;
+    }
+
+    if (isInstancingEnabled())
+    {
+        _customCommand.init(_globalZOrder);
+        _customCommand.func = CC_CALLBACK_0(InstancedSpriteNode::onDraw, this, transform, flags);
+        renderer->addCommand(&_customCommand);
+        return;
+    }
+
+    if (_quadsDirty)
+    {
+        updateQuads();
+    }
+
+    // split in commands the Renderer can batch, a QuadCommand shares indices for up to VBO_SIZE vertices
+    ssize_t maxQuads = std::min(renderer->getMaxBatchVertices() / 4, renderer->getMaxBatchIndices() / 6);
+    maxQuads = std::min(maxQuads, (ssize_t)Renderer::VBO_SIZE / 4);
+    ssize_t quadCount = _quads.size();
+    ssize_t commandCount = (quadCount + maxQuads - 1) / maxQuads;
+    if ((ssize_t)_quadCommands.size() < commandCount)
+    {
+        _quadCommands.resize(commandCount);
+    }
+
+    for (ssize_t i = 0; i < commandCount; ++i)
+    {
+        ssize_t first = i * maxQuads;
+        _quadCommands[i].init(_globalZOrder, _texture->getName(), _quadsProgramState, _blendFunc,
+                              &_quads[first], std::min(maxQuads, quadCount - first), transform);
+        renderer->addCommand(&_quadCommands[i]);
+    }
+}
+
+void InstancedSpriteNode::onDraw(const Mat4 &transform, uint32_t flags)
+{
+    auto glProgram = getGLProgram();
+    glProgram->use();
+    glProgram->setUniformsForBuiltins(transform);
+
+    GL::bindTexture2D(_texture->getName());
+    GL::blendFunc(_blendFunc.src, _blendFunc.dst);
+    GL::enableVertexAttribs(GL::VERTEX_ATTRIB_FLAG_POS_COLOR_TEX
+                            | (1 << GLProgram::VERTEX_ATTRIB_TEX_COORD1)
+                            | (1 << GLProgram::VERTEX_ATTRIB_TEX_COORD2));
+
+    glBindBuffer(GL_ARRAY_BUFFER, _buffersVBO[0]);
+    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 2, GL_FLOAT, GL_FALSE, 0, (GLvoid*)0);
+
+    glBindBuffer(GL_ARRAY_BUFFER, _buffersVBO[1]);
+    if (_attributesDirty)
+    {
+        // a new store, the GPU may still draw from the previous one
+        glBufferData(GL_ARRAY_BUFFER, sizeof(InstanceAttributes) * _attributes.size(), _attributes.data(), GL_DYNAMIC_DRAW);
+        _attributesDirty = false;
+    }
+    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_COLOR, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(InstanceAttributes), (GLvoid*)offsetof(InstanceAttributes, color));
+    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_TEX_COORD, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceAttributes), (GLvoid*)offsetof(InstanceAttributes, texCoords));
+    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_TEX_COORD1, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceAttributes), (GLvoid*)offsetof(InstanceAttributes, axes));
+    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_TEX_COORD2, 2, GL_FLOAT, GL_FALSE, sizeof(InstanceAttributes), (GLvoid*)offsetof(InstanceAttributes, origin));
+
+    for (auto attrib : INSTANCE_ATTRIBS)
+    {
+        vertexAttribDivisor(attrib, 1);
+    }
+
+    drawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, (GLsizei)_attributes.size());
+
+    // the other commands read their attributes per vertex
+    for (auto attrib : INSTANCE_ATTRIBS)
+    {
+        vertexAttribDivisor(attrib, 0);
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    CC_INCREMENT_GL_DRAWN_BATCHES_AND_VERTICES(1, 4 * _attributes.size());
+    CHECK_GL_ERROR_DEBUG();
+}
+
+// MARK: TextureProtocol
+
+void InstancedSpriteNode::updateBlendFunc()
+{
+    if (! _texture->hasPremultipliedAlpha())
+        _blendFunc = BlendFunc::ALPHA_NON_PREMULTIPLIED;
+    else
+        _blendFunc = BlendFunc::ALPHA_PREMULTIPLIED;
+}
+
+void InstancedSpriteNode::setBlendFunc(const BlendFunc &blendFunc)
+{
+    _blendFunc = blendFunc;
+}
+
+const BlendFunc& InstancedSpriteNode::getBlendFunc() const
+{
+    return _blendFunc;
+}
+
+Texture2D* InstancedSpriteNode::getTexture() const
+{
+    return _texture;
+}
+
+void InstancedSpriteNode::setTexture(Texture2D *texture)
+{
+    CCASSERT(texture != nullptr, "Invalid texture");
+    if (texture != _texture)
+    {
+        CC_SAFE_RETAIN(texture);
+        CC_SAFE_RELEASE(_texture);
+        _texture = texture;
+        updateBlendFunc();
+
+        // normalized by the size of the texture, and premultiplied if its alpha is
+        for (ssize_t i = 0; i < (ssize_t)_instances.size(); ++i)
+        {
+            updateInstanceTexCoords(i);
+            updateInstanceColor(i);
+        }
+    }
+}
+
+std::string InstancedSpriteNode::getDescription() const
+{
+    return StringUtils::format("<InstancedSpriteNode | tag = %d, instances = %d>", _tag, (int)_instances.size());
+}
+
+NS_CC_END
@@ -0,0 +1,185 @@
+/****************************************************************************
+Copyright (c) 2014 Chukong Technologies Inc.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+
+#ifndef __CC_INSTANCED_SPRITE_NODE_H__
+#define __CC_INSTANCED_SPRITE_NODE_H__
+
+#include <vector>
+
+#include "2d/CCNode.h"
+#include "base/CCProtocols.h"
+#include "renderer/CCCustomCommand.h"
+#include "renderer/CCQuadCommand.h"
+
+NS_CC_BEGIN
+
+class SpriteFrame;
+class GLProgramState;
+
+/**
+ * @addtogroup sprite_nodes
+ * @{
+ */
+
+/** @brief Draws thousands of sprites of the same texture with one instanced draw call.
+
+ The sprites are instances of the node, not child nodes. Each instance has a position, a rotation, a scale,
+ a color and a rect of the texture, kept in one attribute stream with one entry per instance. The quads are
+ built by the vertex shader, so the CPU doesn't write 4 vertices per sprite, and the stream is uploaded
+ only when an instance changes.
+
+ Instancing needs GL_EXT, GL_ANGLE or GL_NV_instanced_arrays on OpenGL ES, GL_ARB_instanced_arrays on desktop GL.
+ Without it, the quads of the instances are built on the CPU and batched by the Renderer like the quads of sprites.
+
+ Limitations:
+ - The instances are drawn in the order they were added, but removing one moves the last instance in its place.
+ - The color and opacity of the node don't apply to the instances.
+ - Rotated sprite frames are not supported, and the offsets of trimmed frames are ignored.
+ */
+class CC_DLL InstancedSpriteNode : public Node, public TextureProtocol
+{
+public:
+    static const int DEFAULT_CAPACITY = 128;
+
+    /** creates an InstancedSpriteNode with a texture and the capacity of instances, the capacity grows as needed */
+    static InstancedSpriteNode* createWithTexture(Texture2D* tex, ssize_t capacity = DEFAULT_CAPACITY);
+
+    /** creates an InstancedSpriteNode with a file image and the capacity of instances, the capacity grows as needed */
+    static InstancedSpriteNode* create(const std::string& fileImage, ssize_t capacity = DEFAULT_CAPACITY);
+
+    /** Whether the GPU can draw the instances in one call */
+    static bool isInstancingSupported();
+
+    /** Adds a sprite showing a rect of the texture, in points, centered on position.
+     @return the id of the instance, reused once the instance is removed
+     */
+    int addInstance(const Rect& rect, const Vec2& position = Vec2::ZERO);
+
+    /** Adds a sprite showing a sprite frame of the texture */
+    int addInstanceWithSpriteFrame(SpriteFrame* spriteFrame, const Vec2& position = Vec2::ZERO);
+
+    void removeInstance(int instanceId);
+    void removeAllInstances();
+    ssize_t getInstanceCount() const { return _instances.size(); }
+
+    void setInstancePosition(int instanceId, const Vec2& position);
+    const Vec2& getInstancePosition(int instanceId) const;
+
+    /** Sets the rotation of an instance in degrees, clockwise like the rotation of a node */
+    void setInstanceRotation(int instanceId, float rotation);
+    float getInstanceRotation(int instanceId) const;
+
+    void setInstanceScale(int instanceId, float scaleX, float scaleY);
+
+    /** Sets the position, rotation and scale of an instance at once */
+    void setInstanceTransform(int instanceId, const Vec2& position, float rotation, float scaleX, float scaleY);
+
+    void setInstanceColor(int instanceId, const Color4B& color);
+    const Color4B& getInstanceColor(int instanceId) const;
+
+    /** Sets the rect of the texture shown by an instance, in points */
+    void setInstanceTextureRect(int instanceId, const Rect& rect);
+
+    /** Draws the quads through the Renderer even when instancing is supported, enabled by default */
+    void setInstancingEnabled(bool enabled) { _instancingEnabled = enabled; }
+    /** Whether the instances are drawn in one call, if enabled and supported */
+    bool isInstancingEnabled() const { return _instancingEnabled && isInstancingSupported(); }
+
+    // Overrides
+    virtual Texture2D* getTexture() const override;
+    virtual void setTexture(Texture2D *texture) override;
+    virtual void setBlendFunc(const BlendFunc &blendFunc) override;
+    virtual const BlendFunc& getBlendFunc() const override;
+    virtual void draw(Renderer *renderer, const Mat4 &transform, uint32_t flags) override;
+    virtual std::string getDescription() const override;
+
+CC_CONSTRUCTOR_ACCESS:
+    InstancedSpriteNode();
+    virtual ~InstancedSpriteNode();
+
+    bool initWithTexture(Texture2D *tex, ssize_t capacity);
+    bool initWithFile(const std::string& fileImage, ssize_t capacity);
+
+protected:
+    struct Instance
+    {
+        int id;
+        Vec2 position;
+        float rotation;
+        float scaleX;
+        float scaleY;
+        Rect rect;      // in the texture, in points
+        Color4B color;  // not premultiplied
+    };
+
+    /** Vertex attributes of an instance, read once per quad by the GPU */
+    struct InstanceAttributes
+    {
+        Color4B color;
+        GLfloat texCoords[4];   // left, bottom, right, top
+        GLfloat axes[4];        // sides of the quad along its x and y
+        GLfloat origin[2];      // bottom left corner of the quad
+    };
+
+    ssize_t getIndex(int instanceId) const;
+    void updateInstanceAxes(ssize_t index);
+    void updateInstanceTexCoords(ssize_t index);
+    void updateInstanceColor(ssize_t index);
+    void updateBlendFunc();
+    void setupBuffers();
+    void updateQuads();
+    void onDraw(const Mat4 &transform, uint32_t flags);
+
+    Texture2D* _texture;
+    BlendFunc _blendFunc;
+    bool _instancingEnabled;
+
+    std::vector<Instance> _instances;
+    std::vector<InstanceAttributes> _attributes;
+    // index of each instance id, -1 for the free ids
+    std::vector<ssize_t> _indices;
+    std::vector<int> _freeIds;
+
+    // corners of the quad, and the attributes of the instances
+    GLuint _buffersVBO[2];
+    bool _attributesDirty;
+    CustomCommand _customCommand;
+
+    // without instancing
+    GLProgramState* _quadsProgramState;
+    std::vector<V3F_C4B_T2F_Quad> _quads;
+    std::vector<QuadCommand> _quadCommands;
+    bool _quadsDirty;
+
+private:
+    CC_DISALLOW_COPY_AND_ASSIGN(InstancedSpriteNode);
+};
+
+// end of sprite_nodes group
+/// @}
+
+NS_CC_END
+
+#endif // __CC_INSTANCED_SPRITE_NODE_H__
@@ -44,6 +44,7 @@ THE SOFTWARE.
 #include "2d/CCComponentContainer.h"
 #include "renderer/CCGLProgram.h"
 #include "renderer/CCGLProgramState.h"
+#include "renderer/CCRenderer.h"
 #include "math/TransformUtils.h"
 
 #include "deprecated/CCString.h"
@@ -71,6 +72,8 @@ bool nodeComparisonLess(Node* n1, Node* n2)
 
 // FIXME:: Yes, nodes might have a sort problem once every 15 days if the game runs at 60 FPS and each frame sprites are reordered.
 int Node::s_globalOrderOfArrival = 1;
+bool Node::s_legacyMatrixStackEnabled = CC_ENABLE_LEGACY_MATRIX_STACK != 0;
+uint64_t Node::s_transformStamp = 0;
 
 // MARK: Constructor, Destructor, Init
 
@@ -109,6 +112,15 @@ Node::Node(void)
 , _visible(true)
 , _ignoreAnchorPointForPosition(false)
 , _reorderChildDirty(false)
+, _parallelVisitEnabled(false)
+, _transformStore(nullptr)
+, _ownTransformStore(nullptr)
+, _transformStoreIndex(-1)
+, _legacyMatrixStackRequired(false)
+, _subtreeCullingEnabled(false)
+, _subtreeCulled(false)
+, _subtreeBoundsDirty(true)
+, _transformStamp(0)
 , _isTransitionFinished(false)
 #if CC_ENABLE_SCRIPT_BINDING
 , _updateScriptHandler(0)
@@ -179,6 +191,8 @@ Node::~Node()
     // attributes
     CC_SAFE_RELEASE_NULL(_glProgramState);
 
+    CC_SAFE_DELETE(_ownTransformStore);
+
     for (auto& child : _children)
     {
         child->_parent = nullptr;
@@ -258,6 +272,7 @@ void Node::setSkewX(float skewX)
     
     _skewX = skewX;
     _transformUpdated = _transformDirty = _inverseDirty = true;
+    setSubtreeBoundsDirty();
 }
 
 float Node::getSkewY() const
@@ -279,6 +294,7 @@ void Node::setSkewY(float skewY)
     
     _skewY = skewY;
     _transformUpdated = _transformDirty = _inverseDirty = true;
+    setSubtreeBoundsDirty();
 }
 
 void Node::setLocalZOrder(int z)
@@ -326,6 +342,7 @@ void Node::setRotation(float rotation)
     
     _rotationZ_X = _rotationZ_Y = rotation;
     _transformUpdated = _transformDirty = _inverseDirty = true;
+    setSubtreeBoundsDirty();
 
 #if CC_USE_PHYSICS
     if (!_physicsBody || !_physicsBody->_rotationResetTag)
@@ -348,6 +365,7 @@ void Node::setRotation3D(const Vec3& rotation)
         return;
     
     _transformUpdated = _transformDirty = _inverseDirty = true;
+    setSubtreeBoundsDirty();
 
     _rotationX = rotation.x;
     _rotationY = rotation.y;
@@ -385,6 +403,7 @@ void Node::setRotationSkewX(float rotationX)
     
     _rotationZ_X = rotationX;
     _transformUpdated = _transformDirty = _inverseDirty = true;
+    setSubtreeBoundsDirty();
 }
 
 float Node::getRotationSkewY() const
@@ -406,6 +425,7 @@ void Node::setRotationSkewY(float rotationY)
     
     _rotationZ_Y = rotationY;
     _transformUpdated = _transformDirty = _inverseDirty = true;
+    setSubtreeBoundsDirty();
 }
 
 /// scale getter
@@ -423,6 +443,7 @@ void Node::setScale(float scale)
     
     _scaleX = _scaleY = _scaleZ = scale;
     _transformUpdated = _transformDirty = _inverseDirty = true;
+    setSubtreeBoundsDirty();
     
 #if CC_USE_PHYSICS
     updatePhysicsBodyTransform(getScene());
@@ -444,6 +465,7 @@ void Node::setScale(float scaleX,float scaleY)
     _scaleX = scaleX;
     _scaleY = scaleY;
     _transformUpdated = _transformDirty = _inverseDirty = true;
+    setSubtreeBoundsDirty();
     
 #if CC_USE_PHYSICS
     updatePhysicsBodyTransform(getScene());
@@ -458,6 +480,7 @@ void Node::setScaleX(float scaleX)
     
     _scaleX = scaleX;
     _transformUpdated = _transformDirty = _inverseDirty = true;
+    setSubtreeBoundsDirty();
     
 #if CC_USE_PHYSICS
     updatePhysicsBodyTransform(getScene());
@@ -485,6 +508,7 @@ void Node::setScaleZ(float scaleZ)
     
     _scaleZ = scaleZ;
     _transformUpdated = _transformDirty = _inverseDirty = true;
+    setSubtreeBoundsDirty();
 }
 
 /// scaleY getter
@@ -501,6 +525,7 @@ void Node::setScaleY(float scaleY)
     
     _scaleY = scaleY;
     _transformUpdated = _transformDirty = _inverseDirty = true;
+    setSubtreeBoundsDirty();
     
 #if CC_USE_PHYSICS
     updatePhysicsBodyTransform(getScene());
@@ -535,6 +560,7 @@ void Node::setPosition(float x, float y)
     _position.y = y;
     
     _transformUpdated = _transformDirty = _inverseDirty = true;
+    setSubtreeBoundsDirty();
     _usingNormalizedPosition = false;
     
 #if CC_USE_PHYSICS
@@ -591,6 +617,7 @@ void Node::setPositionZ(float positionZ)
         return;
     
     _transformUpdated = _transformDirty = _inverseDirty = true;
+    setSubtreeBoundsDirty();
 
     _positionZ = positionZ;
 
@@ -615,6 +642,7 @@ void Node::setNormalizedPosition(const Vec2& position)
     _usingNormalizedPosition = true;
     _normalizedPositionDirty = true;
     _transformUpdated = _transformDirty = _inverseDirty = true;
+    setSubtreeBoundsDirty();
 }
 
 ssize_t Node::getChildrenCount() const
@@ -635,6 +663,7 @@ void Node::setVisible(bool visible)
     {
         _visible = visible;
         if(_visible) _transformUpdated = _transformDirty = _inverseDirty = true;
+        if(_parent) _parent->setSubtreeBoundsDirty();
     }
 }
 
@@ -664,6 +693,7 @@ void Node::setAnchorPoint(const Vec2& point)
         _anchorPoint = point;
         _anchorPointInPoints = Vec2(_contentSize.width * _anchorPoint.x, _contentSize.height * _anchorPoint.y );
         _transformUpdated = _transformDirty = _inverseDirty = true;
+        setSubtreeBoundsDirty();
     }
 }
 
@@ -681,6 +711,7 @@ void Node::setContentSize(const Size & size)
 
         _anchorPointInPoints = Vec2(_contentSize.width * _anchorPoint.x, _contentSize.height * _anchorPoint.y );
         _transformUpdated = _transformDirty = _inverseDirty = _contentSizeDirty = true;
+        setSubtreeBoundsDirty();
     }
 }
 
@@ -695,6 +726,11 @@ void Node::setParent(Node * parent)
 {
     _parent = parent;
     _transformUpdated = _transformDirty = _inverseDirty = true;
+    // the node may already be dirty, its new ancestors aren't
+    _subtreeBoundsDirty = true;
+    _transformStamp = ++s_transformStamp;
+    if (_parent)
+        _parent->setSubtreeBoundsDirty();
 }
 
 /// isRelativeAnchorPoint getter
@@ -709,6 +745,7 @@ void Node::ignoreAnchorPointForPosition(bool newValue)
     {
 		_ignoreAnchorPointForPosition = newValue;
         _transformUpdated = _transformDirty = _inverseDirty = true;
+        setSubtreeBoundsDirty();
 	}
 }
 
@@ -990,6 +1027,11 @@ void Node::addChildHelper(Node* child, int localZOrder, int tag, const std::stri
     
     child->setParent(this);
     child->setOrderOfArrival(s_globalOrderOfArrival++);
+
+    if (_transformStore)
+    {
+        _transformStore->setHierarchyDirty();
+    }
     
 #if CC_USE_PHYSICS
     // Recursive add children with which have physics body.
@@ -1125,11 +1167,21 @@ void Node::removeAllChildrenWithCleanup(bool cleanup)
         {
             child->cleanup();
         }
+
+        if (_transformStore)
+        {
+            _transformStore->removeSubtree(child);
+        }
         // set parent nil at the end
         child->setParent(nullptr);
     }
     
+    if (_transformStore)
+    {
+        _transformStore->setHierarchyDirty();
+    }
     _children.clear();
+    setSubtreeBoundsDirty();
 }
 
 void Node::detachChild(Node *child, ssize_t childIndex, bool doCleanup)
@@ -1158,10 +1210,17 @@ void Node::detachChild(Node *child, ssize_t childIndex, bool doCleanup)
         child->cleanup();
     }
 
+    if (_transformStore)
+    {
+        _transformStore->removeSubtree(child);
+        _transformStore->setHierarchyDirty();
+    }
+
     // set parent nil at the end
     child->setParent(nullptr);
 
     _children.erase(childIndex);
+    setSubtreeBoundsDirty();
 }
 
 
@@ -1185,11 +1244,51 @@ void Node::reorderChild(Node *child, int zOrder)
 void Node::sortAllChildren()
 {
     if( _reorderChildDirty ) {
-        std::sort( std::begin(_children), std::end(_children), nodeComparisonLess );
+        sortNodes(_children);
         _reorderChildDirty = false;
     }
 }
 
+void Node::reorderChildren(const std::function<int (Node*)>& localZOrder)
+{
+    for (const auto& child : _children)
+    {
+        child->setLocalZOrder(localZOrder(child));
+    }
+    sortAllChildren();
+}
+
+void Node::sortNodes(Vector<Node*>& nodes)
+{
+    auto first = std::begin(nodes);
+    auto last = std::end(nodes);
+    ssize_t count = last - first;
+    if (count < 2)
+        return;
+
+    // past about n log n moves the insertion sort would be slower than std::sort
+    ssize_t budget = count;
+    for (ssize_t n = count; n > 1; n >>= 1)
+        budget += count;
+
+    for (auto it = first + 1; it < last; ++it)
+    {
+        Node* node = *it;
+        auto hole = it;
+        for ( ; hole != first && nodeComparisonLess(node, *(hole - 1)); --hole, --budget)
+        {
+            *hole = *(hole - 1);
+        }
+        *hole = node;
+
+        if (budget < 0)
+        {
+            std::sort(first, last, nodeComparisonLess);
+            return;
+        }
+    }
+}
+
 // MARK: draw / visit
 
 void Node::draw()
@@ -1210,6 +1309,26 @@ void Node::visit()
 }
 
 uint32_t Node::processParentFlags(const Mat4& parentTransform, uint32_t parentFlags)
+{
+    if (_ownTransformStore)
+    {
+        return _ownTransformStore->update(parentTransform, parentFlags);
+    }
+    // updated by the store of an ancestor, unless a child was added or removed since its last update
+    if (_transformStore && !_transformStore->isHierarchyDirty())
+    {
+        return _transformStore->getFlags(_transformStoreIndex);
+    }
+
+    uint32_t flags = consumeDirtyFlags(parentFlags);
+
+    if(flags & FLAGS_DIRTY_MASK)
+        _modelViewTransform = this->transform(parentTransform);
+
+    return flags;
+}
+
+uint32_t Node::consumeDirtyFlags(uint32_t parentFlags)
 {
     if(_usingNormalizedPosition) {
         CCASSERT(_parent, "setNormalizedPosition() doesn't work with orphan nodes");
@@ -1218,6 +1337,7 @@ uint32_t Node::processParentFlags(const Mat4& parentTransform, uint32_t parentFl
             _position.x = _normalizedPosition.x * s.width;
             _position.y = _normalizedPosition.y * s.height;
             _transformUpdated = _transformDirty = _inverseDirty = true;
+            setSubtreeBoundsDirty();
             _normalizedPositionDirty = false;
         }
     }
@@ -1225,10 +1345,6 @@ uint32_t Node::processParentFlags(const Mat4& parentTransform, uint32_t parentFl
     uint32_t flags = parentFlags;
     flags |= (_transformUpdated ? FLAGS_TRANSFORM_DIRTY : 0);
     flags |= (_contentSizeDirty ? FLAGS_CONTENT_SIZE_DIRTY : 0);
-    
-
-    if(flags & FLAGS_DIRTY_MASK)
-        _modelViewTransform = this->transform(parentTransform);
 
     _transformUpdated = false;
     _contentSizeDirty = false;
@@ -1243,6 +1359,121 @@ bool Node::isVisitableByVisitingCamera() const
     return visibleByCamera;
 }
 
+void Node::setSubtreeBoundsDirty()
+{
+    // called by every change that moves the node, so it also stamps the node
+    _transformStamp = ++s_transformStamp;
+
+    for (Node* node = this; node && !node->_subtreeBoundsDirty; node = node->_parent)
+    {
+        node->_subtreeBoundsDirty = true;
+    }
+}
+
+bool Node::isTransformChangedSince(uint64_t stamp) const
+{
+    for (const Node* node = this; node; node = node->_parent)
+    {
+        if (node->_transformStamp > stamp)
+            return true;
+    }
+    return false;
+}
+
+void Node::getSubtreeBounds(Vec3* min, Vec3* max)
+{
+    updateSubtreeBounds();
+    *min = _subtreeBoundsMin;
+    *max = _subtreeBoundsMax;
+}
+
+void Node::updateSubtreeBounds()
+{
+    if (!_subtreeBoundsDirty)
+        return;
+
+    Vec3 min(0, 0, 0);
+    Vec3 max(_contentSize.width, _contentSize.height, 0);
+    mergeChildrenSubtreeBounds(&min, &max);
+
+    _subtreeBoundsMin = min;
+    _subtreeBoundsMax = max;
+    _subtreeBoundsDirty = false;
+}
+
+void Node::mergeChildrenSubtreeBounds(Vec3* min, Vec3* max)
+{
+    for (const auto& child : _children)
+    {
+        mergeSubtreeBounds(child, min, max);
+    }
+}
+
+void Node::mergeSubtreeBounds(Node* child, Vec3* min, Vec3* max)
+{
+    if (!child->_visible)
+        return;
+
+    child->updateSubtreeBounds();
+    const Vec3& childMin = child->_subtreeBoundsMin;
+    const Vec3& childMax = child->_subtreeBoundsMax;
+    const Mat4& transform = child->getNodeToParentTransform();
+    for (int i = 0; i < 8; ++i)
+    {
+        Vec3 corner((i & 1) ? childMax.x : childMin.x,
+                    (i & 2) ? childMax.y : childMin.y,
+                    (i & 4) ? childMax.z : childMin.z);
+        transform.transformPoint(&corner);
+        min->x = std::min(min->x, corner.x);
+        min->y = std::min(min->y, corner.y);
+        min->z = std::min(min->z, corner.z);
+        max->x = std::max(max->x, corner.x);
+        max->y = std::max(max->y, corner.y);
+        max->z = std::max(max->z, corner.z);
+    }
+}
+
+bool Node::cullSubtree(uint32_t& flags)
+{
+    auto camera = Camera::getVisitingCamera();
+    if (!_subtreeCullingEnabled || !camera)
+        return false;
+
+    updateSubtreeBounds();
+
+    Mat4 clipTransform;
+    Mat4::multiply(camera->getViewProjectionMatrix(), _modelViewTransform, &clipTransform);
+
+    // the subtree is culled when all the corners of its bounds are on the outer side of the same clip plane
+    unsigned int outside = 0x3f;
+    for (int i = 0; i < 8 && outside; ++i)
+    {
+        Vec4 corner((i & 1) ? _subtreeBoundsMax.x : _subtreeBoundsMin.x,
+                    (i & 2) ? _subtreeBoundsMax.y : _subtreeBoundsMin.y,
+                    (i & 4) ? _subtreeBoundsMax.z : _subtreeBoundsMin.z,
+                    1);
+        Vec4 clip;
+        clipTransform.transformVector(corner, &clip);
+        unsigned int planes = (clip.x < -clip.w ? 0x01 : 0) | (clip.x > clip.w ? 0x02 : 0)
+                            | (clip.y < -clip.w ? 0x04 : 0) | (clip.y > clip.w ? 0x08 : 0)
+                            | (clip.z < -clip.w ? 0x10 : 0) | (clip.z > clip.w ? 0x20 : 0);
+        outside &= planes;
+    }
+
+    if (outside)
+    {
+        _subtreeCulled = true;
+        return true;
+    }
+    if (_subtreeCulled)
+    {
+        // the children were not visited while the subtree was culled, they missed the changes of their ancestors
+        flags |= FLAGS_DIRTY_MASK;
+        _subtreeCulled = false;
+    }
+    return false;
+}
+
 void Node::visit(Renderer* renderer, const Mat4 &parentTransform, uint32_t parentFlags)
 {
     // quick return if not visible. children won't be drawn.
@@ -1253,18 +1484,32 @@ void Node::visit(Renderer* renderer, const Mat4 &parentTransform, uint32_t paren
 
     uint32_t flags = processParentFlags(parentTransform, parentFlags);
 
+    if (cullSubtree(flags))
+    {
+        return;
+    }
+
     // IMPORTANT:
     // To ease the migration to v3.0, we still support the Mat4 stack,
     // but it is deprecated and your code should not rely on it
     Director* director = Director::getInstance();
-    director->pushMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW);
-    director->loadMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW, _modelViewTransform);
+    bool legacyMatrixStack = usesLegacyMatrixStack();
+    if (legacyMatrixStack)
+    {
+        director->pushMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW);
+        director->loadMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW, _modelViewTransform);
+    }
     
     bool visibleByCamera = isVisitableByVisitingCamera();
 
     int i = 0;
 
-    if(!_children.empty())
+    if(!_children.empty() && _parallelVisitEnabled)
+    {
+        sortAllChildren();
+        visitChildrenInParallel(renderer, flags, visibleByCamera);
+    }
+    else if(!_children.empty())
     {
         sortAllChildren();
         // draw children zOrder < 0
@@ -1289,7 +1534,8 @@ void Node::visit(Renderer* renderer, const Mat4 &parentTransform, uint32_t paren
         this->draw(renderer, _modelViewTransform, flags);
     }
 
-    director->popMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW);
+    if (legacyMatrixStack)
+        director->popMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW);
     
     // FIX ME: Why need to set _orderOfArrival to 0??
     // Please refer to https://github.com/cocos2d/cocos2d-x/pull/6920
@@ -1297,6 +1543,26 @@ void Node::visit(Renderer* renderer, const Mat4 &parentTransform, uint32_t paren
     // _orderOfArrival = 0;
 }
 
+void Node::visitChildrenInParallel(Renderer* renderer, uint32_t flags, bool visibleByCamera)
+{
+    ssize_t count = _children.size();
+    ssize_t i = 0;
+    while (i < count && _children.at(i)->_localZOrder < 0)
+        ++i;
+
+    // draw children zOrder < 0
+    renderer->recordInParallel(i, [&](ssize_t index){
+        _children.at(index)->visit(renderer, _modelViewTransform, flags);
+    });
+    // self draw
+    if (visibleByCamera)
+        this->draw(renderer, _modelViewTransform, flags);
+
+    renderer->recordInParallel(count - i, [&](ssize_t index){
+        _children.at(i + index)->visit(renderer, _modelViewTransform, flags);
+    });
+}
+
 Mat4 Node::transform(const Mat4& parentTransform)
 {
     Mat4 ret = this->getNodeToParentTransform();
@@ -1304,6 +1570,127 @@ Mat4 Node::transform(const Mat4& parentTransform)
     return ret;
 }
 
+void Node::setTransformStoreEnabled(bool enabled)
+{
+    if (enabled == (_ownTransformStore != nullptr))
+        return;
+
+    if (enabled)
+    {
+        // leave the store of an ancestor, this node updates its subtree itself
+        if (_transformStore)
+        {
+            _transformStore->removeSubtree(this);
+            _transformStore->setHierarchyDirty();
+        }
+        _ownTransformStore = new (std::nothrow) NodeTransformStore(this);
+    }
+    else
+    {
+        CC_SAFE_DELETE(_ownTransformStore);
+        // join the store of the parent again
+        if (_parent && _parent->_transformStore)
+        {
+            _parent->_transformStore->setHierarchyDirty();
+        }
+    }
+}
+
+// MARK: NodeTransformStore
+
+NodeTransformStore::NodeTransformStore(Node* root)
+: _root(root)
+, _hierarchyDirty(true)
+{
+}
+
+NodeTransformStore::~NodeTransformStore()
+{
+    removeSubtree(_root);
+}
+
+void NodeTransformStore::removeSubtree(Node* node)
+{
+    if (node->_transformStore != this)
+        return;
+
+    node->_transformStore = nullptr;
+    node->_transformStoreIndex = -1;
+    for (const auto& child : node->_children)
+    {
+        removeSubtree(child);
+    }
+}
+
+void NodeTransformStore::add(Node* node, int parent)
+{
+    int index = (int)_nodes.size();
+    node->_transformStore = this;
+    node->_transformStoreIndex = index;
+    _nodes.push_back(node);
+    _parents.push_back(parent);
+    _subtreeEnds.push_back(0);
+
+    for (const auto& child : node->_children)
+    {
+        // a descendant with its own store is updated when it is visited
+        if (!child->_ownTransformStore)
+            add(child, index);
+    }
+    _subtreeEnds[index] = (int)_nodes.size();
+}
+
+void NodeTransformStore::rebuild()
+{
+    _nodes.clear();
+    _parents.clear();
+    _subtreeEnds.clear();
+    add(_root, -1);
+
+    // nodes that are new or moved are dirty, the others keep the transform of their last visit
+    size_t count = _nodes.size();
+    _local.resize(count);
+    _world.resize(count);
+    _flags.assign(count, 0);
+    for (size_t i = 0; i < count; ++i)
+    {
+        _world[i] = _nodes[i]->_modelViewTransform;
+    }
+    _hierarchyDirty = false;
+}
+
+uint32_t NodeTransformStore::update(const Mat4& parentTransform, uint32_t parentFlags)
+{
+    if (_hierarchyDirty)
+    {
+        rebuild();
+    }
+
+    const int count = (int)_nodes.size();
+    for (int i = 0; i < count; )
+    {
+        Node* node = _nodes[i];
+        // not visited, its subtree is updated once it is visible again
+        if (!node->_visible)
+        {
+            i = _subtreeEnds[i];
+            continue;
+        }
+
+        int parent = _parents[i];
+        uint32_t flags = node->consumeDirtyFlags(parent < 0 ? parentFlags : _flags[parent]);
+        if (flags & Node::FLAGS_DIRTY_MASK)
+        {
+            _local[i] = node->getNodeToParentTransform();
+            Mat4::multiply(parent < 0 ? parentTransform : _world[parent], _local[i], &_world[i]);
+            node->_modelViewTransform = _world[i];
+        }
+        _flags[i] = flags;
+        ++i;
+    }
+    return _flags[0];
+}
+
 // MARK: events
 
 void Node::onEnter()
@@ -1736,6 +2123,7 @@ void Node::setNodeToParentTransform(const Mat4& transform)
     _transform = transform;
     _transformDirty = false;
     _transformUpdated = true;
+    setSubtreeBoundsDirty();
 }
 
 void Node::setAdditionalTransform(const AffineTransform& additionalTransform)
@@ -1754,6 +2142,7 @@ void Node::setAdditionalTransform(Mat4* additionalTransform)
         _useAdditionalTransform = true;
     }
     _transformUpdated = _transformDirty = _inverseDirty = true;
+    setSubtreeBoundsDirty();
 }
 
 
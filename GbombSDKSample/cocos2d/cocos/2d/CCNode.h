@@ -51,6 +51,7 @@ class Scene;
 class Renderer;
 class GLProgram;
 class GLProgramState;
+class NodeTransformStore;
 #if CC_USE_PHYSICS
 class PhysicsBody;
 #endif
@@ -851,6 +852,21 @@ public:
      */
     virtual void sortAllChildren();
 
+    /**
+     * Sets the local z order of every child to `localZOrder(child)`, then sorts the children once.
+     * Use it when many children are reordered every frame, like the depth sorting of an isometric map.
+     *
+     * @param localZOrder Returns the new local z order of a child, it is called once per child in the current order.
+     */
+    void reorderChildren(const std::function<int (Node*)>& localZOrder);
+
+    /**
+     * Sorts nodes by local z order and order of arrival.
+     * Arrays where only a few nodes moved since the last sort, the usual case between two frames,
+     * are sorted by insertion in about linear time. Others fall back to std::sort.
+     */
+    static void sortNodes(Vector<Node*>& nodes);
+
     /// @} end of Children and Parent
     
     /// @{
@@ -1062,6 +1078,67 @@ public:
     virtual void visit(Renderer *renderer, const Mat4& parentTransform, uint32_t parentFlags);
     virtual void visit() final;
 
+    /**
+     * Visits the children of this node on the job system of the Director, see `Renderer::setParallelRecordingEnabled()`.
+     * The commands of the children are merged in the children order, so the result is the same as a serial visit.
+     * Only enable it on containers whose descendants don't make GL calls while visiting, like sprites,
+     * and don't share state with nodes outside their own subtree.
+     * Nodes that render to textures or update font atlases during visit must not be below such a node.
+     */
+    void setParallelVisitEnabled(bool enabled) { _parallelVisitEnabled = enabled; }
+    bool isParallelVisitEnabled() const { return _parallelVisitEnabled; }
+
+    /**
+     * Keeps the transforms of this node and its descendants in a NodeTransformStore.
+     * The visit of this node updates the dirty subtrees in one linear pass over contiguous arrays,
+     * and the descendants read their world transform from the store instead of computing it one by one.
+     * Meant for big hierarchies, the descendants must only be visited from the visit of this node.
+     * A descendant with its own store updates its subtree itself.
+     */
+    void setTransformStoreEnabled(bool enabled);
+    bool isTransformStoreEnabled() const { return _ownTransformStore != nullptr; }
+
+    /**
+     * Skips the visit of this node and of its descendants when their bounds are outside the view of the visiting camera.
+     * The bounds are the content rectangles of the visible nodes of the subtree. They are cached, and only updated
+     * after a node of the subtree moved, resized, or was added or removed.
+     * Enable it on big containers, like the layers of a scrolling map or the items of a long list.
+     * Nodes that draw outside of their content size, like particles or a DrawNode, need a content size that covers what they draw.
+     */
+    void setSubtreeCullingEnabled(bool enabled) { _subtreeCullingEnabled = enabled; }
+    bool isSubtreeCullingEnabled() const { return _subtreeCullingEnabled; }
+
+    /**
+     * Returns the bounds of this node and of its visible descendants, in the coordinate system of this node.
+     *
+     * @param min Set to the minimum corner.
+     * @param max Set to the maximum corner.
+     */
+    void getSubtreeBounds(Vec3* min, Vec3* max);
+
+    /**
+     * Returns the stamp of the last change of the transform, content size, visibility or parent of any node.
+     * The stamps only grow, compare them with isTransformChangedSince().
+     */
+    static uint64_t getTransformStamp() { return s_transformStamp; }
+
+    /** Whether the node or one of its ancestors moved, resized, or changed visibility or parent after stamp */
+    bool isTransformChangedSince(uint64_t stamp) const;
+
+    /**
+     * Sets whether every visited node loads its model view transform on the deprecated matrix stack of the Director.
+     * The default is CC_ENABLE_LEGACY_MATRIX_STACK. Disable it when no code reads `Director::getMatrix()` while visiting.
+     */
+    static void setLegacyMatrixStackEnabled(bool enabled) { s_legacyMatrixStackEnabled = enabled; }
+    static bool isLegacyMatrixStackEnabled() { return s_legacyMatrixStackEnabled; }
+
+    /**
+     * Nodes that read the deprecated matrix stack while they are visited, or draw with DrawPrimitives from `draw()`,
+     * set it to keep using the stack when it is disabled globally.
+     */
+    void setLegacyMatrixStackRequired(bool required) { _legacyMatrixStackRequired = required; }
+    bool isLegacyMatrixStackRequired() const { return _legacyMatrixStackRequired; }
+
 
     /** Returns the Scene that contains the Node.
      It returns `nullptr` if the node doesn't belong to any Scene.
@@ -1517,6 +1594,23 @@ protected:
 
     Mat4 transform(const Mat4 &parentTransform);
     uint32_t processParentFlags(const Mat4& parentTransform, uint32_t parentFlags);
+    /// Invalidates the cached subtree bounds of this node and of its ancestors
+    void setSubtreeBoundsDirty();
+    /// Recomputes the cached subtree bounds if a node of the subtree changed
+    void updateSubtreeBounds();
+    /// Merges the subtree bounds of the children into min and max, in the coordinate system of this node.
+    /// Nodes that visit other nodes than their children override it.
+    virtual void mergeChildrenSubtreeBounds(Vec3* min, Vec3* max);
+    /// Merges the subtree bounds of child, transformed to the coordinate system of this node
+    static void mergeSubtreeBounds(Node* child, Vec3* min, Vec3* max);
+    /// Returns true if subtree culling is enabled and the subtree is outside the view of the visiting camera,
+    /// the visit must then return. Otherwise adds to flags the changes the children missed while the subtree was culled.
+    bool cullSubtree(uint32_t& flags);
+
+    /// Whether the visit of this node loads its transform on the deprecated matrix stack
+    bool usesLegacyMatrixStack() const { return s_legacyMatrixStackEnabled || _legacyMatrixStackRequired; }
+    /// Updates the normalized position and returns the dirty flags of this node, they are cleared.
+    uint32_t consumeDirtyFlags(uint32_t parentFlags);
 
     virtual void updateCascadeOpacity();
     virtual void disableCascadeOpacity();
@@ -1529,6 +1623,9 @@ protected:
     
     //check whether this camera mask is visible by the current visiting camera
     bool isVisitableByVisitingCamera() const;
+
+    //visit children on the job system, through Renderer::recordInParallel()
+    void visitChildrenInParallel(Renderer* renderer, uint32_t flags, bool visibleByCamera);
     
 #if CC_USE_PHYSICS
     void updatePhysicsBodyTransform(Scene* layer);
@@ -1611,6 +1708,17 @@ protected:
                                           ///< Used by Layer and Scene.
 
     bool _reorderChildDirty;          ///< children order dirty flag
+    bool _parallelVisitEnabled;       ///< visit children on the job system, see Renderer::recordInParallel()
+    NodeTransformStore* _transformStore;    ///< store that updates the transform of this node, weak reference
+    NodeTransformStore* _ownTransformStore; ///< store of the subtree of this node
+    int _transformStoreIndex;               ///< index of this node in _transformStore
+    bool _legacyMatrixStackRequired;        ///< load the transform on the deprecated matrix stack even if it is disabled
+    bool _subtreeCullingEnabled;            ///< skip the subtree when it is outside the view of the visiting camera
+    bool _subtreeCulled;                    ///< the subtree was culled by the last visit
+    bool _subtreeBoundsDirty;               ///< whether _subtreeBoundsMin and _subtreeBoundsMax must be recomputed
+    Vec3 _subtreeBoundsMin;                 ///< cached bounds of the visible subtree, in the coordinate system of this node
+    Vec3 _subtreeBoundsMax;
+    uint64_t _transformStamp;               ///< value of s_transformStamp at the last change of this node
     bool _isTransitionFinished;       ///< flag to indicate whether the transition was finished
 
 #if CC_ENABLE_SCRIPT_BINDING
@@ -1636,6 +1744,8 @@ protected:
     bool        _cascadeOpacityEnabled;
 
     static int s_globalOrderOfArrival;
+    static bool s_legacyMatrixStackEnabled;
+    static uint64_t s_transformStamp;
     
     // camera mask, it is visible only when _cameraMask & current camera' camera flag is true
     unsigned short _cameraMask;
@@ -1651,6 +1761,50 @@ private:
 #if CC_USE_PHYSICS
     friend class Layer;
 #endif //CC_USTPS
+    friend class NodeTransformStore;
+};
+
+/** @brief Transforms of a subtree in depth first order, see `Node::setTransformStoreEnabled()`.
+
+ The local and world matrices and the dirty flags live in contiguous arrays, a parent always comes before its
+ descendants, so the world transforms are updated in one pass without recursion.
+ The arrays are rebuilt after a child is added or removed anywhere in the subtree.
+ */
+class CC_DLL NodeTransformStore
+{
+public:
+    explicit NodeTransformStore(Node* root);
+    ~NodeTransformStore();
+
+    /** Updates the dirty world transforms and returns the flags of the root. Called by the visit of the root. */
+    uint32_t update(const Mat4& parentTransform, uint32_t parentFlags);
+
+    void setHierarchyDirty() { _hierarchyDirty = true; }
+    bool isHierarchyDirty() const { return _hierarchyDirty; }
+
+    /** Flags of the node at index after the last update */
+    uint32_t getFlags(int index) const { return _flags[index]; }
+    const Mat4& getLocalTransform(int index) const { return _local[index]; }
+    const Mat4& getWorldTransform(int index) const { return _world[index]; }
+
+    /** Number of nodes in the store */
+    ssize_t size() const { return _nodes.size(); }
+
+    /** Clears the store of node and of its descendants in this store */
+    void removeSubtree(Node* node);
+
+private:
+    void rebuild();
+    void add(Node* node, int parent);
+
+    Node* _root;
+    std::vector<Node*> _nodes;
+    std::vector<int> _parents;
+    std::vector<int> _subtreeEnds;     // index after the last descendant, used to skip invisible subtrees
+    std::vector<Mat4> _local;
+    std::vector<Mat4> _world;
+    std::vector<uint32_t> _flags;
+    bool _hierarchyDirty;
 };
 
 // NodeRGBA
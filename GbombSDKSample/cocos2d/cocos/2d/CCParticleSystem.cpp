@@ -46,11 +46,21 @@ THE SOFTWARE.
 
 #include <string>
 
+#if defined(__SSE__)
+#include <xmmintrin.h>
+#elif defined(USE_NEON) || defined(__ARM_NEON__) || defined(__ARM_NEON)
+#define CC_PARTICLE_USE_NEON 1
+#include <arm_neon.h>
+#endif
+
 #include "2d/CCParticleBatchNode.h"
 #include "renderer/CCTextureAtlas.h"
 #include "base/base64.h"
 #include "base/ZipUtils.h"
 #include "base/CCDirector.h"
+#include "base/CCEventDispatcher.h"
+#include "base/CCEventListenerCustom.h"
+#include "base/CCJobSystem.h"
 #include "renderer/CCTextureCache.h"
 #include "deprecated/CCString.h"
 #include "platform/CCFileUtils.h"
@@ -60,6 +70,265 @@ using namespace std;
 
 NS_CC_BEGIN
 
+// four floats at once, the particles are updated with these
+#if defined(__SSE__)
+
+typedef __m128 float4;
+
+static inline float4 load4(const float* p) { return _mm_load_ps(p); }
+static inline void store4(float* p, const float4& v) { _mm_store_ps(p, v); }
+static inline float4 set4(float f) { return _mm_set1_ps(f); }
+static inline float4 add4(const float4& a, const float4& b) { return _mm_add_ps(a, b); }
+static inline float4 sub4(const float4& a, const float4& b) { return _mm_sub_ps(a, b); }
+static inline float4 mul4(const float4& a, const float4& b) { return _mm_mul_ps(a, b); }
+// a + b * c
+static inline float4 madd4(const float4& a, const float4& b, const float4& c) { return _mm_add_ps(a, _mm_mul_ps(b, c)); }
+static inline float4 max4(const float4& a, const float4& b) { return _mm_max_ps(a, b); }
+// 1 / length of (x, y), 0 for the zero vector
+static inline float4 invLength4(const float4& x, const float4& y)
+{
+    float4 n = _mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y));
+    float4 inv = _mm_div_ps(_mm_set1_ps(1.0f), _mm_sqrt_ps(n));
+    return _mm_and_ps(inv, _mm_cmpgt_ps(n, _mm_setzero_ps()));
+}
+
+#elif CC_PARTICLE_USE_NEON
+
+typedef float32x4_t float4;
+
+static inline float4 load4(const float* p) { return vld1q_f32(p); }
+static inline void store4(float* p, const float4& v) { vst1q_f32(p, v); }
+static inline float4 set4(float f) { return vdupq_n_f32(f); }
+static inline float4 add4(const float4& a, const float4& b) { return vaddq_f32(a, b); }
+static inline float4 sub4(const float4& a, const float4& b) { return vsubq_f32(a, b); }
+static inline float4 mul4(const float4& a, const float4& b) { return vmulq_f32(a, b); }
+static inline float4 madd4(const float4& a, const float4& b, const float4& c) { return vmlaq_f32(a, b, c); }
+static inline float4 max4(const float4& a, const float4& b) { return vmaxq_f32(a, b); }
+static inline float4 invLength4(const float4& x, const float4& y)
+{
+    float4 n = vmlaq_f32(vmulq_f32(x, x), y, y);
+    // estimate refined by two Newton-Raphson steps
+    float4 inv = vrsqrteq_f32(n);
+    inv = vmulq_f32(inv, vrsqrtsq_f32(vmulq_f32(n, inv), inv));
+    inv = vmulq_f32(inv, vrsqrtsq_f32(vmulq_f32(n, inv), inv));
+    return vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(inv), vcgtq_f32(n, vdupq_n_f32(0.0f))));
+}
+
+#else
+
+struct float4
+{
+    float v[4];
+};
+
+static inline float4 load4(const float* p) { float4 r = {{ p[0], p[1], p[2], p[3] }}; return r; }
+static inline void store4(float* p, const float4& v) { p[0] = v.v[0]; p[1] = v.v[1]; p[2] = v.v[2]; p[3] = v.v[3]; }
+static inline float4 set4(float f) { float4 r = {{ f, f, f, f }}; return r; }
+static inline float4 add4(const float4& a, const float4& b)
+{
+    float4 r = {{ a.v[0] + b.v[0], a.v[1] + b.v[1], a.v[2] + b.v[2], a.v[3] + b.v[3] }};
+    return r;
+}
+static inline float4 sub4(const float4& a, const float4& b)
+{
+    float4 r = {{ a.v[0] - b.v[0], a.v[1] - b.v[1], a.v[2] - b.v[2], a.v[3] - b.v[3] }};
+    return r;
+}
+static inline float4 mul4(const float4& a, const float4& b)
+{
+    float4 r = {{ a.v[0] * b.v[0], a.v[1] * b.v[1], a.v[2] * b.v[2], a.v[3] * b.v[3] }};
+    return r;
+}
+static inline float4 madd4(const float4& a, const float4& b, const float4& c) { return add4(a, mul4(b, c)); }
+static inline float4 max4(const float4& a, const float4& b)
+{
+    float4 r = {{ MAX(a.v[0], b.v[0]), MAX(a.v[1], b.v[1]), MAX(a.v[2], b.v[2]), MAX(a.v[3], b.v[3]) }};
+    return r;
+}
+static inline float4 invLength4(const float4& x, const float4& y)
+{
+    float4 r;
+    for (int i = 0; i < 4; ++i)
+    {
+        float n = x.v[i] * x.v[i] + y.v[i] * y.v[i];
+        r.v[i] = n > 0 ? 1.0f / sqrtf(n) : 0.0f;
+    }
+    return r;
+}
+
+#endif
+
+// The kernels process the particles four at a time, up to the padding of the arrays.
+// What they compute for the padding, or for the dead particles after the last one, is never used.
+
+static void updateLife(float* timeToLive, int count, float dt)
+{
+    float4 dt4 = set4(dt);
+    for (int i = 0; i < count; i += 4)
+    {
+        store4(timeToLive + i, sub4(load4(timeToLive + i), dt4));
+    }
+}
+
+// Mode A: gravity, direction, tangential accel & radial accel
+static void updateGravityMode(ParticleData& data, int count, const Vec2& gravity, float dt, float yCoordFlipped)
+{
+    float4 gravityX = set4(gravity.x);
+    float4 gravityY = set4(gravity.y);
+    float4 dt4 = set4(dt);
+    float4 dtFlipped = set4(dt * yCoordFlipped);
+    for (int i = 0; i < count; i += 4)
+    {
+        float4 x = load4(data.posx + i);
+        float4 y = load4(data.posy + i);
+
+        // radial acceleration along the normalized position, tangential perpendicular to it
+        float4 inv = invLength4(x, y);
+        float4 radialX = mul4(x, inv);
+        float4 radialY = mul4(y, inv);
+        float4 radialAccel = load4(data.modeA.radialAccel + i);
+        float4 tangentialAccel = load4(data.modeA.tangentialAccel + i);
+        float4 accelX = sub4(madd4(gravityX, radialX, radialAccel), mul4(radialY, tangentialAccel));
+        float4 accelY = madd4(madd4(gravityY, radialY, radialAccel), radialX, tangentialAccel);
+
+        float4 dirX = madd4(load4(data.modeA.dirX + i), accelX, dt4);
+        float4 dirY = madd4(load4(data.modeA.dirY + i), accelY, dt4);
+        store4(data.modeA.dirX + i, dirX);
+        store4(data.modeA.dirY + i, dirY);
+
+        store4(data.posx + i, madd4(x, dirX, dtFlipped));
+        store4(data.posy + i, madd4(y, dirY, dtFlipped));
+    }
+}
+
+// Mode B: radius movement
+static void updateRadiusMode(ParticleData& data, int count, float dt, float yCoordFlipped)
+{
+    float4 dt4 = set4(dt);
+    for (int i = 0; i < count; i += 4)
+    {
+        store4(data.modeB.angle + i, madd4(load4(data.modeB.angle + i), load4(data.modeB.degreesPerSecond + i), dt4));
+        store4(data.modeB.radius + i, madd4(load4(data.modeB.radius + i), load4(data.modeB.deltaRadius + i), dt4));
+    }
+
+    for (int i = 0; i < count; ++i)
+    {
+        data.posx[i] = - cosf(data.modeB.angle[i]) * data.modeB.radius[i];
+        data.posy[i] = - sinf(data.modeB.angle[i]) * data.modeB.radius[i] * yCoordFlipped;
+    }
+}
+
+// color, size and angle
+static void updateAppearance(ParticleData& data, int count, float dt)
+{
+    float4 dt4 = set4(dt);
+    float4 zero = set4(0.0f);
+    for (int i = 0; i < count; i += 4)
+    {
+        store4(data.colorR + i, madd4(load4(data.colorR + i), load4(data.deltaColorR + i), dt4));
+        store4(data.colorG + i, madd4(load4(data.colorG + i), load4(data.deltaColorG + i), dt4));
+        store4(data.colorB + i, madd4(load4(data.colorB + i), load4(data.deltaColorB + i), dt4));
+        store4(data.colorA + i, madd4(load4(data.colorA + i), load4(data.deltaColorA + i), dt4));
+
+        store4(data.size + i, max4(zero, madd4(load4(data.size + i), load4(data.deltaSize + i), dt4)));
+        store4(data.rotation + i, madd4(load4(data.rotation + i), load4(data.deltaRotation + i), dt4));
+    }
+}
+
+ParticleData::ParticleData()
+: maxCount(0)
+, _memory(nullptr)
+{
+    release();
+}
+
+ParticleData::~ParticleData()
+{
+    release();
+}
+
+bool ParticleData::init(int count)
+{
+    // padded to a multiple of four particles for the kernels, and aligned for their loads
+    size_t stride = ((size_t)MAX(count, 0) + 3) & ~(size_t)3;
+    float** arrays[] = {
+        &posx, &posy, &startPosX, &startPosY,
+        &colorR, &colorG, &colorB, &colorA,
+        &deltaColorR, &deltaColorG, &deltaColorB, &deltaColorA,
+        &size, &deltaSize, &rotation, &deltaRotation, &timeToLive,
+        &modeA.dirX, &modeA.dirY, &modeA.radialAccel, &modeA.tangentialAccel,
+        &modeB.angle, &modeB.degreesPerSecond, &modeB.radius, &modeB.deltaRadius,
+    };
+    static_assert(sizeof(unsigned int) == sizeof(float), "atlasIndex takes the place of a float array");
+    // the float arrays, and atlasIndex
+    const size_t arrayCount = sizeof(arrays) / sizeof(arrays[0]) + 1;
+    void* memory = calloc(arrayCount * stride * sizeof(float) + 15, 1);
+    if (!memory)
+        return false;
+
+    release();
+    _memory = memory;
+    maxCount = MAX(count, 0);
+
+    float* array = (float*)(((uintptr_t)memory + 15) & ~(uintptr_t)15);
+    for (auto values : arrays)
+    {
+        *values = array;
+        array += stride;
+    }
+    atlasIndex = (unsigned int*)array;
+    return true;
+}
+
+void ParticleData::release()
+{
+    CC_SAFE_FREE(_memory);
+    maxCount = 0;
+
+    posx = posy = startPosX = startPosY = nullptr;
+    colorR = colorG = colorB = colorA = nullptr;
+    deltaColorR = deltaColorG = deltaColorB = deltaColorA = nullptr;
+    size = deltaSize = rotation = deltaRotation = timeToLive = nullptr;
+    atlasIndex = nullptr;
+    modeA.dirX = modeA.dirY = modeA.radialAccel = modeA.tangentialAccel = nullptr;
+    modeB.angle = modeB.degreesPerSecond = modeB.radius = modeB.deltaRadius = nullptr;
+}
+
+void ParticleData::copyParticle(int p1, int p2)
+{
+    posx[p1] = posx[p2];
+    posy[p1] = posy[p2];
+    startPosX[p1] = startPosX[p2];
+    startPosY[p1] = startPosY[p2];
+
+    colorR[p1] = colorR[p2];
+    colorG[p1] = colorG[p2];
+    colorB[p1] = colorB[p2];
+    colorA[p1] = colorA[p2];
+
+    deltaColorR[p1] = deltaColorR[p2];
+    deltaColorG[p1] = deltaColorG[p2];
+    deltaColorB[p1] = deltaColorB[p2];
+    deltaColorA[p1] = deltaColorA[p2];
+
+    size[p1] = size[p2];
+    deltaSize[p1] = deltaSize[p2];
+    rotation[p1] = rotation[p2];
+    deltaRotation[p1] = deltaRotation[p2];
+    timeToLive[p1] = timeToLive[p2];
+    atlasIndex[p1] = atlasIndex[p2];
+
+    modeA.dirX[p1] = modeA.dirX[p2];
+    modeA.dirY[p1] = modeA.dirY[p2];
+    modeA.radialAccel[p1] = modeA.radialAccel[p2];
+    modeA.tangentialAccel[p1] = modeA.tangentialAccel[p2];
+
+    modeB.angle[p1] = modeB.angle[p2];
+    modeB.degreesPerSecond[p1] = modeB.degreesPerSecond[p2];
+    modeB.radius[p1] = modeB.radius[p2];
+    modeB.deltaRadius[p1] = modeB.deltaRadius[p2];
+}
+
 // ideas taken from:
 //     . The ocean spray in your face [Jeff Lander]
 //        http://www.double.co.nz/dust/col0798.pdf
@@ -77,18 +346,26 @@ NS_CC_BEGIN
 //  cocos2d uses a another approach, but the results are almost identical. 
 //
 
+static bool s_parallelUpdateEnabled = false;
+// the systems whose update was deferred to finishParallelUpdates(), retained
+static std::vector<ParticleSystem*> s_deferredSystems;
+static EventListenerCustom* s_afterUpdateListener = nullptr;
+
 ParticleSystem::ParticleSystem()
 : _isBlendAdditive(false)
 , _isAutoRemoveOnFinish(false)
 , _plistFile("")
 , _elapsed(0)
-, _particles(nullptr)
+, _startPosTransform(AffineTransform::IDENTITY)
 , _configName("")
 , _emitCounter(0)
 , _particleIdx(0)
 , _batchNode(nullptr)
 , _atlasIndex(0)
 , _transformSystemDirty(false)
+, _updateDeferred(false)
+, _deferredDelta(0)
+, _deferredParticleCount(0)
 , _allocatedParticles(0)
 , _isActive(true)
 , _particleCount(0)
@@ -429,11 +706,7 @@ bool ParticleSystem::initWithTotalParticles(int numberOfParticles)
 {
     _totalParticles = numberOfParticles;
 
-    CC_SAFE_FREE(_particles);
-    
-    _particles = (tParticle*)calloc(_totalParticles, sizeof(tParticle));
-
-    if( ! _particles )
+    if( ! _particleData.init(_totalParticles) )
     {
         CCLOG("Particle system: not enough memory");
         this->release();
@@ -445,7 +718,7 @@ bool ParticleSystem::initWithTotalParticles(int numberOfParticles)
     {
         for (int i = 0; i < _totalParticles; i++)
         {
-            _particles[i].atlasIndex=i;
+            _particleData.atlasIndex[i]=i;
         }
     }
     // default, active
@@ -480,7 +753,6 @@ ParticleSystem::~ParticleSystem()
     // Since the scheduler retains the "target (in this case the ParticleSystem)
 	// it is not needed to call "unscheduleUpdate" here. In fact, it will be called in "cleanup"
     //unscheduleUpdate();
-    CC_SAFE_FREE(_particles);
     CC_SAFE_RELEASE(_texture);
 }
 
@@ -491,123 +763,145 @@ bool ParticleSystem::addParticle()
         return false;
     }
 
-    tParticle * particle = &_particles[ _particleCount ];
-    this->initParticle(particle);
-    ++_particleCount;
-
+    addParticles(1);
     return true;
 }
 
-void ParticleSystem::initParticle(tParticle* particle)
+void ParticleSystem::addParticles(int count)
 {
-    // timeToLive
-    // no negative life. prevent division by 0
-    particle->timeToLive = _life + _lifeVar * CCRANDOM_MINUS1_1();
-    particle->timeToLive = MAX(0, particle->timeToLive);
-
-    // position
-    particle->pos.x = _sourcePosition.x + _posVar.x * CCRANDOM_MINUS1_1();
-
-    particle->pos.y = _sourcePosition.y + _posVar.y * CCRANDOM_MINUS1_1();
-
-
-    // Color
-    Color4F start;
-    start.r = clampf(_startColor.r + _startColorVar.r * CCRANDOM_MINUS1_1(), 0, 1);
-    start.g = clampf(_startColor.g + _startColorVar.g * CCRANDOM_MINUS1_1(), 0, 1);
-    start.b = clampf(_startColor.b + _startColorVar.b * CCRANDOM_MINUS1_1(), 0, 1);
-    start.a = clampf(_startColor.a + _startColorVar.a * CCRANDOM_MINUS1_1(), 0, 1);
+    count = MIN(count, _totalParticles - _particleCount);
+    if (count <= 0)
+        return;
 
-    Color4F end;
-    end.r = clampf(_endColor.r + _endColorVar.r * CCRANDOM_MINUS1_1(), 0, 1);
-    end.g = clampf(_endColor.g + _endColorVar.g * CCRANDOM_MINUS1_1(), 0, 1);
-    end.b = clampf(_endColor.b + _endColorVar.b * CCRANDOM_MINUS1_1(), 0, 1);
-    end.a = clampf(_endColor.a + _endColorVar.a * CCRANDOM_MINUS1_1(), 0, 1);
-
-    particle->color = start;
-    particle->deltaColor.r = (end.r - start.r) / particle->timeToLive;
-    particle->deltaColor.g = (end.g - start.g) / particle->timeToLive;
-    particle->deltaColor.b = (end.b - start.b) / particle->timeToLive;
-    particle->deltaColor.a = (end.a - start.a) / particle->timeToLive;
-
-    // size
-    float startS = _startSize + _startSizeVar * CCRANDOM_MINUS1_1();
-    startS = MAX(0, startS); // No negative value
-
-    particle->size = startS;
-
-    if (_endSize == START_SIZE_EQUAL_TO_END_SIZE)
-    {
-        particle->deltaSize = 0;
-    }
-    else
-    {
-        float endS = _endSize + _endSizeVar * CCRANDOM_MINUS1_1();
-        endS = MAX(0, endS); // No negative values
-        particle->deltaSize = (endS - startS) / particle->timeToLive;
-    }
-
-    // rotation
-    float startA = _startSpin + _startSpinVar * CCRANDOM_MINUS1_1();
-    float endA = _endSpin + _endSpinVar * CCRANDOM_MINUS1_1();
-    particle->rotation = startA;
-    particle->deltaRotation = (endA - startA) / particle->timeToLive;
+    initParticles(_particleCount, count);
+    _particleCount += count;
+}
 
-    // position
+void ParticleSystem::initParticles(int start, int count)
+{
+    // position of the system, where the particles are emitted from
+    Vec2 startPos = Vec2::ZERO;
     if (_positionType == PositionType::FREE)
     {
-        particle->startPos = this->convertToWorldSpace(Vec2::ZERO);
+        startPos = this->convertToWorldSpace(Vec2::ZERO);
     }
     else if (_positionType == PositionType::RELATIVE)
     {
-        particle->startPos = _position;
+        startPos = _position;
     }
 
-    // direction
-    float a = CC_DEGREES_TO_RADIANS( _angle + _angleVar * CCRANDOM_MINUS1_1() );    
-
-    // Mode Gravity: A
-    if (_emitterMode == Mode::GRAVITY)
+    ParticleData& data = _particleData;
+    for (int i = start; i < start + count; ++i)
     {
-        Vec2 v(cosf( a ), sinf( a ));
-        float s = modeA.speed + modeA.speedVar * CCRANDOM_MINUS1_1();
+        // timeToLive
+        // no negative life. prevent division by 0
+        float timeToLive = _life + _lifeVar * CCRANDOM_MINUS1_1();
+        timeToLive = MAX(0, timeToLive);
+        data.timeToLive[i] = timeToLive;
+
+        // position
+        data.posx[i] = _sourcePosition.x + _posVar.x * CCRANDOM_MINUS1_1();
+
+        data.posy[i] = _sourcePosition.y + _posVar.y * CCRANDOM_MINUS1_1();
+
+
+        // Color
+        Color4F start;
+        start.r = clampf(_startColor.r + _startColorVar.r * CCRANDOM_MINUS1_1(), 0, 1);
+        start.g = clampf(_startColor.g + _startColorVar.g * CCRANDOM_MINUS1_1(), 0, 1);
+        start.b = clampf(_startColor.b + _startColorVar.b * CCRANDOM_MINUS1_1(), 0, 1);
+        start.a = clampf(_startColor.a + _startColorVar.a * CCRANDOM_MINUS1_1(), 0, 1);
+
+        Color4F end;
+        end.r = clampf(_endColor.r + _endColorVar.r * CCRANDOM_MINUS1_1(), 0, 1);
+        end.g = clampf(_endColor.g + _endColorVar.g * CCRANDOM_MINUS1_1(), 0, 1);
+        end.b = clampf(_endColor.b + _endColorVar.b * CCRANDOM_MINUS1_1(), 0, 1);
+        end.a = clampf(_endColor.a + _endColorVar.a * CCRANDOM_MINUS1_1(), 0, 1);
+
+        data.colorR[i] = start.r;
+        data.colorG[i] = start.g;
+        data.colorB[i] = start.b;
+        data.colorA[i] = start.a;
+        data.deltaColorR[i] = (end.r - start.r) / timeToLive;
+        data.deltaColorG[i] = (end.g - start.g) / timeToLive;
+        data.deltaColorB[i] = (end.b - start.b) / timeToLive;
+        data.deltaColorA[i] = (end.a - start.a) / timeToLive;
+
+        // size
+        float startS = _startSize + _startSizeVar * CCRANDOM_MINUS1_1();
+        startS = MAX(0, startS); // No negative value
+
+        data.size[i] = startS;
+
+        if (_endSize == START_SIZE_EQUAL_TO_END_SIZE)
+        {
+            data.deltaSize[i] = 0;
+        }
+        else
+        {
+            float endS = _endSize + _endSizeVar * CCRANDOM_MINUS1_1();
+            endS = MAX(0, endS); // No negative values
+            data.deltaSize[i] = (endS - startS) / timeToLive;
+        }
+
+        // rotation
+        float startA = _startSpin + _startSpinVar * CCRANDOM_MINUS1_1();
+        float endA = _endSpin + _endSpinVar * CCRANDOM_MINUS1_1();
+        data.rotation[i] = startA;
+        data.deltaRotation[i] = (endA - startA) / timeToLive;
+
+        // position
+        data.startPosX[i] = startPos.x;
+        data.startPosY[i] = startPos.y;
 
         // direction
-        particle->modeA.dir = v * s ;
+        float a = CC_DEGREES_TO_RADIANS( _angle + _angleVar * CCRANDOM_MINUS1_1() );
 
-        // radial accel
-        particle->modeA.radialAccel = modeA.radialAccel + modeA.radialAccelVar * CCRANDOM_MINUS1_1();
- 
+        // Mode Gravity: A
+        if (_emitterMode == Mode::GRAVITY)
+        {
+            Vec2 v(cosf( a ), sinf( a ));
+            float s = modeA.speed + modeA.speedVar * CCRANDOM_MINUS1_1();
 
-        // tangential accel
-        particle->modeA.tangentialAccel = modeA.tangentialAccel + modeA.tangentialAccelVar * CCRANDOM_MINUS1_1();
+            // direction
+            Vec2 dir = v * s;
+            data.modeA.dirX[i] = dir.x;
+            data.modeA.dirY[i] = dir.y;
 
-        // rotation is dir
-        if(modeA.rotationIsDir)
-            particle->rotation = -CC_RADIANS_TO_DEGREES(particle->modeA.dir.getAngle());
-    }
+            // radial accel
+            data.modeA.radialAccel[i] = modeA.radialAccel + modeA.radialAccelVar * CCRANDOM_MINUS1_1();
 
-    // Mode Radius: B
-    else 
-    {
-        // Set the default diameter of the particle from the source position
-        float startRadius = modeB.startRadius + modeB.startRadiusVar * CCRANDOM_MINUS1_1();
-        float endRadius = modeB.endRadius + modeB.endRadiusVar * CCRANDOM_MINUS1_1();
 
-        particle->modeB.radius = startRadius;
+            // tangential accel
+            data.modeA.tangentialAccel[i] = modeA.tangentialAccel + modeA.tangentialAccelVar * CCRANDOM_MINUS1_1();
 
-        if (modeB.endRadius == START_RADIUS_EQUAL_TO_END_RADIUS)
-        {
-            particle->modeB.deltaRadius = 0;
+            // rotation is dir
+            if(modeA.rotationIsDir)
+                data.rotation[i] = -CC_RADIANS_TO_DEGREES(dir.getAngle());
         }
+
+        // Mode Radius: B
         else
         {
-            particle->modeB.deltaRadius = (endRadius - startRadius) / particle->timeToLive;
-        }
+            // Set the default diameter of the particle from the source position
+            float startRadius = modeB.startRadius + modeB.startRadiusVar * CCRANDOM_MINUS1_1();
+            float endRadius = modeB.endRadius + modeB.endRadiusVar * CCRANDOM_MINUS1_1();
+
+            data.modeB.radius[i] = startRadius;
+
+            if (modeB.endRadius == START_RADIUS_EQUAL_TO_END_RADIUS)
+            {
+                data.modeB.deltaRadius[i] = 0;
+            }
+            else
+            {
+                data.modeB.deltaRadius[i] = (endRadius - startRadius) / timeToLive;
+            }
 
-        particle->modeB.angle = a;
-        particle->modeB.degreesPerSecond = CC_DEGREES_TO_RADIANS(modeB.rotatePerSecond + modeB.rotatePerSecondVar * CCRANDOM_MINUS1_1());
-    }    
+            data.modeB.angle[i] = a;
+            data.modeB.degreesPerSecond[i] = CC_DEGREES_TO_RADIANS(modeB.rotatePerSecond + modeB.rotatePerSecondVar * CCRANDOM_MINUS1_1());
+        }
+    }
 }
 
 void ParticleSystem::onEnter()
@@ -645,8 +939,7 @@ void ParticleSystem::resetSystem()
     _elapsed = 0;
     for (_particleIdx = 0; _particleIdx < _particleCount; ++_particleIdx)
     {
-        tParticle *p = &_particles[_particleIdx];
-        p->timeToLive = 0;
+        _particleData.timeToLive[_particleIdx] = 0;
     }
 }
 bool ParticleSystem::isFull()
@@ -659,6 +952,12 @@ void ParticleSystem::update(float dt)
 {
     CC_PROFILER_START_CATEGORY(kProfilerCategoryParticles , "CCParticleSystem - update");
 
+    if (_updateDeferred)
+    {
+        // updated again before the end of the Scheduler update, by hand or because the event dispatcher is disabled
+        finishParallelUpdates();
+    }
+
     if (_isActive && _emissionRate)
     {
         float rate = 1.0f / _emissionRate;
@@ -667,12 +966,14 @@ void ParticleSystem::update(float dt)
         {
             _emitCounter += dt;
         }
-        
-        while (_particleCount < _totalParticles && _emitCounter > rate) 
+
+        int count = 0;
+        while (_particleCount + count < _totalParticles && _emitCounter > rate)
         {
-            this->addParticle();
+            ++count;
             _emitCounter -= rate;
         }
+        this->addParticles(count);
 
         _elapsed += dt;
         if (_duration != -1 && _duration < _elapsed)
@@ -681,457 +982,206 @@ void ParticleSystem::update(float dt)
         }
     }
 
-    _particleIdx = 0;
+    // the quads are drawn where the system is now
+    updateStartPosTransform();
 
-    Vec2 currentPosition = Vec2::ZERO;
-    if (_positionType == PositionType::FREE)
+    // the quads of a batch node are shared with other systems, those are updated here
+    if (s_parallelUpdateEnabled && ! _batchNode)
     {
-        currentPosition = this->convertToWorldSpace(Vec2::ZERO);
+        deferUpdate(dt);
     }
-    else if (_positionType == PositionType::RELATIVE)
+    else
     {
-        currentPosition = _position;
+        int particleCount = _particleCount;
+        updateParticles(dt);
+        updateParticleQuads();
+        if (!finishUpdate(particleCount))
+            return;
     }
 
+    CC_PROFILER_STOP_CATEGORY(kProfilerCategoryParticles , "CCParticleSystem - update");
+}
+
+bool ParticleSystem::finishUpdate(int particleCount)
+{
+    if( particleCount > 0 && _particleCount == 0 && _isAutoRemoveOnFinish )
     {
-        Mat4 worldToNodeTM = getWorldToNodeTransform();
-        
-        while (_particleIdx < _particleCount)
+        this->unscheduleUpdate();
+        if (_parent)
         {
-            tParticle *p = &_particles[_particleIdx];
-
-            // life
-            p->timeToLive -= dt;
-
-            if (p->timeToLive > 0) 
-            {
-                // Mode A: gravity, direction, tangential accel & radial accel
-                if (_emitterMode == Mode::GRAVITY)
-                {
-                    Vec2 tmp, radial, tangential;
-
-                    radial = Vec2::ZERO;
-                    // radial acceleration
-                    if (p->pos.x || p->pos.y)
-                    {
-                        radial = p->pos.getNormalized();
-                    }
-                    tangential = radial;
-                    radial = radial * p->modeA.radialAccel;
-
-                    // tangential acceleration
-                    float newy = tangential.x;
-                    tangential.x = -tangential.y;
-                    tangential.y = newy;
-                    tangential = tangential * p->modeA.tangentialAccel;
-
-                    // (gravity + radial + tangential) * dt
-                    tmp = radial + tangential + modeA.gravity;
-                    tmp = tmp * dt;
-                    p->modeA.dir = p->modeA.dir + tmp;
-                    
-                    // this is cocos2d-x v3.0
-//                    if (_configName.length()>0 && _yCoordFlipped != -1)
-
-                    // this is cocos2d-x v3.0
-                    tmp = p->modeA.dir * dt * _yCoordFlipped;
-                    p->pos = p->pos + tmp;
-                }
-
-                // Mode B: radius movement
-                else 
-                {                
-                    // Update the angle and radius of the particle.
-                    p->modeB.angle += p->modeB.degreesPerSecond * dt;
-                    p->modeB.radius += p->modeB.deltaRadius * dt;
-
-                    p->pos.x = - cosf(p->modeB.angle) * p->modeB.radius;
-                    p->pos.y = - sinf(p->modeB.angle) * p->modeB.radius;
-                    p->pos.y *= _yCoordFlipped;
-				}
-
-                // color
-                p->color.r += (p->deltaColor.r * dt);
-                p->color.g += (p->deltaColor.g * dt);
-                p->color.b += (p->deltaColor.b * dt);
-                p->color.a += (p->deltaColor.a * dt);
-
-                // size
-                p->size += (p->deltaSize * dt);
-                p->size = MAX( 0, p->size );
-
-                // angle
-                p->rotation += (p->deltaRotation * dt);
-
-                //
-                // update values in quad
-                //
-
-                Vec2    newPos;
-
-                if (_positionType == PositionType::FREE)
-                {
-                    Vec3 p1(currentPosition.x,currentPosition.y,0),p2(p->startPos.x,p->startPos.y,0);
-                    worldToNodeTM.transformPoint(&p1);
-                    worldToNodeTM.transformPoint(&p2);
-                    p1 = p1 - p2;
-                    newPos = p->pos - Vec2(p1.x,p1.y);
-                }
-                else if(_positionType == PositionType::RELATIVE)
-                {
-                    Vec2 diff = currentPosition - p->startPos;
-                    newPos = p->pos - diff;
-                } 
-                else
-                {
-                    newPos = p->pos;
-                }
-
-                // translate newPos to correct position, since matrix transform isn't performed in batchnode
-                // don't update the particle with the new position information, it will interfere with the radius and tangential calculations
-                if (_batchNode)
-                {
-                    newPos.x+=_position.x;
-                    newPos.y+=_position.y;
-                }
-
-                updateQuadWithParticle(p, newPos);
-                //updateParticleImp(self, updateParticleSel, p, newPos);
-
-                // update particle counter
-                ++_particleIdx;
-            } 
-            else 
-            {
-                // life < 0
-                int currentIndex = p->atlasIndex;
-                if( _particleIdx != _particleCount-1 )
-                {
-                    _particles[_particleIdx] = _particles[_particleCount-1];
-                }
-                if (_batchNode)
-                {
-                    //disable the switched particle
-                    _batchNode->disableParticle(_atlasIndex+currentIndex);
-
-                    //switch indexes
-                    _particles[_particleCount-1].atlasIndex = currentIndex;
-                }
-
+            _parent->removeChild(this, true);
+        }
+        return false;
+    }
 
-                --_particleCount;
+    _transformSystemDirty = false;
 
-                if( _particleCount == 0 && _isAutoRemoveOnFinish )
-                {
-                    this->unscheduleUpdate();
-                    _parent->removeChild(this, true);
-                    return;
-                }
-            }
-        } //while
-        _transformSystemDirty = false;
-    }
-    
     // only update gl buffer when visible
     if (_visible && ! _batchNode)
     {
         postStep();
     }
-
-    CC_PROFILER_STOP_CATEGORY(kProfilerCategoryParticles , "CCParticleSystem - update");
-}
-
-void ParticleSystem::updateWithNoTime(void)
-{
-    this->update(0.0f);
-}
-
-void ParticleSystem::updateQuadWithParticle(tParticle* particle, const Vec2& newPosition)
-{
-    CC_UNUSED_PARAM(particle);
-    CC_UNUSED_PARAM(newPosition);
-    // should be overridden
-}
-
-void ParticleSystem::postStep()
-{
-    // should be overridden
+    return true;
 }
 
-// ParticleSystem - Texture protocol
-void ParticleSystem::setTexture(Texture2D* var)
+void ParticleSystem::deferUpdate(float dt)
 {
-    if (_texture != var)
+    if (s_deferredSystems.empty())
     {
-        CC_SAFE_RETAIN(var);
-        CC_SAFE_RELEASE(_texture);
-        _texture = var;
-        updateBlendFunc();
+        // removed by finishParallelUpdates()
+        s_afterUpdateListener = Director::getInstance()->getEventDispatcher()->addCustomEventListener(Director::EVENT_AFTER_UPDATE, [](EventCustom*) {
+            ParticleSystem::finishParallelUpdates();
+        });
     }
+
+    this->retain();
+    s_deferredSystems.push_back(this);
+    _updateDeferred = true;
+    _deferredDelta = dt;
+    _deferredParticleCount = _particleCount;
 }
 
-void ParticleSystem::updateBlendFunc()
+void ParticleSystem::setParallelUpdateEnabled(bool enabled)
 {
-    CCASSERT(! _batchNode, "Can't change blending functions when the particle is being batched");
-
-    if(_texture)
+    if (!enabled)
     {
-        bool premultiplied = _texture->hasPremultipliedAlpha();
-        
-        _opacityModifyRGB = false;
-        
-        if( _texture && ( _blendFunc.src == CC_BLEND_SRC && _blendFunc.dst == CC_BLEND_DST ) )
-        {
-            if( premultiplied )
-            {
-                _opacityModifyRGB = true;
-            }
-            else
-            {
-                _blendFunc = BlendFunc::ALPHA_NON_PREMULTIPLIED;
-            }
-        }
+        finishParallelUpdates();
     }
+    s_parallelUpdateEnabled = enabled;
 }
 
-Texture2D * ParticleSystem::getTexture() const
+bool ParticleSystem::isParallelUpdateEnabled()
 {
-    return _texture;
+    return s_parallelUpdateEnabled;
 }
 
-// ParticleSystem - Additive Blending
-void ParticleSystem::setBlendAdditive(bool additive)
+void ParticleSystem::finishParallelUpdates()
 {
-    if( additive )
+    if (s_deferredSystems.empty())
+        return;
+
+    std::vector<ParticleSystem*> systems;
+    systems.swap(s_deferredSystems);
+    Director::getInstance()->getEventDispatcher()->removeEventListener(s_afterUpdateListener);
+    s_afterUpdateListener = nullptr;
+
+    // one system per job, each one only reads and writes its own values
+    auto simulate = [&systems](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i)
+        {
+            ParticleSystem* system = systems[i];
+            system->updateParticles(system->_deferredDelta);
+            system->updateParticleQuads();
+        }
+    };
+    JobSystem* jobSystem = Director::getInstance()->getJobSystem();
+    if (jobSystem && systems.size() > 1)
     {
-        _blendFunc = BlendFunc::ADDITIVE;
+        jobSystem->parallelFor(systems.size(), 1, simulate);
     }
     else
     {
-        if( _texture && ! _texture->hasPremultipliedAlpha() )
-            _blendFunc = BlendFunc::ALPHA_NON_PREMULTIPLIED;
-        else 
-            _blendFunc = BlendFunc::ALPHA_PREMULTIPLIED;
+        simulate(0, systems.size());
     }
-}
-
-bool ParticleSystem::isBlendAdditive() const
-{
-    return( _blendFunc.src == GL_SRC_ALPHA && _blendFunc.dst == GL_ONE);
-}
-
-// ParticleSystem - Properties of Gravity Mode 
-void ParticleSystem::setTangentialAccel(float t)
-{
-    CCASSERT( _emitterMode == Mode::GRAVITY, "Particle Mode should be Gravity");
-    modeA.tangentialAccel = t;
-}
-
-float ParticleSystem::getTangentialAccel() const
-{
-    CCASSERT( _emitterMode == Mode::GRAVITY, "Particle Mode should be Gravity");
-    return modeA.tangentialAccel;
-}
-
-void ParticleSystem::setTangentialAccelVar(float t)
-{
-    CCASSERT(_emitterMode == Mode::GRAVITY, "Particle Mode should be Gravity");
-    modeA.tangentialAccelVar = t;
-}
-
-float ParticleSystem::getTangentialAccelVar() const
-{
-    CCASSERT(_emitterMode == Mode::GRAVITY, "Particle Mode should be Gravity");
-    return modeA.tangentialAccelVar;
-}    
-
-void ParticleSystem::setRadialAccel(float t)
-{
-    CCASSERT(_emitterMode == Mode::GRAVITY, "Particle Mode should be Gravity");
-    modeA.radialAccel = t;
-}
-
-float ParticleSystem::getRadialAccel() const
-{
-    CCASSERT(_emitterMode == Mode::GRAVITY, "Particle Mode should be Gravity");
-    return modeA.radialAccel;
-}
 
-void ParticleSystem::setRadialAccelVar(float t)
-{
-    CCASSERT(_emitterMode == Mode::GRAVITY, "Particle Mode should be Gravity");
-    modeA.radialAccelVar = t;
-}
-
-float ParticleSystem::getRadialAccelVar() const
-{
-    CCASSERT(_emitterMode == Mode::GRAVITY, "Particle Mode should be Gravity");
-    return modeA.radialAccelVar;
-}
-
-void ParticleSystem::setRotationIsDir(bool t)
-{
-    CCASSERT(_emitterMode == Mode::GRAVITY, "Particle Mode should be Gravity");
-    modeA.rotationIsDir = t;
-}
-
-bool ParticleSystem::getRotationIsDir() const
-{
-    CCASSERT(_emitterMode == Mode::GRAVITY, "Particle Mode should be Gravity");
-    return modeA.rotationIsDir;
-}
-
-void ParticleSystem::setGravity(const Vec2& g)
-{
-    CCASSERT(_emitterMode == Mode::GRAVITY, "Particle Mode should be Gravity");
-    modeA.gravity = g;
-}
-
-const Vec2& ParticleSystem::getGravity()
-{
-    CCASSERT(_emitterMode == Mode::GRAVITY, "Particle Mode should be Gravity");
-    return modeA.gravity;
-}
-
-void ParticleSystem::setSpeed(float speed)
-{
-    CCASSERT(_emitterMode == Mode::GRAVITY, "Particle Mode should be Gravity");
-    modeA.speed = speed;
-}
-
-float ParticleSystem::getSpeed() const
-{
-    CCASSERT(_emitterMode == Mode::GRAVITY, "Particle Mode should be Gravity");
-    return modeA.speed;
-}
-
-void ParticleSystem::setSpeedVar(float speedVar)
-{
-    CCASSERT(_emitterMode == Mode::GRAVITY, "Particle Mode should be Gravity");
-    modeA.speedVar = speedVar;
-}
-
-float ParticleSystem::getSpeedVar() const
-{
-    CCASSERT(_emitterMode == Mode::GRAVITY, "Particle Mode should be Gravity");
-    return modeA.speedVar;
-}
-
-// ParticleSystem - Properties of Radius Mode
-void ParticleSystem::setStartRadius(float startRadius)
-{
-    CCASSERT(_emitterMode == Mode::RADIUS, "Particle Mode should be Radius");
-    modeB.startRadius = startRadius;
-}
-
-float ParticleSystem::getStartRadius() const
-{
-    CCASSERT(_emitterMode == Mode::RADIUS, "Particle Mode should be Radius");
-    return modeB.startRadius;
-}
-
-void ParticleSystem::setStartRadiusVar(float startRadiusVar)
-{
-    CCASSERT(_emitterMode == Mode::RADIUS, "Particle Mode should be Radius");
-    modeB.startRadiusVar = startRadiusVar;
-}
-
-float ParticleSystem::getStartRadiusVar() const
-{
-    CCASSERT(_emitterMode == Mode::RADIUS, "Particle Mode should be Radius");
-    return modeB.startRadiusVar;
-}
-
-void ParticleSystem::setEndRadius(float endRadius)
-{
-    CCASSERT(_emitterMode == Mode::RADIUS, "Particle Mode should be Radius");
-    modeB.endRadius = endRadius;
-}
-
-float ParticleSystem::getEndRadius() const
-{
-    CCASSERT(_emitterMode == Mode::RADIUS, "Particle Mode should be Radius");
-    return modeB.endRadius;
-}
-
-void ParticleSystem::setEndRadiusVar(float endRadiusVar)
-{
-    CCASSERT(_emitterMode == Mode::RADIUS, "Particle Mode should be Radius");
-    modeB.endRadiusVar = endRadiusVar;
+    // in the order of the updates
+    for (auto system : systems)
+    {
+        system->_updateDeferred = false;
+        system->finishUpdate(system->_deferredParticleCount);
+        // not released now, a system removed by finishUpdate() may be in its update()
+        system->autorelease();
+    }
 }
 
-float ParticleSystem::getEndRadiusVar() const
+void ParticleSystem::updateParticles(float dt)
 {
-    CCASSERT(_emitterMode == Mode::RADIUS, "Particle Mode should be Radius");
-    return modeB.endRadiusVar;
-}
+    // life
+    updateLife(_particleData.timeToLive, _particleCount, dt);
 
-void ParticleSystem::setRotatePerSecond(float degrees)
-{
-    CCASSERT(_emitterMode == Mode::RADIUS, "Particle Mode should be Radius");
-    modeB.rotatePerSecond = degrees;
-}
+    // the dead particles are replaced by the last ones
+    for (_particleIdx = 0; _particleIdx < _particleCount; )
+    {
+        if (_particleData.timeToLive[_particleIdx] > 0)
+        {
+            ++_particleIdx;
+            continue;
+        }
 
-float ParticleSystem::getRotatePerSecond() const
-{
-    CCASSERT(_emitterMode == Mode::RADIUS, "Particle Mode should be Radius");
-    return modeB.rotatePerSecond;
-}
+        // life < 0
+        int currentIndex = _particleData.atlasIndex[_particleIdx];
+        if( _particleIdx != _particleCount-1 )
+        {
+            _particleData.copyParticle(_particleIdx, _particleCount-1);
+        }
+        if (_batchNode)
+        {
+            //disable the switched particle
+            _batchNode->disableParticle(_atlasIndex+currentIndex);
 
-void ParticleSystem::setRotatePerSecondVar(float degrees)
-{
-    CCASSERT(_emitterMode == Mode::RADIUS, "Particle Mode should be Radius");
-    modeB.rotatePerSecondVar = degrees;
-}
+            //switch indexes
+            _particleData.atlasIndex[_particleCount-1] = currentIndex;
+        }
 
-float ParticleSystem::getRotatePerSecondVar() const
-{
-    CCASSERT(_emitterMode == Mode::RADIUS, "Particle Mode should be Radius");
-    return modeB.rotatePerSecondVar;
-}
+        --_particleCount;
+    }
 
-bool ParticleSystem::isActive() const
-{
-    return _isActive;
+    if (_emitterMode == Mode::GRAVITY)
+    {
+        // this is cocos2d-x v3.0
+        updateGravityMode(_particleData, _particleCount, modeA.gravity, dt, (float)_yCoordFlipped);
+    }
+    else
+    {
+        updateRadiusMode(_particleData, _particleCount, dt, (float)_yCoordFlipped);
+    }
+    updateAppearance(_particleData, _particleCount, dt);
 }
 
-int ParticleSystem::getTotalParticles() const
+void ParticleSystem::updateStartPosTransform()
 {
-    return _totalParticles;
-}
+    // translate to the correct position, since matrix transform isn't performed in batchnode
+    // the particles positions aren't changed, it would interfere with the radius and tangential calculations
+    Vec2 offset = _batchNode ? _position : Vec2::ZERO;
 
-void ParticleSystem::setTotalParticles(int var)
-{
-    CCASSERT( var <= _allocatedParticles, "Particle: resizing particle array only supported for quads");
-    _totalParticles = var;
-}
+    if (_positionType == PositionType::FREE)
+    {
+        // pos - (M * currentPosition - M * startPos), M being the world to node transform
+        Mat4 worldToNodeTM = getWorldToNodeTransform();
+        Vec2 currentPosition = this->convertToWorldSpace(Vec2::ZERO);
+        Vec3 current(currentPosition.x, currentPosition.y, 0);
+        worldToNodeTM.transformPoint(&current);
 
-const BlendFunc& ParticleSystem::getBlendFunc() const
-{
-    return _blendFunc;
+        const float* m = worldToNodeTM.m;
+        _startPosTransform = AffineTransformMake(m[0], m[1], m[4], m[5],
+                                                 m[12] - current.x + offset.x, m[13] - current.y + offset.y);
+    }
+    else if (_positionType == PositionType::RELATIVE)
+    {
+        // pos - (currentPosition - startPos)
+        _startPosTransform = AffineTransformMake(1, 0, 0, 1, offset.x - _position.x, offset.y - _position.y);
+    }
+    else
+    {
+        _startPosTransform = AffineTransformMake(0, 0, 0, 0, offset.x, offset.y);
+    }
 }
 
-void ParticleSystem::setBlendFunc(const BlendFunc &blendFunc)
+void ParticleSystem::updateWithNoTime(void)
 {
-    if( _blendFunc.src != blendFunc.src || _blendFunc.dst != blendFunc.dst ) {
-        _blendFunc = blendFunc;
-        this->updateBlendFunc();
-    }
+    this->update(0.0f);
 }
 
-bool ParticleSystem::isAutoRemoveOnFinish() const
+void ParticleSystem::updateParticleQuads()
 {
-    return _isAutoRemoveOnFinish;
+    // should be overridden
 }
 
-void ParticleSystem::setAutoRemoveOnFinish(bool var)
+void ParticleSystem::postStep()
 {
-    _isAutoRemoveOnFinish = var;
+    // should be overridden
 }
 
-
-// ParticleSystem - methods for batchNode rendering
-
 ParticleBatchNode* ParticleSystem::getBatchNode(void) const
 {
     return _batchNode;
@@ -1141,13 +1191,19 @@ void ParticleSystem::setBatchNode(ParticleBatchNode* batchNode)
 {
     if( _batchNode != batchNode ) {
 
+        if (_updateDeferred)
+        {
+            // the deferred update would write the quads of the batch node from a worker
+            finishParallelUpdates();
+        }
+
         _batchNode = batchNode; // weak reference
 
         if( batchNode ) {
             //each particle needs a unique index
             for (int i = 0; i < _totalParticles; i++)
             {
-                _particles[i].atlasIndex=i;
+                _particleData.atlasIndex[i]=i;
             }
         }
     }
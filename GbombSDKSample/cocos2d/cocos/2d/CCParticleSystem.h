@@ -41,43 +41,68 @@ NS_CC_BEGIN
 class ParticleBatchNode;
 
 /**
-Structure that contains the values of each particle
+Values of the particles, one array per value (structure of arrays), so that the update loops
+go through contiguous memory and can process several particles at once.
+The arrays are allocated in one block, aligned on 16 bytes and padded to a multiple of 4 particles.
 */
-typedef struct sParticle {
-    Vec2     pos;
-    Vec2     startPos;
-
-    Color4F    color;
-    Color4F    deltaColor;
-
-    float        size;
-    float        deltaSize;
-
-    float        rotation;
-    float        deltaRotation;
-
-    float        timeToLive;
-
-    unsigned int    atlasIndex;
+class CC_DLL ParticleData
+{
+public:
+    float* posx;
+    float* posy;
+    float* startPosX;
+    float* startPosY;
+
+    float* colorR;
+    float* colorG;
+    float* colorB;
+    float* colorA;
+
+    float* deltaColorR;
+    float* deltaColorG;
+    float* deltaColorB;
+    float* deltaColorA;
+
+    float* size;
+    float* deltaSize;
+    float* rotation;
+    float* deltaRotation;
+    float* timeToLive;
+    unsigned int* atlasIndex;
 
     //! Mode A: gravity, direction, radial accel, tangential accel
     struct {
-        Vec2        dir;
-        float        radialAccel;
-        float        tangentialAccel;
+        float* dirX;
+        float* dirY;
+        float* radialAccel;
+        float* tangentialAccel;
     } modeA;
 
     //! Mode B: radius mode
     struct {
-        float        angle;
-        float        degreesPerSecond;
-        float        radius;
-        float        deltaRadius;
+        float* angle;
+        float* degreesPerSecond;
+        float* radius;
+        float* deltaRadius;
     } modeB;
 
-}tParticle;
+    unsigned int maxCount;
+
+    ParticleData();
+    ~ParticleData();
+    /** Allocates the arrays for count particles, zeroed. The previous values are lost. */
+    bool init(int count);
+    void release();
+    unsigned int getMaxCount() { return maxCount; }
+
+    /** Copies the values of particle p2 to particle p1 */
+    void copyParticle(int p1, int p2);
+
+private:
+    void* _memory;
 
-//typedef void (*CC_UPDATE_PARTICLE_IMP)(id, SEL, tParticle*, Vec2);
+    CC_DISALLOW_COPY_AND_ASSIGN(ParticleData);
+};
 
 class Texture2D;
 
@@ -181,8 +206,8 @@ public:
 
     //! Add a particle to the emitter
     bool addParticle();
-    //! Initializes a particle
-    void initParticle(tParticle* particle);
+    //! Add count particles to the emitter, as many as fit
+    void addParticles(int count);
     //! stop emitting particles. Running particles will continue to run until they die
     void stopSystem();
     //! Kill all living particles.
@@ -190,13 +215,35 @@ public:
     //! whether or not the system is full
     bool isFull();
 
-    //! should be overridden by subclasses
-    virtual void updateQuadWithParticle(tParticle* particle, const Vec2& newPosition);
+    /** Writes the quads of the _particleCount particles, called once per update.
+     should be overridden by subclasses
+     */
+    virtual void updateParticleQuads();
     //! should be overridden by subclasses
     virtual void postStep();
 
     virtual void updateWithNoTime(void);
 
+    /** Simulates the particles of the systems in parallel, in the JobSystem workers.
+
+     update() still emits the new particles in the cocos2d thread, so the random values are drawn
+     in the same order as when the systems are updated one after the other. The rest of the update
+     of the systems that aren't in a batch node is deferred to finishParallelUpdates(), at the end
+     of the Scheduler update (Director::EVENT_AFTER_UPDATE): their particles are moved and their quads
+     written in the workers, one system per job, then the quads are uploaded in the cocos2d thread.
+     Each system only reads its own values, so the results don't depend on the threads and are
+     the same as with the serial update.
+
+     Until the end of the Scheduler update, the particles of a deferred system are those of the
+     previous frame, plus the emitted ones. updateParticleQuads() runs in a worker, it must not
+     call the cocos2d API.
+     Off by default.
+     */
+    static void setParallelUpdateEnabled(bool enabled);
+    static bool isParallelUpdateEnabled();
+    /** Finishes the updates deferred by the parallel update, called at the end of the Scheduler update */
+    static void finishParallelUpdates();
+
     virtual bool isAutoRemoveOnFinish() const;
     virtual void setAutoRemoveOnFinish(bool var);
 
@@ -464,8 +511,27 @@ protected:
         float rotatePerSecondVar;
     } modeB;
 
-    //! Array of particles
-    tParticle *_particles;
+    /** Initializes the values of the particles from start to start + count - 1 */
+    void initParticles(int start, int count);
+    /** Moves the particles by dt and removes the dead ones. It only accesses the values of the system. */
+    void updateParticles(float dt);
+    /** Updates _startPosTransform for the current position of the system */
+    void updateStartPosTransform();
+    /** The end of update(), in the cocos2d thread. Returns false if the system was removed from its parent.
+     @param particleCount The count of particles before updateParticles().
+     */
+    bool finishUpdate(int particleCount);
+    /** Queues the system for finishParallelUpdates() */
+    void deferUpdate(float dt);
+
+    //! Values of the particles
+    ParticleData _particleData;
+
+    /** Where a particle is drawn, in the space of the system (or of the batch node):
+     (posx, posy) + _startPosTransform applied to (startPosX, startPosY).
+     It accounts for the moves of the system since the particle was emitted.
+     */
+    AffineTransform _startPosTransform;
 
     //Emitter name
     std::string _configName;
@@ -491,6 +557,11 @@ protected:
 
     //true if scaled or rotated
     bool _transformSystemDirty;
+    //true if queued for finishParallelUpdates()
+    bool _updateDeferred;
+    // delta time and count of particles of the deferred update
+    float _deferredDelta;
+    int _deferredParticleCount;
     // Number of allocated particles
     int _allocatedParticles;
 
@@ -188,6 +188,7 @@ void ProtectedNode::removeProtectedChild(cocos2d::Node *child, bool cleanup)
         child->setParent(nullptr);
         
         _protectedChildren.erase(index);
+        setSubtreeBoundsDirty();
     }
 }
 
@@ -226,6 +227,7 @@ void ProtectedNode::removeAllProtectedChildrenWithCleanup(bool cleanup)
     }
     
     _protectedChildren.clear();
+    setSubtreeBoundsDirty();
 }
 
 void ProtectedNode::removeProtectedChildByTag(int tag, bool cleanup)
@@ -255,7 +257,7 @@ void ProtectedNode::insertProtectedChild(cocos2d::Node *child, int z)
 void ProtectedNode::sortAllProtectedChildren()
 {
     if( _reorderProtectedChildDirty ) {
-        std::sort( std::begin(_protectedChildren), std::end(_protectedChildren), nodeComparisonLess );
+        sortNodes(_protectedChildren);
         _reorderProtectedChildDirty = false;
     }
 }
@@ -277,14 +279,23 @@ void ProtectedNode::visit(Renderer* renderer, const Mat4 &parentTransform, uint3
     }
     
     uint32_t flags = processParentFlags(parentTransform, parentFlags);
+
+    if (cullSubtree(flags))
+    {
+        return;
+    }
     
     // IMPORTANT:
     // To ease the migration to v3.0, we still support the Mat4 stack,
     // but it is deprecated and your code should not rely on it
     Director* director = Director::getInstance();
     CCASSERT(nullptr != director, "Director is null when seting matrix stack");
-    director->pushMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW);
-    director->loadMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW, _modelViewTransform);
+    bool legacyMatrixStack = usesLegacyMatrixStack();
+    if (legacyMatrixStack)
+    {
+        director->pushMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW);
+        director->loadMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW, _modelViewTransform);
+    }
     
     int i = 0;      // used by _children
     int j = 0;      // used by _protectedChildren
@@ -334,7 +345,8 @@ void ProtectedNode::visit(Renderer* renderer, const Mat4 &parentTransform, uint3
     // Please refer to https://github.com/cocos2d/cocos2d-x/pull/6920
     // setOrderOfArrival(0);
     
-    director->popMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW);
+    if (legacyMatrixStack)
+        director->popMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW);
 }
 
 void ProtectedNode::onEnter()
@@ -408,6 +420,15 @@ void ProtectedNode::updateDisplayedColor(const Color3B& parentColor)
     }
 }
 
+void ProtectedNode::mergeChildrenSubtreeBounds(Vec3* min, Vec3* max)
+{
+    Node::mergeChildrenSubtreeBounds(min, max);
+    for (const auto& child : _protectedChildren)
+    {
+        mergeSubtreeBounds(child, min, max);
+    }
+}
+
 void ProtectedNode::disableCascadeColor()
 {
     for(auto child : _children){
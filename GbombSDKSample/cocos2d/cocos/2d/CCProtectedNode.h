@@ -171,6 +171,8 @@ protected:
     
     /// helper that reorder a child
     void insertProtectedChild(Node* child, int z);
+
+    virtual void mergeChildrenSubtreeBounds(Vec3* min, Vec3* max) override;
     
     Vector<Node*> _protectedChildren;        ///< array of children nodes
     bool _reorderProtectedChildDirty;
@@ -38,6 +38,7 @@ cocos2d.cpp \
 2d/CCGLBufferedNode.cpp \
 2d/CCGrabber.cpp \
 2d/CCGrid.cpp \
+2d/CCInstancedSpriteNode.cpp \
 2d/CCLabel.cpp \
 2d/CCLabelAtlas.cpp \
 2d/CCLabelBMFont.cpp \
@@ -113,11 +114,14 @@ base/CCEventListenerMouse.cpp \
 base/CCEventListenerTouch.cpp \
 base/CCEventMouse.cpp \
 base/CCEventTouch.cpp \
+base/CCFunctionQueue.cpp \
 base/CCIMEDispatcher.cpp \
+base/CCJobSystem.cpp \
 base/CCNS.cpp \
 base/CCProfiling.cpp \
 base/ccRandom.cpp \
 base/CCRef.cpp \
+base/CCRefPool.cpp \
 base/CCScheduler.cpp \
 base/CCScriptSupport.cpp \
 base/CCTouch.cpp \
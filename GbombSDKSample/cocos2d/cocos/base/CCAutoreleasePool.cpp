@@ -25,25 +25,31 @@ THE SOFTWARE.
 #include "base/CCAutoreleasePool.h"
 #include "base/ccMacros.h"
 
+#include <algorithm>
+
 NS_CC_BEGIN
 
 AutoreleasePool::AutoreleasePool()
 : _name("")
+, _generation(0)
 #if defined(COCOS2D_DEBUG) && (COCOS2D_DEBUG > 0)
 , _isClearing(false)
 #endif
 {
     _managedObjectArray.reserve(150);
+    resetStats();
     PoolManager::getInstance()->push(this);
 }
 
 AutoreleasePool::AutoreleasePool(const std::string &name)
 : _name(name)
+, _generation(0)
 #if defined(COCOS2D_DEBUG) && (COCOS2D_DEBUG > 0)
 , _isClearing(false)
 #endif
 {
     _managedObjectArray.reserve(150);
+    resetStats();
     PoolManager::getInstance()->push(this);
 }
 
@@ -65,16 +71,33 @@ void AutoreleasePool::clear()
 #if defined(COCOS2D_DEBUG) && (COCOS2D_DEBUG > 0)
     _isClearing = true;
 #endif
-    for (const auto &obj : _managedObjectArray)
+    // by index, the destructors may add objects to the array
+    size_t count = _managedObjectArray.size();
+    for (size_t i = 0; i < count; ++i)
     {
-        obj->release();
+        _managedObjectArray[i]->release();
     }
-    _managedObjectArray.clear();
+    // the objects added meanwhile, usually none, move to the front
+    _managedObjectArray.erase(_managedObjectArray.begin(), _managedObjectArray.begin() + count);
+    ++_generation;
+
+    ++_stats.clears;
+    _stats.lastObjects = (unsigned int)count;
+    _stats.peakObjects = std::max(_stats.peakObjects, _stats.lastObjects);
+    _stats.totalObjects += count;
 #if defined(COCOS2D_DEBUG) && (COCOS2D_DEBUG > 0)
     _isClearing = false;
 #endif
 }
 
+void AutoreleasePool::resetStats()
+{
+    _stats.clears = 0;
+    _stats.lastObjects = 0;
+    _stats.peakObjects = 0;
+    _stats.totalObjects = 0;
+}
+
 bool AutoreleasePool::contains(Ref* object) const
 {
     for (const auto& obj : _managedObjectArray)
@@ -88,6 +111,8 @@ bool AutoreleasePool::contains(Ref* object) const
 void AutoreleasePool::dump()
 {
     CCLOG("autorelease pool: %s, number of managed object %d\n", _name.c_str(), static_cast<int>(_managedObjectArray.size()));
+    CCLOG("generation %u, objects per clear: last %u, peak %u, average %.1f\n", _generation, _stats.lastObjects, _stats.peakObjects,
+          _stats.clears ? _stats.totalObjects / _stats.clears : 0.0);
     CCLOG("%20s%20s%20s", "Object pointer", "Object id", "reference count");
     for (const auto &obj : _managedObjectArray)
     {
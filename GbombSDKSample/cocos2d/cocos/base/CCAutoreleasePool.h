@@ -39,6 +39,15 @@ NS_CC_BEGIN
 class CC_DLL AutoreleasePool
 {
 public:
+    /** Counters of clear(), since the pool was created or resetStats() was called */
+    struct Stats
+    {
+        unsigned int clears;
+        unsigned int lastObjects;       ///< objects released by the last clear()
+        unsigned int peakObjects;       ///< most objects released by one clear()
+        double totalObjects;            ///< objects released by all the clear() calls
+    };
+
     /**
      * @warn Don't create an auto release pool in heap, create it in stack.
      * @js NA
@@ -74,11 +83,22 @@ public:
      * Clear the autorelease pool.
      *
      * Ref::release() will be called for each time the managed object is
-     * added to the pool.
+     * added to the pool. The objects added while clearing, by the destructors
+     * of the released objects, are kept for the next clear.
+     * The capacity of the pool is kept, so clearing it every frame doesn't allocate.
      * @js NA
      * @lua NA
      */
     void clear();
+
+    /** Number of clear() calls, the objects added after it belong to the next one */
+    unsigned int getGeneration() const { return _generation; }
+
+    /** Objects waiting for the next clear() */
+    ssize_t getObjectCount() const { return _managedObjectArray.size(); }
+
+    const Stats& getStats() const { return _stats; }
+    void resetStats();
     
 #if defined(COCOS2D_DEBUG) && (COCOS2D_DEBUG > 0)
     /**
@@ -113,6 +133,8 @@ private:
      */
     std::vector<Ref*> _managedObjectArray;
     std::string _name;
+    unsigned int _generation;
+    Stats _stats;
     
 #if defined(COCOS2D_DEBUG) && (COCOS2D_DEBUG > 0)
     /**
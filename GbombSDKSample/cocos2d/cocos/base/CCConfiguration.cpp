@@ -44,6 +44,8 @@ Configuration::Configuration()
 , _supportsBGRA8888(false)
 , _supportsDiscardFramebuffer(false)
 , _supportsShareableVAO(false)
+, _supportsElementIndexUint(false)
+, _supportsInstancedArrays(false)
 , _maxSamplesAllowed(0)
 , _maxTextureUnits(0)
 , _glExtensions(nullptr)
@@ -139,6 +141,17 @@ void Configuration::gatherGPUInfo()
     _supportsShareableVAO = checkForGLExtension("vertex_array_object");
 	_valueDict["gl.supports_vertex_array_object"] = Value(_supportsShareableVAO);
 
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_MAC || CC_TARGET_PLATFORM == CC_PLATFORM_WIN32 || CC_TARGET_PLATFORM == CC_PLATFORM_LINUX)
+    _supportsElementIndexUint = true;
+#else
+    _supportsElementIndexUint = checkForGLExtension("GL_OES_element_index_uint");
+#endif
+    _valueDict["gl.supports_element_index_uint"] = Value(_supportsElementIndexUint);
+
+    // GL_EXT_, GL_ANGLE_, GL_NV_ and GL_ARB_instanced_arrays
+    _supportsInstancedArrays = checkForGLExtension("_instanced_arrays");
+    _valueDict["gl.supports_instanced_arrays"] = Value(_supportsInstancedArrays);
+
     CHECK_GL_ERROR_DEBUG();
 }
 
@@ -244,6 +257,16 @@ bool Configuration::supportsShareableVAO() const
 #endif
 }
 
+bool Configuration::supportsElementIndexUint() const
+{
+    return _supportsElementIndexUint;
+}
+
+bool Configuration::supportsInstancedArrays() const
+{
+    return _supportsInstancedArrays;
+}
+
 //
 // generic getters for properties
 //
@@ -111,6 +111,15 @@ public:
      */
 	bool supportsShareableVAO() const;
 
+    /** Whether or not GL_UNSIGNED_INT indices can be drawn, always true on desktop GL.
+     */
+    bool supportsElementIndexUint() const;
+
+    /** Whether or not the vertex attributes can advance per instance, with GL_EXT, GL_ANGLE or GL_NV_instanced_arrays
+     on OpenGL ES and GL_ARB_instanced_arrays on desktop GL.
+     */
+    bool supportsInstancedArrays() const;
+
     /** returns whether or not an OpenGL is supported */
     bool checkForGLExtension(const std::string &searchName) const;
 
@@ -147,6 +156,8 @@ protected:
     bool            _supportsBGRA8888;
     bool            _supportsDiscardFramebuffer;
     bool            _supportsShareableVAO;
+    bool            _supportsElementIndexUint;
+    bool            _supportsInstancedArrays;
     GLint           _maxSamplesAllowed;
     GLint           _maxTextureUnits;
     char *          _glExtensions;
@@ -63,6 +63,8 @@
 #include "renderer/CCTextureCache.h"
 #include "base/base64.h"
 #include "base/ccUtils.h"
+#include "base/CCRefPool.h"
+#include "base/CCAutoreleasePool.h"
 NS_CC_BEGIN
 
 extern const char* cocos2dVersion(void);
@@ -268,6 +270,7 @@ Console::Console()
 {
     // VS2012 doesn't support initializer list, so we create a new array and assign its elements to '_command'.
 	Command commands[] = {     
+        { "allocator", "Trim or print the RefPool and AutoreleasePool counters. Args: [purge | ] ", std::bind(&Console::commandAllocator, this, std::placeholders::_1, std::placeholders::_2) },
         { "config", "Print the Configuration object", std::bind(&Console::commandConfig, this, std::placeholders::_1, std::placeholders::_2) },
         { "debugmsg", "Whether or not to forward the debug messages on the console. Args: [on | off]", [&](int fd, const std::string& args) {
             if( args.compare("on")==0 || args.compare("off")==0) {
@@ -592,6 +595,34 @@ void Console::commandTextures(int fd, const std::string& args)
 }
 
 
+void Console::commandAllocator(int fd, const std::string& args)
+{
+    Scheduler *sched = Director::getInstance()->getScheduler();
+
+    if( args.compare("purge")== 0)
+    {
+        sched->performFunctionInCocosThread( [](){
+            RefPool::purgeAll();
+        }
+                                            );
+    }
+    else if(args.length()==0)
+    {
+        sched->performFunctionInCocosThread( [=](){
+            mydprintf(fd, "%s", RefPool::getStatsInfo().c_str());
+            const auto& stats = PoolManager::getInstance()->getCurrentPool()->getStats();
+            mydprintf(fd, "AutoreleasePool: objects per clear: last %u, peak %u, average %.1f\n",
+                      stats.lastObjects, stats.peakObjects, stats.clears ? stats.totalObjects / stats.clears : 0.0);
+            sendPrompt(fd);
+        }
+                                            );
+    }
+    else
+    {
+        mydprintf(fd, "Unsupported argument: '%s'. Supported arguments: 'purge' or nothing", args.c_str());
+    }
+}
+
 void Console::commandDirector(int fd, const std::string& args)
 {
      auto director = Director::getInstance();
@@ -55,6 +55,8 @@ THE SOFTWARE.
 #include "base/CCEventDispatcher.h"
 #include "base/CCEventCustom.h"
 #include "base/CCConsole.h"
+#include "base/CCJobSystem.h"
+#include "base/CCRefPool.h"
 #include "base/CCAutoreleasePool.h"
 #include "base/CCConfiguration.h"
 #include "platform/CCApplication.h"
@@ -98,6 +100,8 @@ Director* Director::getInstance()
 }
 
 Director::Director()
+: _renderer(nullptr)
+, _jobSystem(nullptr)
 {
 }
 
@@ -158,6 +162,10 @@ bool Director::init(void)
 #if (CC_TARGET_PLATFORM != CC_PLATFORM_WINRT)
     _console = new (std::nothrow) Console;
 #endif
+
+    // the cocos2d thread takes part in the jobs it waits for
+    unsigned int cores = std::thread::hardware_concurrency();
+    _jobSystem = new (std::nothrow) JobSystem(cores > 1 ? cores - 1 : 1);
     return true;
 }
 
@@ -165,6 +173,9 @@ Director::~Director(void)
 {
     CCLOGINFO("deallocing Director: %p", this);
 
+    // before the scheduler, the jobs may post continuations to it
+    CC_SAFE_DELETE(_jobSystem);
+
     CC_SAFE_RELEASE(_FPSLabel);
     CC_SAFE_RELEASE(_drawnVerticesLabel);
     CC_SAFE_RELEASE(_drawnBatchesLabel);
@@ -179,7 +190,7 @@ Director::~Director(void)
     delete _eventAfterVisit;
     delete _eventProjectionChanged;
 
-    delete _renderer;
+    CC_SAFE_DELETE(_renderer);
 
 #if (CC_TARGET_PLATFORM != CC_PLATFORM_WINRT)
     delete _console;
@@ -493,136 +504,57 @@ void Director::resetMatrixStack()
     initMatrixStack();
 }
 
-void Director::popMatrix(MATRIX_STACK_TYPE type)
+std::stack<Mat4>& Director::getMatrixStack(MATRIX_STACK_TYPE type)
 {
-    if(MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW == type)
+    // nodes visited on a recording thread of the renderer get their own copy of the stacks
+    std::stack<Mat4>* recordingStacks = _renderer ? _renderer->getRecordingMatrixStacks() : nullptr;
+    if (recordingStacks)
     {
-        _modelViewMatrixStack.pop();
+        return recordingStacks[static_cast<int>(type)];
     }
-    else if(MATRIX_STACK_TYPE::MATRIX_STACK_PROJECTION == type)
+
+    if(MATRIX_STACK_TYPE::MATRIX_STACK_PROJECTION == type)
     {
-        _projectionMatrixStack.pop();
+        return _projectionMatrixStack;
     }
     else if(MATRIX_STACK_TYPE::MATRIX_STACK_TEXTURE == type)
     {
-        _textureMatrixStack.pop();
-    }
-    else
-    {
-        CCASSERT(false, "unknow matrix stack type");
+        return _textureMatrixStack;
     }
+
+    CCASSERT(MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW == type, "unknow matrix stack type");
+    return _modelViewMatrixStack;
+}
+
+void Director::popMatrix(MATRIX_STACK_TYPE type)
+{
+    getMatrixStack(type).pop();
 }
 
 void Director::loadIdentityMatrix(MATRIX_STACK_TYPE type)
 {
-    if(MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW == type)
-    {
-        _modelViewMatrixStack.top() = Mat4::IDENTITY;
-    }
-    else if(MATRIX_STACK_TYPE::MATRIX_STACK_PROJECTION == type)
-    {
-        _projectionMatrixStack.top() = Mat4::IDENTITY;
-    }
-    else if(MATRIX_STACK_TYPE::MATRIX_STACK_TEXTURE == type)
-    {
-        _textureMatrixStack.top() = Mat4::IDENTITY;
-    }
-    else
-    {
-        CCASSERT(false, "unknow matrix stack type");
-    }
+    getMatrixStack(type).top() = Mat4::IDENTITY;
 }
 
 void Director::loadMatrix(MATRIX_STACK_TYPE type, const Mat4& mat)
 {
-    if(MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW == type)
-    {
-        _modelViewMatrixStack.top() = mat;
-    }
-    else if(MATRIX_STACK_TYPE::MATRIX_STACK_PROJECTION == type)
-    {
-        _projectionMatrixStack.top() = mat;
-    }
-    else if(MATRIX_STACK_TYPE::MATRIX_STACK_TEXTURE == type)
-    {
-        _textureMatrixStack.top() = mat;
-    }
-    else
-    {
-        CCASSERT(false, "unknow matrix stack type");
-    }
+    getMatrixStack(type).top() = mat;
 }
 
 void Director::multiplyMatrix(MATRIX_STACK_TYPE type, const Mat4& mat)
 {
-    if(MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW == type)
-    {
-        _modelViewMatrixStack.top() *= mat;
-    }
-    else if(MATRIX_STACK_TYPE::MATRIX_STACK_PROJECTION == type)
-    {
-        _projectionMatrixStack.top() *= mat;
-    }
-    else if(MATRIX_STACK_TYPE::MATRIX_STACK_TEXTURE == type)
-    {
-        _textureMatrixStack.top() *= mat;
-    }
-    else
-    {
-        CCASSERT(false, "unknow matrix stack type");
-    }
+    getMatrixStack(type).top() *= mat;
 }
 
 void Director::pushMatrix(MATRIX_STACK_TYPE type)
 {
-    if(MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW == type)
-    {
-        _modelViewMatrixStack.push(_modelViewMatrixStack.top());
-    }
-    else if(MATRIX_STACK_TYPE::MATRIX_STACK_PROJECTION == type)
-    {
-        _projectionMatrixStack.push(_projectionMatrixStack.top());
-    }
-    else if(MATRIX_STACK_TYPE::MATRIX_STACK_TEXTURE == type)
-    {
-        _textureMatrixStack.push(_textureMatrixStack.top());
-    }
-    else
-    {
-        CCASSERT(false, "unknow matrix stack type");
-    }
+    std::stack<Mat4>& stack = getMatrixStack(type);
+    stack.push(stack.top());
 }
 
 Mat4 Director::getMatrix(MATRIX_STACK_TYPE type)
 {
-    Mat4 result;
-    if(MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW == type)
-    {
-        result = _modelViewMatrixStack.top();
-    }
-    else if(MATRIX_STACK_TYPE::MATRIX_STACK_PROJECTION == type)
-    {
-        result = _projectionMatrixStack.top();
-    }
-    else if(MATRIX_STACK_TYPE::MATRIX_STACK_TEXTURE == type)
-    {
-        result = _textureMatrixStack.top();
-    }
-    else
-    {
-        CCASSERT(false, "unknow matrix stack type, will return modelview matrix instead");
-        result =  _modelViewMatrixStack.top();
-    }
-//    float diffResult(0);
-//    for (int index = 0; index <16; ++index)
-//    {
-//        diffResult += abs(result2.mat[index] - result.mat[index]);
-//    }
-//    if(diffResult > 1e-30)
-//    {
-//        CCASSERT(false, "Error in director matrix stack");
-//    }
-    return result;
+    return getMatrixStack(type).top();
 }
 
 void Director::setProjection(Projection projection)
@@ -709,6 +641,7 @@ void Director::purgeCachedData(void)
         log("%s\n", _textureCache->getCachedTextureInfo().c_str());
     }
     FileUtils::getInstance()->purgeCachedEntries();
+    RefPool::purgeAll();
 }
 
 float Director::getZEye(void) const
@@ -58,6 +58,7 @@ class EventListenerCustom;
 class TextureCache;
 class Renderer;
 class Camera;
+class JobSystem;
 
 #if  (CC_TARGET_PLATFORM != CC_PLATFORM_WINRT)
 class Console;
@@ -98,6 +99,7 @@ private:
     std::stack<Mat4> _textureMatrixStack;
 protected:
     void initMatrixStack();
+    std::stack<Mat4>& getMatrixStack(MATRIX_STACK_TYPE type);
 public:
     void pushMatrix(MATRIX_STACK_TYPE type);
     void popMatrix(MATRIX_STACK_TYPE type);
@@ -395,6 +397,9 @@ public:
     Console* getConsole() const { return _console; }
 #endif
 
+    /** Returns the JobSystem, its workers run jobs for the engine and the game */
+    JobSystem* getJobSystem() const { return _jobSystem; }
+
     /* Gets delta time since last tick to main loop */
 	float getDeltaTime() const;
     
@@ -508,6 +513,9 @@ protected:
     Console *_console;
 #endif
 
+    /* JobSystem for the director */
+    JobSystem *_jobSystem;
+
     // GLView will recreate stats labels to fit visible rect
     friend class GLView;
 };
@@ -202,6 +202,13 @@ EventDispatcher::EventDispatcher()
 : _inDispatch(0)
 , _isEnabled(false)
 , _nodePriorityIndex(0)
+, _touchHitIndexEnabled(false)
+, _touchHitIndexDirty(true)
+, _touchHitIndexStamp(0)
+, _touchHitIndexVersion(0)
+, _touchHitQuery(0)
+, _touchHitGridColumns(0)
+, _touchHitGridRows(0)
 {
     _toAddedListeners.reserve(50);
     
@@ -853,11 +860,22 @@ void EventDispatcher::dispatchTouchEvent(EventTouch* event)
     {
         auto mutableTouchesIter = mutableTouches.begin();
         auto touchesIter = originalTouches.begin();
+
+        auto sceneGraphPriorityListeners = oneByOneListeners->getSceneGraphPriorityListeners();
+        bool useHitIndex = _touchHitIndexEnabled && sceneGraphPriorityListeners
+            && event->getEventCode() == EventTouch::EventCode::BEGAN;
         
         for (; touchesIter != originalTouches.end(); ++touchesIter)
         {
             bool isSwallowed = false;
 
+            if (useHitIndex)
+            {
+                // a previous touch may have moved nodes
+                updateTouchHitIndex(sceneGraphPriorityListeners);
+                queryTouchHitIndex((*touchesIter)->getLocation());
+            }
+
             auto onTouchEvent = [&](EventListener* l) -> bool { // Return true to break
                 EventListenerTouchOneByOne* listener = static_cast<EventListenerTouchOneByOne*>(l);
                 
@@ -874,7 +892,7 @@ void EventDispatcher::dispatchTouchEvent(EventTouch* event)
                 
                 if (eventCode == EventTouch::EventCode::BEGAN)
                 {
-                    if (listener->onTouchBegan)
+                    if (listener->onTouchBegan && !(useHitIndex && isTouchHitIndexMiss(listener)))
                     {
                         isClaimed = listener->onTouchBegan(*touchesIter, event);
                         if (isClaimed && listener->_isRegistered)
@@ -1296,6 +1314,10 @@ void EventDispatcher::removeEventListenersForListenerID(const EventListener::Lis
         // Remove the dirty flag according the 'listenerID'.
         // No need to check whether the dispatcher is dispatching event.
         _priorityDirtyFlagMap.erase(listenerID);
+        if (listenerID == EventListenerTouchOneByOne::LISTENER_ID)
+        {
+            _touchHitIndexDirty = true;
+        }
         
         if (!_inDispatch)
         {
@@ -1407,8 +1429,153 @@ void EventDispatcher::setDirtyForNode(Node* node)
     }
 }
 
+void EventDispatcher::updateTouchHitIndex(std::vector<EventListener*>* listeners)
+{
+    uint64_t stamp = Node::getTransformStamp();
+    if (!_touchHitIndexDirty && stamp == _touchHitIndexStamp)
+        return;
+
+    _touchHitIndexDirty = false;
+    _touchHitIndexStamp = stamp;
+    if (++_touchHitIndexVersion == 0)
+    {
+        // 0 is for the listeners that aren't indexed
+        ++_touchHitIndexVersion;
+    }
+
+    for (auto& cell : _touchHitGridCells)
+    {
+        cell.clear();
+    }
+    _touchHitLargeListeners.clear();
+
+    // bounding boxes of the nodes that changed since they were computed
+    std::vector<EventListenerTouchOneByOne*> indexed;
+    indexed.reserve(listeners->size());
+    Rect gridBounds;
+    for (auto& l : *listeners)
+    {
+        auto listener = static_cast<EventListenerTouchOneByOne*>(l);
+        Node* node = listener->getAssociatedNode();
+        if (!listener->_hitTestByNodeBounds || !listener->isRegistered() || !node)
+            continue;
+
+        if (listener->_hitBoundsNode != node || node->isTransformChangedSince(listener->_hitBoundsStamp))
+        {
+            const Mat4& m = node->getNodeToWorldTransform();
+            // the nodes rotated out of the XY plane, or projected, are always called
+            listener->_hitBoundsValid = m.m[2] == 0 && m.m[6] == 0 && m.m[8] == 0 && m.m[9] == 0
+                && m.m[3] == 0 && m.m[7] == 0 && m.m[11] == 0 && m.m[15] == 1;
+            if (listener->_hitBoundsValid)
+            {
+                const Size& size = node->getContentSize();
+                Vec3 corners[4] = { Vec3(0, 0, 0), Vec3(size.width, 0, 0), Vec3(0, size.height, 0), Vec3(size.width, size.height, 0) };
+                float minX = FLT_MAX, minY = FLT_MAX, maxX = -FLT_MAX, maxY = -FLT_MAX;
+                for (auto& corner : corners)
+                {
+                    m.transformPoint(&corner);
+                    minX = std::min(minX, corner.x);
+                    minY = std::min(minY, corner.y);
+                    maxX = std::max(maxX, corner.x);
+                    maxY = std::max(maxY, corner.y);
+                }
+                // a point on the edge must be found despite the rounding
+                const float margin = 1.0f;
+                listener->_hitBounds.setRect(minX - margin, minY - margin, maxX - minX + 2 * margin, maxY - minY + 2 * margin);
+            }
+            listener->_hitBoundsNode = node;
+            listener->_hitBoundsStamp = stamp;
+        }
+
+        if (!listener->_hitBoundsValid)
+        {
+            listener->_hitIndexVersion = 0;
+            continue;
+        }
+
+        listener->_hitIndexVersion = _touchHitIndexVersion;
+        gridBounds = indexed.empty() ? listener->_hitBounds : gridBounds.unionWithRect(listener->_hitBounds);
+        indexed.push_back(listener);
+    }
+
+    // about one listener per cell
+    int size = std::max(1, std::min(32, (int)ceilf(sqrtf((float)indexed.size()))));
+    _touchHitGridBounds = gridBounds;
+    _touchHitGridColumns = size;
+    _touchHitGridRows = size;
+    _touchHitGridCells.resize(size * size);
+
+    float cellWidth = std::max(gridBounds.size.width / size, FLT_EPSILON);
+    float cellHeight = std::max(gridBounds.size.height / size, FLT_EPSILON);
+    for (auto listener : indexed)
+    {
+        const Rect& bounds = listener->_hitBounds;
+        int column0 = std::max(0, std::min(size - 1, (int)((bounds.getMinX() - gridBounds.getMinX()) / cellWidth)));
+        int column1 = std::max(0, std::min(size - 1, (int)((bounds.getMaxX() - gridBounds.getMinX()) / cellWidth)));
+        int row0 = std::max(0, std::min(size - 1, (int)((bounds.getMinY() - gridBounds.getMinY()) / cellHeight)));
+        int row1 = std::max(0, std::min(size - 1, (int)((bounds.getMaxY() - gridBounds.getMinY()) / cellHeight)));
+
+        if ((column1 - column0 + 1) * (row1 - row0 + 1) > 4)
+        {
+            _touchHitLargeListeners.push_back(listener);
+            continue;
+        }
+        for (int row = row0; row <= row1; ++row)
+        {
+            for (int column = column0; column <= column1; ++column)
+            {
+                _touchHitGridCells[row * size + column].push_back(listener);
+            }
+        }
+    }
+}
+
+void EventDispatcher::queryTouchHitIndex(const Vec2& location)
+{
+    if (++_touchHitQuery == 0)
+    {
+        ++_touchHitQuery;
+    }
+
+    for (auto listener : _touchHitLargeListeners)
+    {
+        if (listener->_hitBounds.containsPoint(location))
+        {
+            listener->_hitQuery = _touchHitQuery;
+        }
+    }
+
+    if (_touchHitGridCells.empty() || !_touchHitGridBounds.containsPoint(location))
+        return;
+
+    float cellWidth = std::max(_touchHitGridBounds.size.width / _touchHitGridColumns, FLT_EPSILON);
+    float cellHeight = std::max(_touchHitGridBounds.size.height / _touchHitGridRows, FLT_EPSILON);
+    int column = std::min(_touchHitGridColumns - 1, (int)((location.x - _touchHitGridBounds.getMinX()) / cellWidth));
+    int row = std::min(_touchHitGridRows - 1, (int)((location.y - _touchHitGridBounds.getMinY()) / cellHeight));
+    for (auto listener : _touchHitGridCells[row * _touchHitGridColumns + column])
+    {
+        if (listener->_hitBounds.containsPoint(location))
+        {
+            listener->_hitQuery = _touchHitQuery;
+        }
+    }
+}
+
+bool EventDispatcher::isTouchHitIndexMiss(EventListenerTouchOneByOne* listener) const
+{
+    return listener->_hitTestByNodeBounds
+        && listener->_hitIndexVersion == _touchHitIndexVersion
+        && listener->_hitQuery != _touchHitQuery;
+}
+
 void EventDispatcher::setDirty(const EventListener::ListenerID& listenerID, DirtyFlag flag)
 {    
+    // the touch hit index keeps pointers to the listeners, it is rebuilt after any change of them
+    if (listenerID == EventListenerTouchOneByOne::LISTENER_ID)
+    {
+        _touchHitIndexDirty = true;
+    }
+
     auto iter = _priorityDirtyFlagMap.find(listenerID);
     if (iter == _priorityDirtyFlagMap.end())
     {
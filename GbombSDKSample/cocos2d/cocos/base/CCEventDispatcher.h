@@ -35,6 +35,7 @@
 #include "base/CCEventListener.h"
 #include "base/CCEvent.h"
 #include "platform/CCStdC.h"
+#include "math/CCGeometry.h"
 
 NS_CC_BEGIN
 
@@ -43,6 +44,7 @@ class EventTouch;
 class Node;
 class EventCustom;
 class EventListenerCustom;
+class EventListenerTouchOneByOne;
 
 /**
 This class manages event listener subscriptions
@@ -122,6 +124,17 @@ public:
     /** Checks whether dispatching events is enabled */
     bool isEnabled() const;
 
+    /**
+     * Keeps the bounding boxes of the nodes of the EventListenerTouchOneByOne listeners that use
+     * EventListenerTouchOneByOne::setHitTestByNodeBounds() in a grid, so that a began touch only calls
+     * the onTouchBegan of those whose node is under the touch.
+     * The grid is rebuilt at the next began touch after a node moved, resized or changed its parent,
+     * only the bounding boxes of the nodes that moved are computed again.
+     * Disabled by default.
+     */
+    void setTouchHitIndexEnabled(bool enabled) { _touchHitIndexEnabled = enabled; }
+    bool isTouchHitIndexEnabled() const { return _touchHitIndexEnabled; }
+
     /////////////////////////////////////////////
     
     /** Dispatches the event
@@ -244,6 +257,15 @@ protected:
     
     /** Walks though scene graph to get the draw order for each node, it's called before sorting event listener with scene graph priority */
     void visitTarget(Node* node, bool isRootNode);
+
+    /** Rebuilds the touch hit index if a listener was added or removed, or a node changed */
+    void updateTouchHitIndex(std::vector<EventListener*>* listeners);
+
+    /** Marks the indexed listeners whose node bounds contain location */
+    void queryTouchHitIndex(const Vec2& location);
+
+    /** Whether listener is indexed, and not under the location of the last query */
+    bool isTouchHitIndexMiss(EventListenerTouchOneByOne* listener) const;
     
     /** Listeners map */
     std::unordered_map<EventListener::ListenerID, EventListenerVector*> _listenerMap;
@@ -275,6 +297,19 @@ protected:
     int _nodePriorityIndex;
     
     std::set<std::string> _internalCustomListenerIDs;
+
+    /** Touch hit index, a uniform grid over the bounds of the indexed listeners */
+    bool _touchHitIndexEnabled;
+    bool _touchHitIndexDirty;
+    uint64_t _touchHitIndexStamp;
+    unsigned int _touchHitIndexVersion;
+    unsigned int _touchHitQuery;
+    Rect _touchHitGridBounds;
+    int _touchHitGridColumns;
+    int _touchHitGridRows;
+    std::vector<std::vector<EventListenerTouchOneByOne*>> _touchHitGridCells;
+    /** Listeners covering too many cells, tested one by one */
+    std::vector<EventListenerTouchOneByOne*> _touchHitLargeListeners;
 };
 
 
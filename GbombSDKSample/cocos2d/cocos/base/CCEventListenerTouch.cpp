@@ -39,6 +39,12 @@ EventListenerTouchOneByOne::EventListenerTouchOneByOne()
 , onTouchEnded(nullptr)
 , onTouchCancelled(nullptr)
 , _needSwallow(false)
+, _hitTestByNodeBounds(false)
+, _hitBoundsValid(false)
+, _hitBoundsNode(nullptr)
+, _hitBoundsStamp(0)
+, _hitIndexVersion(0)
+, _hitQuery(0)
 {
 }
 
@@ -108,6 +114,7 @@ EventListenerTouchOneByOne* EventListenerTouchOneByOne::clone()
         
         ret->_claimedTouches = _claimedTouches;
         ret->_needSwallow = _needSwallow;
+        ret->_hitTestByNodeBounds = _hitTestByNodeBounds;
     }
     else
     {
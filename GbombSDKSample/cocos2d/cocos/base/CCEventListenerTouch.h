@@ -27,6 +27,7 @@
 #define __cocos2d_libs__CCTouchEventListener__
 
 #include "base/CCEventListener.h"
+#include "math/CCGeometry.h"
 
 #include <vector>
 
@@ -45,6 +46,14 @@ public:
     
     void setSwallowTouches(bool needSwallow);
     bool isSwallowTouches();
+
+    /**
+     * Tells that onTouchBegan only claims the touches inside the content size of the node of the listener.
+     * When the touch hit index of the EventDispatcher is enabled, onTouchBegan isn't called for the touches
+     * outside of the bounding box of the node.
+     */
+    void setHitTestByNodeBounds(bool enabled) { _hitTestByNodeBounds = enabled; }
+    bool isHitTestByNodeBounds() const { return _hitTestByNodeBounds; }
     
     /// Overrides
     virtual EventListenerTouchOneByOne* clone() override;
@@ -64,6 +73,15 @@ CC_CONSTRUCTOR_ACCESS:
 private:
     std::vector<Touch*> _claimedTouches;
     bool _needSwallow;
+
+    // touch hit index of the EventDispatcher
+    bool _hitTestByNodeBounds;
+    bool _hitBoundsValid;           // false when the node isn't in the XY plane of the world
+    Rect _hitBounds;                // bounding box of the node in world coordinates
+    Node* _hitBoundsNode;           // node of _hitBounds, weak reference
+    uint64_t _hitBoundsStamp;       // Node::getTransformStamp() when _hitBounds was computed
+    unsigned int _hitIndexVersion;  // version of the index containing the listener, 0 for none
+    unsigned int _hitQuery;         // last query of the index that found the listener
     
     friend class EventDispatcher;
 };
@@ -0,0 +1,237 @@
+/****************************************************************************
+Copyright (c) 2014 Chukong Technologies Inc.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+#include "base/CCFunctionQueue.h"
+
+#include <algorithm>
+
+NS_CC_BEGIN
+
+// index of the tasks allocated out of the pool, once MAX_BLOCKS are in use
+static const uint32_t UNPOOLED_TASK = 0xffffffff;
+
+FunctionQueue::FunctionQueue()
+: _head(&_stub)
+, _tail(&_stub)
+, _deferred(nullptr)
+, _freeHead(0)
+, _blockCount(0)
+, _depth(0)
+, _heapFunctions(0)
+{
+    _stub.next.store(nullptr, std::memory_order_relaxed);
+    resetStats();
+}
+
+FunctionQueue::~FunctionQueue()
+{
+    Task* task = _deferred ? _deferred : pop();
+    while (task)
+    {
+        task->destroy(task);
+        freeTask(task);
+        task = pop();
+    }
+
+    uint32_t blockCount = _blockCount.load(std::memory_order_relaxed);
+    for (uint32_t i = 0; i < blockCount; ++i)
+    {
+        delete [] _blocks[i];
+    }
+}
+
+void FunctionQueue::resetStats()
+{
+    _stats.performed = 0;
+    _stats.heapFunctions = 0;
+    _stats.budgetOverruns = 0;
+    _stats.peakDepth = 0;
+    _stats.totalLatency = 0;
+    _stats.maxLatency = 0;
+    _heapFunctions.store(0, std::memory_order_relaxed);
+}
+
+// MARK: task pool
+
+void FunctionQueue::allocateBlock()
+{
+    std::lock_guard<std::mutex> lock(_blockMutex);
+
+    // another thread may have filled the pool while this one waited
+    if ((_freeHead.load(std::memory_order_acquire) & 0xffffffff) != 0)
+        return;
+
+    uint32_t blockIndex = _blockCount.load(std::memory_order_relaxed);
+    if (blockIndex == MAX_BLOCKS)
+        return;
+
+    Task* block = new (std::nothrow) Task[BLOCK_SIZE];
+    if (!block)
+        return;
+
+    _blocks[blockIndex] = block;
+    _blockCount.store(blockIndex + 1, std::memory_order_release);
+    for (uint32_t i = 0; i < BLOCK_SIZE; ++i)
+    {
+        block[i].index = blockIndex * BLOCK_SIZE + i;
+        freeTask(&block[i]);
+    }
+}
+
+FunctionQueue::Task* FunctionQueue::allocateTask()
+{
+    uint64_t head = _freeHead.load(std::memory_order_acquire);
+    for (;;)
+    {
+        uint32_t index = (uint32_t)(head & 0xffffffff);
+        if (index == 0)
+        {
+            allocateBlock();
+            head = _freeHead.load(std::memory_order_acquire);
+            if ((head & 0xffffffff) == 0)
+            {
+                Task* task = new Task;
+                task->index = UNPOOLED_TASK;
+                return task;
+            }
+            continue;
+        }
+
+        Task* task = taskAt(index - 1);
+        // the tag makes the exchange fail if the task was taken and freed again meanwhile
+        uint64_t next = ((head >> 32) + 1) << 32 | task->nextFree.load(std::memory_order_relaxed);
+        if (_freeHead.compare_exchange_weak(head, next, std::memory_order_acquire, std::memory_order_acquire))
+            return task;
+    }
+}
+
+void FunctionQueue::freeTask(Task* task)
+{
+    if (task->index == UNPOOLED_TASK)
+    {
+        delete task;
+        return;
+    }
+
+    uint64_t head = _freeHead.load(std::memory_order_relaxed);
+    uint64_t next;
+    do
+    {
+        task->nextFree.store((uint32_t)(head & 0xffffffff), std::memory_order_relaxed);
+        next = ((head >> 32) + 1) << 32 | (task->index + 1);
+    } while (!_freeHead.compare_exchange_weak(head, next, std::memory_order_release, std::memory_order_relaxed));
+}
+
+// MARK: queue
+
+void FunctionQueue::push(Task* task)
+{
+    task->postTime = Clock::now();
+    task->next.store(nullptr, std::memory_order_relaxed);
+    _depth.fetch_add(1, std::memory_order_relaxed);
+
+    Task* prev = _head.exchange(task, std::memory_order_acq_rel);
+    // the consumer waits for this link, a producer preempted here delays the tasks behind its own
+    prev->next.store(task, std::memory_order_release);
+}
+
+FunctionQueue::Task* FunctionQueue::pop()
+{
+    Task* tail = _tail;
+    Task* next = tail->next.load(std::memory_order_acquire);
+    if (tail == &_stub)
+    {
+        if (!next)
+            return nullptr;
+        _tail = next;
+        tail = next;
+        next = next->next.load(std::memory_order_acquire);
+    }
+    if (next)
+    {
+        _tail = next;
+        return tail;
+    }
+
+    // tail is the last task, unless a producer is linking a new one
+    if (tail != _head.load(std::memory_order_acquire))
+        return nullptr;
+
+    push(&_stub);
+    _depth.fetch_sub(1, std::memory_order_relaxed);
+    next = tail->next.load(std::memory_order_acquire);
+    if (next)
+    {
+        _tail = next;
+        return tail;
+    }
+    return nullptr;
+}
+
+unsigned int FunctionQueue::run(float budget)
+{
+    Task* task = _deferred ? _deferred : pop();
+    _deferred = nullptr;
+    if (!task)
+        return 0;
+
+    auto start = Clock::now();
+    auto deadline = start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<float>(budget));
+    _stats.peakDepth = std::max(_stats.peakDepth, _depth.load(std::memory_order_relaxed));
+
+    unsigned int count = 0;
+    while (task)
+    {
+        if (task->postTime > start)
+        {
+            // posted while running, wait for the next call
+            _deferred = task;
+            break;
+        }
+
+        double latency = std::chrono::duration<double>(start - task->postTime).count();
+        _stats.totalLatency += latency;
+        _stats.maxLatency = std::max(_stats.maxLatency, latency);
+
+        _depth.fetch_sub(1, std::memory_order_relaxed);
+        task->invoke(task);
+        task->destroy(task);
+        freeTask(task);
+        ++count;
+
+        task = pop();
+        if (task && budget > 0 && Clock::now() >= deadline)
+        {
+            _deferred = task;
+            ++_stats.budgetOverruns;
+            break;
+        }
+    }
+
+    _stats.performed += count;
+    _stats.heapFunctions = _heapFunctions.load(std::memory_order_relaxed);
+    return count;
+}
+
+NS_CC_END
@@ -0,0 +1,176 @@
+/****************************************************************************
+Copyright (c) 2014 Chukong Technologies Inc.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+#ifndef __CCFUNCTIONQUEUE_H__
+#define __CCFUNCTIONQUEUE_H__
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "base/ccMacros.h"
+
+NS_CC_BEGIN
+
+/**
+ * @addtogroup global
+ * @{
+ */
+
+/** @brief Queue of functions posted by any thread and run by a single consumer thread.
+
+ Posting doesn't take a lock, except when the task pool grows. The functions are kept in pooled tasks, and
+ callables up to TASK_STORAGE_SIZE bytes, like lambdas capturing a few values or a std::function, are stored
+ inline, so a post doesn't allocate once the pool is warm. Functions run in the order they were posted.
+ The consumer can limit the time spent per call of run(), the rest waits for the next call.
+ */
+class CC_DLL FunctionQueue
+{
+public:
+    /** Callables up to this size are stored in the task without an allocation */
+    static const size_t TASK_STORAGE_SIZE = 64;
+
+    struct Stats
+    {
+        unsigned int performed;         ///< functions run
+        unsigned int heapFunctions;     ///< functions too big to be stored inline
+        unsigned int budgetOverruns;    ///< calls of run() that left functions for the next call because of the time budget
+        unsigned int peakDepth;         ///< most functions waiting at once
+        double totalLatency;            ///< seconds between post and run, summed
+        double maxLatency;              ///< seconds
+    };
+
+    FunctionQueue();
+    /** Functions that were not run are destroyed */
+    ~FunctionQueue();
+
+private:
+    typedef std::chrono::steady_clock Clock;
+    typedef std::aligned_storage<TASK_STORAGE_SIZE>::type Storage;
+
+public:
+    /** Posts a function, callable from any thread */
+    template <typename F>
+    void post(F&& function)
+    {
+        typedef typename std::decay<F>::type Callable;
+        Task* task = allocateTask();
+        constructCallable<Callable>(task, std::forward<F>(function),
+            std::integral_constant<bool, (sizeof(Callable) <= sizeof(Storage) && alignof(Callable) <= alignof(Storage))>());
+        push(task);
+    }
+
+    /**
+     * Runs the functions posted before the call, from the consumer thread.
+     * Functions posted while they run, by them or by other threads, wait for the next call.
+     *
+     * @param budget Seconds after which the remaining functions wait for the next call, 0 for no limit. At least one function runs.
+     * @return The number of functions run.
+     */
+    unsigned int run(float budget = 0);
+
+    /** Number of functions waiting, approximate while other threads post */
+    unsigned int getDepth() const { return _depth.load(std::memory_order_relaxed); }
+
+    /** Stats since the last reset, read them from the consumer thread */
+    const Stats& getStats() const { return _stats; }
+    void resetStats();
+
+private:
+    struct Task
+    {
+        std::atomic<Task*> next;
+        std::atomic<uint32_t> nextFree;  // index + 1 of the next free task, 0 for none
+        uint32_t index;
+        void (*invoke)(Task*);
+        void (*destroy)(Task*);
+        Clock::time_point postTime;
+        Storage storage;
+    };
+
+    template <typename Callable>
+    static void invokeInline(Task* task) { (*reinterpret_cast<Callable*>(&task->storage))(); }
+    template <typename Callable>
+    static void destroyInline(Task* task) { reinterpret_cast<Callable*>(&task->storage)->~Callable(); }
+    template <typename Callable>
+    static void invokeHeap(Task* task) { (**reinterpret_cast<Callable**>(&task->storage))(); }
+    template <typename Callable>
+    static void destroyHeap(Task* task) { delete *reinterpret_cast<Callable**>(&task->storage); }
+
+    template <typename Callable, typename F>
+    void constructCallable(Task* task, F&& function, std::true_type /*inline*/)
+    {
+        new (&task->storage) Callable(std::forward<F>(function));
+        task->invoke = &invokeInline<Callable>;
+        task->destroy = &destroyInline<Callable>;
+    }
+
+    template <typename Callable, typename F>
+    void constructCallable(Task* task, F&& function, std::false_type /*inline*/)
+    {
+        *reinterpret_cast<Callable**>(&task->storage) = new Callable(std::forward<F>(function));
+        task->invoke = &invokeHeap<Callable>;
+        task->destroy = &destroyHeap<Callable>;
+        _heapFunctions.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    Task* allocateTask();
+    void freeTask(Task* task);
+    void allocateBlock();
+    Task* taskAt(uint32_t index) const { return _blocks[index / BLOCK_SIZE] + index % BLOCK_SIZE; }
+
+    void push(Task* task);
+    Task* pop();
+
+    static const uint32_t BLOCK_SIZE = 256;
+    static const uint32_t MAX_BLOCKS = 1024;
+
+    // intrusive MPSC queue: producers exchange _head, the consumer owns _tail
+    std::atomic<Task*> _head;
+    Task* _tail;
+    Task _stub;
+    // popped but left for the next run()
+    Task* _deferred;
+
+    // free tasks, a stack of indices tagged with a counter against ABA
+    std::atomic<uint64_t> _freeHead;
+    Task* _blocks[MAX_BLOCKS];
+    std::atomic<uint32_t> _blockCount;
+    std::mutex _blockMutex;
+
+    std::atomic<unsigned int> _depth;
+    std::atomic<unsigned int> _heapFunctions;
+    Stats _stats;
+};
+
+// end of global group
+/// @}
+
+NS_CC_END
+
+#endif // __CCFUNCTIONQUEUE_H__
@@ -0,0 +1,318 @@
+/****************************************************************************
+Copyright (c) 2014 Chukong Technologies Inc.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+#include "base/CCJobSystem.h"
+
+#include <algorithm>
+
+#include "base/CCDirector.h"
+#include "base/CCScheduler.h"
+
+NS_CC_BEGIN
+
+struct JobSystem::Job
+{
+    std::function<void()> function;
+    JobHandle parent;
+    std::atomic<int> unfinished;    // the job itself and its unfinished children
+    std::atomic<int> blockers;      // unfinished dependencies, and one until run() is called
+    std::atomic<bool> finished;
+
+    // guards the members below, they are handled when the job finishes
+    std::mutex mutex;
+    std::vector<JobHandle> dependents;
+    std::vector<std::function<void()>> continuations;
+};
+
+JobSystem::JobSystem(unsigned int workerCount)
+: _sharedQueue(std::max(workerCount, 1u))
+, _queuedJobs(0)
+, _sleepingWorkers(0)
+, _stop(false)
+{
+    _queues.reset(new WorkQueue[_sharedQueue + 1]);
+
+    _workers.reserve(_sharedQueue);
+    _workerIds.reserve(_sharedQueue);
+    for (unsigned int i = 0; i < _sharedQueue; ++i)
+    {
+        _workers.push_back(std::thread(&JobSystem::workerLoop, this, i));
+        _workerIds.push_back(_workers.back().get_id());
+    }
+}
+
+JobSystem::~JobSystem()
+{
+    {
+        std::lock_guard<std::mutex> lock(_sleepMutex);
+        _stop = true;
+    }
+    _wakeUp.notify_all();
+
+    for (auto& worker : _workers)
+    {
+        worker.join();
+    }
+}
+
+JobSystem::JobHandle JobSystem::createJob(const std::function<void()>& function, const JobHandle& parent)
+{
+    JobHandle job = std::make_shared<Job>();
+    job->function = function;
+    job->unfinished.store(1, std::memory_order_relaxed);
+    job->blockers.store(1, std::memory_order_relaxed);
+    job->finished.store(false, std::memory_order_relaxed);
+
+    if (parent)
+    {
+        CCASSERT(!parent->finished.load(std::memory_order_relaxed), "The parent is already finished");
+        parent->unfinished.fetch_add(1, std::memory_order_relaxed);
+        job->parent = parent;
+    }
+    return job;
+}
+
+void JobSystem::addDependency(const JobHandle& job, const JobHandle& dependency)
+{
+    CCASSERT(job != dependency, "A job can't depend on itself");
+
+    std::lock_guard<std::mutex> lock(dependency->mutex);
+    if (dependency->finished.load(std::memory_order_acquire))
+        return;
+
+    job->blockers.fetch_add(1, std::memory_order_relaxed);
+    dependency->dependents.push_back(job);
+}
+
+void JobSystem::addCocosThreadContinuation(const JobHandle& job, const std::function<void()>& function)
+{
+    {
+        std::lock_guard<std::mutex> lock(job->mutex);
+        if (!job->finished.load(std::memory_order_acquire))
+        {
+            job->continuations.push_back(function);
+            return;
+        }
+    }
+    Director::getInstance()->getScheduler()->performFunctionInCocosThread(function);
+}
+
+void JobSystem::run(const JobHandle& job)
+{
+    // drops the token taken by createJob(), the last finished dependency queues it otherwise
+    if (job->blockers.fetch_sub(1, std::memory_order_acq_rel) == 1)
+    {
+        enqueue(job);
+    }
+}
+
+void JobSystem::wait(const JobHandle& job)
+{
+    unsigned int index = getQueueIndex();
+    while (!job->finished.load(std::memory_order_acquire))
+    {
+        JobHandle other = findJob(index);
+        if (other)
+        {
+            execute(other);
+        }
+        else
+        {
+            std::this_thread::yield();
+        }
+    }
+}
+
+bool JobSystem::isFinished(const JobHandle& job) const
+{
+    return job->finished.load(std::memory_order_acquire);
+}
+
+void JobSystem::parallelFor(size_t count, size_t grainSize, const std::function<void(size_t begin, size_t end)>& function)
+{
+    if (count == 0)
+        return;
+
+    if (grainSize == 0)
+    {
+        // a few ranges per thread, so that the threads finishing early can take some from the others
+        grainSize = std::max<size_t>(1, count / ((_workers.size() + 1) * 4));
+    }
+    if (count <= grainSize)
+    {
+        function(0, count);
+        return;
+    }
+
+    JobHandle group = createJob(nullptr);
+    for (size_t begin = 0; begin < count; begin += grainSize)
+    {
+        size_t end = std::min(begin + grainSize, count);
+        run(createJob([&function, begin, end]() { function(begin, end); }, group));
+    }
+    run(group);
+    wait(group);
+}
+
+// MARK: workers
+
+unsigned int JobSystem::getQueueIndex() const
+{
+    std::thread::id id = std::this_thread::get_id();
+    for (unsigned int i = 0; i < _workerIds.size(); ++i)
+    {
+        if (_workerIds[i] == id)
+            return i;
+    }
+    return _sharedQueue;
+}
+
+void JobSystem::enqueue(const JobHandle& job)
+{
+    WorkQueue& queue = _queues[getQueueIndex()];
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.jobs.push_back(job);
+    }
+    _queuedJobs.fetch_add(1);
+
+    // pairs with the check of _queuedJobs after _sleepingWorkers is raised in workerLoop()
+    if (_sleepingWorkers.load() > 0)
+    {
+        std::lock_guard<std::mutex> lock(_sleepMutex);
+        _wakeUp.notify_one();
+    }
+}
+
+JobSystem::JobHandle JobSystem::findJob(unsigned int index)
+{
+    JobHandle job;
+    if (_queuedJobs.load(std::memory_order_relaxed) == 0)
+        return job;
+
+    // newest of its own jobs first, their data is likely still in the cache
+    if (index != _sharedQueue)
+    {
+        WorkQueue& queue = _queues[index];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (!queue.jobs.empty())
+        {
+            job = std::move(queue.jobs.back());
+            queue.jobs.pop_back();
+        }
+    }
+
+    // then the oldest jobs of the shared queue and of the other workers
+    unsigned int queueCount = _sharedQueue + 1;
+    for (unsigned int i = 0; !job && i < queueCount; ++i)
+    {
+        WorkQueue& queue = _queues[(_sharedQueue + i) % queueCount];
+        if (&queue == &_queues[index] && index != _sharedQueue)
+            continue;
+
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (!queue.jobs.empty())
+        {
+            job = std::move(queue.jobs.front());
+            queue.jobs.pop_front();
+        }
+    }
+
+    if (job)
+    {
+        _queuedJobs.fetch_sub(1, std::memory_order_relaxed);
+    }
+    return job;
+}
+
+void JobSystem::workerLoop(unsigned int index)
+{
+    for (;;)
+    {
+        JobHandle job = findJob(index);
+        if (job)
+        {
+            execute(job);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(_sleepMutex);
+        _sleepingWorkers.fetch_add(1);
+        _wakeUp.wait(lock, [this]() { return _stop || _queuedJobs.load() > 0; });
+        _sleepingWorkers.fetch_sub(1);
+        if (_stop)
+            break;
+    }
+}
+
+void JobSystem::execute(const JobHandle& job)
+{
+    if (job->function)
+    {
+        job->function();
+        // frees what the function captured
+        job->function = nullptr;
+    }
+    finish(job);
+}
+
+void JobSystem::finish(const JobHandle& job)
+{
+    if (job->unfinished.fetch_sub(1, std::memory_order_acq_rel) != 1)
+        return;
+
+    std::vector<JobHandle> dependents;
+    std::vector<std::function<void()>> continuations;
+    {
+        std::lock_guard<std::mutex> lock(job->mutex);
+        dependents.swap(job->dependents);
+        continuations.swap(job->continuations);
+        job->finished.store(true, std::memory_order_release);
+    }
+
+    for (auto& dependent : dependents)
+    {
+        if (dependent->blockers.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        {
+            enqueue(dependent);
+        }
+    }
+
+    if (!continuations.empty())
+    {
+        Scheduler* scheduler = Director::getInstance()->getScheduler();
+        for (auto& continuation : continuations)
+        {
+            scheduler->performFunctionInCocosThread(std::move(continuation));
+        }
+    }
+
+    if (job->parent)
+    {
+        JobHandle parent = std::move(job->parent);
+        finish(parent);
+    }
+}
+
+NS_CC_END
@@ -0,0 +1,153 @@
+/****************************************************************************
+Copyright (c) 2014 Chukong Technologies Inc.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+#ifndef __CCJOBSYSTEM_H__
+#define __CCJOBSYSTEM_H__
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "base/ccMacros.h"
+
+NS_CC_BEGIN
+
+/**
+ * @addtogroup global
+ * @{
+ */
+
+/** @brief Pool of worker threads running jobs, shared by the engine and the game.
+
+ Each worker has its own queue. It runs the newest of its own jobs first and, when it has none,
+ takes the oldest jobs of the other queues. Jobs run by other threads, like the cocos2d thread,
+ go to a shared queue.
+
+ A job can have a parent, which isn't finished until all its children are, and dependencies,
+ jobs that must finish before it starts. Functions can be attached to run in the cocos2d thread,
+ through the Scheduler, once a job is finished.
+
+ ```
+ auto jobs = Director::getInstance()->getJobSystem();
+ auto load = jobs->createJob([=]() { decode(data); });
+ auto build = jobs->createJob([=]() { buildMesh(data); });
+ jobs->addDependency(build, load);
+ jobs->addCocosThreadContinuation(build, [=]() { sprite->setVisible(true); });
+ jobs->run(load);
+ jobs->run(build);
+ ```
+
+ Jobs must not call the cocos2d API, use a continuation for that.
+ */
+class CC_DLL JobSystem
+{
+public:
+    struct Job;
+    typedef std::shared_ptr<Job> JobHandle;
+
+    /** Starts the workers, at least one */
+    explicit JobSystem(unsigned int workerCount);
+    /** Waits for the running jobs, the jobs that didn't start are dropped */
+    ~JobSystem();
+
+    /**
+     * Creates a job, it doesn't run until run() is called.
+     *
+     * @param function Runs in a worker, or in a thread waiting for a job. Can be null, for a job only grouping its children.
+     * @param parent Isn't finished until this job is. The child must be created before the parent finishes,
+     *               from the parent's function or before the parent is run.
+     */
+    JobHandle createJob(const std::function<void()>& function, const JobHandle& parent = nullptr);
+
+    /** Makes job wait for dependency to finish before it starts. Call it before run(job). */
+    void addDependency(const JobHandle& job, const JobHandle& dependency);
+
+    /** Performs function in the cocos2d thread once job is finished, right away if it is already */
+    void addCocosThreadContinuation(const JobHandle& job, const std::function<void()>& function);
+
+    /** Queues a job, it starts once its dependencies are finished. A job can be run only once. */
+    void run(const JobHandle& job);
+
+    /** Creates and queues a job */
+    JobHandle run(const std::function<void()>& function) { JobHandle job = createJob(function); run(job); return job; }
+
+    /** Runs other jobs until job and its children are finished */
+    void wait(const JobHandle& job);
+
+    bool isFinished(const JobHandle& job) const;
+
+    /**
+     * Calls function for ranges of [0, count) in parallel, and returns when all of them are done.
+     * The calling thread takes part in the work.
+     *
+     * @param grainSize Size of the ranges, 0 to split the work in a few ranges per thread.
+     */
+    void parallelFor(size_t count, size_t grainSize, const std::function<void(size_t begin, size_t end)>& function);
+
+    unsigned int getWorkerCount() const { return (unsigned int)_workers.size(); }
+
+    /** Whether the calling thread is one of the workers */
+    bool isWorkerThread() const { return getQueueIndex() != _sharedQueue; }
+
+    /** Index of the calling worker, from 0 to getWorkerCount() - 1, or getWorkerCount() for any other thread */
+    unsigned int getThreadIndex() const { return getQueueIndex(); }
+
+private:
+    struct WorkQueue
+    {
+        std::mutex mutex;
+        std::deque<JobHandle> jobs;
+    };
+
+    void workerLoop(unsigned int index);
+    unsigned int getQueueIndex() const;
+    void enqueue(const JobHandle& job);
+    JobHandle findJob(unsigned int index);
+    void execute(const JobHandle& job);
+    void finish(const JobHandle& job);
+
+    std::vector<std::thread> _workers;
+    std::vector<std::thread::id> _workerIds;
+    // one per worker, and the shared queue last
+    std::unique_ptr<WorkQueue[]> _queues;
+    unsigned int _sharedQueue;
+
+    std::atomic<unsigned int> _queuedJobs;
+    std::atomic<unsigned int> _sleepingWorkers;
+    std::mutex _sleepMutex;
+    std::condition_variable _wakeUp;
+    bool _stop;
+};
+
+// end of global group
+/// @}
+
+NS_CC_END
+
+#endif // __CCJOBSYSTEM_H__
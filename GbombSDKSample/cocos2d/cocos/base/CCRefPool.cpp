@@ -0,0 +1,245 @@
+/****************************************************************************
+Copyright (c) 2014 Chukong Technologies Inc.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+#include "base/CCRefPool.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <vector>
+
+NS_CC_BEGIN
+
+// the objects are aligned like the memory returned by malloc
+static const size_t SLOT_ALIGNMENT = 16;
+
+static size_t alignSize(size_t size)
+{
+    return (size + SLOT_ALIGNMENT - 1) & ~(SLOT_ALIGNMENT - 1);
+}
+
+static std::mutex& getPoolsMutex()
+{
+    static std::mutex mutex;
+    return mutex;
+}
+
+static RefPool* s_firstPool = nullptr;
+static RefPool* s_lastPool = nullptr;
+
+RefPool::RefPool(const char* name, size_t objectSize, unsigned int objectsPerChunk)
+: _name(name)
+, _objectSize(objectSize)
+, _slotSize(alignSize(std::max(objectSize, sizeof(FreeObject))))
+, _objectsPerChunk(std::max(objectsPerChunk, 1u))
+, _freeList(nullptr)
+, _chunks(nullptr)
+, _nextPool(nullptr)
+{
+    _lock.clear();
+    _stats.allocations = 0;
+    _stats.heapAllocations = 0;
+    _stats.liveObjects = 0;
+    _stats.peakObjects = 0;
+    _stats.chunks = 0;
+
+    std::lock_guard<std::mutex> lock(getPoolsMutex());
+    if (s_lastPool)
+    {
+        s_lastPool->_nextPool = this;
+    }
+    else
+    {
+        s_firstPool = this;
+    }
+    s_lastPool = this;
+}
+
+void RefPool::allocateChunk()
+{
+    size_t headerSize = alignSize(sizeof(Chunk));
+    Chunk* chunk = (Chunk*)malloc(headerSize + _slotSize * _objectsPerChunk);
+    if (!chunk)
+        return;
+
+    chunk->next = _chunks;
+    _chunks = chunk;
+    ++_stats.chunks;
+
+    // the first object of the chunk is allocated first
+    char* slots = (char*)chunk + headerSize;
+    for (unsigned int i = _objectsPerChunk; i > 0; --i)
+    {
+        FreeObject* object = (FreeObject*)(slots + _slotSize * (i - 1));
+        object->next = _freeList;
+        _freeList = object;
+    }
+}
+
+void* RefPool::allocate(size_t size)
+{
+    if (size != _objectSize)
+    {
+        lock();
+        ++_stats.heapAllocations;
+        unlock();
+        return ::operator new(size, std::nothrow);
+    }
+
+    lock();
+    if (!_freeList)
+    {
+        allocateChunk();
+    }
+    FreeObject* object = _freeList;
+    if (object)
+    {
+        _freeList = object->next;
+        ++_stats.allocations;
+        _stats.peakObjects = std::max(_stats.peakObjects, ++_stats.liveObjects);
+    }
+    unlock();
+    return object;
+}
+
+void RefPool::deallocate(void* ptr, size_t size)
+{
+    if (!ptr)
+        return;
+
+    if (size != _objectSize)
+    {
+        ::operator delete(ptr);
+        return;
+    }
+
+    FreeObject* object = (FreeObject*)ptr;
+    lock();
+    object->next = _freeList;
+    _freeList = object;
+    --_stats.liveObjects;
+    unlock();
+}
+
+void RefPool::purge()
+{
+    lock();
+
+    std::vector<FreeObject*> freeObjects;
+    for (FreeObject* object = _freeList; object; object = object->next)
+    {
+        freeObjects.push_back(object);
+    }
+    std::sort(freeObjects.begin(), freeObjects.end());
+
+    size_t headerSize = alignSize(sizeof(Chunk));
+    size_t chunkSize = _slotSize * _objectsPerChunk;
+    Chunk** link = &_chunks;
+    while (*link)
+    {
+        Chunk* chunk = *link;
+        char* slots = (char*)chunk + headerSize;
+        auto first = std::lower_bound(freeObjects.begin(), freeObjects.end(), (FreeObject*)slots);
+        auto last = std::lower_bound(first, freeObjects.end(), (FreeObject*)(slots + chunkSize));
+        if (last - first == (ptrdiff_t)_objectsPerChunk)
+        {
+            // all its objects are free, they leave the free list with it
+            freeObjects.erase(first, last);
+            *link = chunk->next;
+            free(chunk);
+            --_stats.chunks;
+        }
+        else
+        {
+            link = &chunk->next;
+        }
+    }
+
+    // rebuilt in address order, so the objects allocated next are close to each other
+    _freeList = nullptr;
+    for (auto it = freeObjects.rbegin(); it != freeObjects.rend(); ++it)
+    {
+        (*it)->next = _freeList;
+        _freeList = *it;
+    }
+
+    unlock();
+}
+
+RefPool::Stats RefPool::getStats()
+{
+    lock();
+    Stats stats = _stats;
+    unlock();
+    return stats;
+}
+
+void RefPool::purgeAll()
+{
+    std::lock_guard<std::mutex> lock(getPoolsMutex());
+    for (RefPool* pool = s_firstPool; pool; pool = pool->_nextPool)
+    {
+        pool->purge();
+    }
+}
+
+std::string RefPool::getStatsInfo()
+{
+    std::string buffer;
+    char buftmp[512];
+
+    unsigned int count = 0;
+    unsigned int totalObjects = 0;
+    size_t totalBytes = 0;
+
+    std::lock_guard<std::mutex> lock(getPoolsMutex());
+    for (RefPool* pool = s_firstPool; pool; pool = pool->_nextPool)
+    {
+        Stats stats = pool->getStats();
+        size_t bytes = stats.chunks * (alignSize(sizeof(Chunk)) + pool->_slotSize * pool->_objectsPerChunk);
+        totalBytes += bytes;
+        totalObjects += stats.liveObjects;
+        count++;
+        snprintf(buftmp, sizeof(buftmp) - 1, "\"%s\" size=%lu live=%u peak=%u allocations=%u heap=%u chunks=%u => %lu KB\n",
+                 pool->_name,
+                 (unsigned long)pool->_objectSize,
+                 stats.liveObjects,
+                 stats.peakObjects,
+                 stats.allocations,
+                 stats.heapAllocations,
+                 stats.chunks,
+                 (unsigned long)bytes / 1024);
+
+        buffer += buftmp;
+    }
+
+    snprintf(buftmp, sizeof(buftmp) - 1, "RefPool: %u pools, %u live objects, %lu KB\n",
+             count, totalObjects, (unsigned long)totalBytes / 1024);
+    buffer += buftmp;
+
+    return buffer;
+}
+
+NS_CC_END
@@ -0,0 +1,164 @@
+/****************************************************************************
+Copyright (c) 2014 Chukong Technologies Inc.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+#ifndef __BASE_CCREFPOOL_H__
+#define __BASE_CCREFPOOL_H__
+
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <string>
+
+#include "platform/CCPlatformMacros.h"
+#include "base/ccConfig.h"
+
+NS_CC_BEGIN
+
+/**
+ * @addtogroup base_nodes
+ * @{
+ */
+
+/** @brief Recycles the memory of the objects of one class.
+
+ The memory comes from chunks of objects, the freed objects are kept in a free list and reused by
+ the next allocation, so creating and releasing many objects of the class doesn't go to the heap.
+ Subclasses bigger than the class are allocated from the heap, unless they declare their own pool.
+
+ No engine class uses a pool, the game picks the classes it churns and declares CC_REF_POOL() in
+ their definition:
+
+ ```
+ class Bullet : public Sprite
+ {
+     CC_REF_POOL(Bullet);
+ public:
+     ...
+ };
+ ```
+
+ The pools are never destroyed, as objects may be released during the static destruction.
+ */
+class CC_DLL RefPool
+{
+public:
+    /** Counters, since the pool was created */
+    struct Stats
+    {
+        unsigned int allocations;       ///< objects allocated from the pool
+        unsigned int heapAllocations;   ///< objects of bigger subclasses, allocated from the heap
+        unsigned int liveObjects;
+        unsigned int peakObjects;
+        unsigned int chunks;
+    };
+
+    /**
+     * @param name Printed by getStatsInfo().
+     * @param objectSize Size of the objects allocated from the pool.
+     * @param objectsPerChunk Objects allocated at once when the free list is empty.
+     */
+    RefPool(const char* name, size_t objectSize, unsigned int objectsPerChunk = 64);
+
+    /** Returns nullptr if the memory can't be allocated */
+    void* allocate(size_t size);
+    /** Same as allocate(), but fails like the throwing operator new: throws std::bad_alloc, or aborts when exceptions are disabled */
+    void* allocateOrThrow(size_t size)
+    {
+        void* ptr = allocate(size);
+        if (!ptr)
+        {
+#if defined(__EXCEPTIONS) || defined(__cpp_exceptions) || defined(_CPPUNWIND)
+            throw std::bad_alloc();
+#else
+            abort();
+#endif
+        }
+        return ptr;
+    }
+    void deallocate(void* ptr, size_t size);
+
+    /** Frees the chunks whose objects are all free */
+    void purge();
+
+    const char* getName() const { return _name; }
+    size_t getObjectSize() const { return _objectSize; }
+    Stats getStats();
+
+    /** Purges all the pools */
+    static void purgeAll();
+    /** Returns the counters of all the pools, one line per pool */
+    static std::string getStatsInfo();
+
+private:
+    struct FreeObject
+    {
+        FreeObject* next;
+    };
+    struct Chunk
+    {
+        Chunk* next;
+    };
+
+    void allocateChunk();
+    void lock() { while (_lock.test_and_set(std::memory_order_acquire)) {} }
+    void unlock() { _lock.clear(std::memory_order_release); }
+
+    const char* _name;
+    size_t _objectSize;
+    size_t _slotSize;
+    unsigned int _objectsPerChunk;
+
+    std::atomic_flag _lock;
+    FreeObject* _freeList;
+    Chunk* _chunks;
+    Stats _stats;
+
+    // all the pools, in creation order
+    RefPool* _nextPool;
+};
+
+#if CC_ENABLE_REF_POOL
+/** Allocates the objects of TYPE, and of its subclasses of the same size, from a RefPool */
+#define CC_REF_POOL(TYPE) \
+public: \
+    static cocos2d::RefPool& getRefPool() \
+    { \
+        static cocos2d::RefPool* pool = new cocos2d::RefPool(#TYPE, sizeof(TYPE)); \
+        return *pool; \
+    } \
+    static void* operator new(size_t size) { return getRefPool().allocateOrThrow(size); } \
+    static void* operator new(size_t size, const std::nothrow_t&) throw() { return getRefPool().allocate(size); } \
+    static void operator delete(void* ptr, size_t size) { getRefPool().deallocate(ptr, size); } \
+private:
+#else
+#define CC_REF_POOL(TYPE)
+#endif
+
+// end of base_nodes group
+/// @}
+
+NS_CC_END
+
+#endif // __BASE_CCREFPOOL_H__
@@ -26,6 +26,10 @@ THE SOFTWARE.
 ****************************************************************************/
 
 #include "base/CCScheduler.h"
+
+#include <cfloat>
+#include <cmath>
+
 #include "base/ccMacros.h"
 #include "base/CCDirector.h"
 #include "base/utlist.h"
@@ -79,6 +83,8 @@ Timer::Timer()
 , _repeat(0)
 , _delay(0.0f)
 , _interval(0.0f)
+, _queueIndex(-1)
+, _lastUpdateTime(0)
 {
 }
 
@@ -258,9 +264,10 @@ Scheduler::Scheduler(void)
 #if CC_ENABLE_SCRIPT_BINDING
 , _scriptHandlerEntries(20)
 #endif
+, _time(0)
+, _timerQueueEnabled(false)
+, _performFunctionBudget(0)
 {
-    // I don't expect to have more than 30 functions to all per frame
-    _functionsToPerform.reserve(30);
 }
 
 Scheduler::~Scheduler(void)
@@ -317,6 +324,11 @@ void Scheduler::schedule(const ccSchedulerFunc& callback, void *target, float in
             {
                 CCLOG("CCScheduler#scheduleSelector. Selector already scheduled. Updating interval from: %.4f to %.4f", timer->getInterval(), interval);
                 timer->setInterval(interval);
+                if (timer->_queueIndex >= 0)
+                {
+                    dequeueTimer(timer);
+                    queueTimer(timer, element);
+                }
                 return;
             }        
         }
@@ -327,6 +339,7 @@ void Scheduler::schedule(const ccSchedulerFunc& callback, void *target, float in
     timer->initWithCallback(this, callback, target, key, interval, repeat, delay);
     ccArrayAppendObject(element->timers, timer);
     timer->release();
+    queueTimer(timer, element);
 }
 
 void Scheduler::unschedule(const std::string &key, void *target)
@@ -357,6 +370,7 @@ void Scheduler::unschedule(const std::string &key, void *target)
                     element->currentTimerSalvaged = true;
                 }
 
+                dequeueTimer(timer);
                 ccArrayRemoveObjectAtIndex(element->timers, i, true);
 
                 // update timerIndex in case we are in tick:, looping over the actions
@@ -652,6 +666,7 @@ void Scheduler::unscheduleAllForTarget(void *target)
             element->currentTimer->retain();
             element->currentTimerSalvaged = true;
         }
+        dequeueTargetTimers(element);
         ccArrayRemoveAllObjects(element->timers);
 
         if (_currentTarget == element)
@@ -698,9 +713,10 @@ void Scheduler::resumeTarget(void *target)
     // custom selectors
     tHashTimerEntry *element = nullptr;
     HASH_FIND_PTR(_hashForTimers, &target, element);
-    if (element)
+    if (element && element->paused)
     {
         element->paused = false;
+        queueTargetTimers(element);
     }
 
     // update selector
@@ -722,6 +738,7 @@ void Scheduler::pauseTarget(void *target)
     HASH_FIND_PTR(_hashForTimers, &target, element);
     if (element)
     {
+        dequeueTargetTimers(element);
         element->paused = true;
     }
 
@@ -771,6 +788,7 @@ std::set<void*> Scheduler::pauseAllTargetsWithMinPriority(int minPriority)
     for(tHashTimerEntry *element = _hashForTimers; element != nullptr;
         element = (tHashTimerEntry*)element->hh.next)
     {
+        dequeueTargetTimers(element);
         element->paused = true;
         idsWithSelectors.insert(element->target);
     }
@@ -817,13 +835,170 @@ void Scheduler::resumeTargets(const std::set<void*>& targetsToResume)
     }
 }
 
-void Scheduler::performFunctionInCocosThread(const std::function<void ()> &function)
+// timer queue
+
+void Scheduler::setTimerQueueEnabled(bool enabled)
 {
-    _performMutex.lock();
+    CCASSERT(!_updateHashLocked, "Can't change the timer queue from a scheduled callback");
+    if (enabled == _timerQueueEnabled)
+        return;
 
-    _functionsToPerform.push_back(function);
+    if (enabled)
+    {
+        _timerQueueEnabled = true;
+        for (tHashTimerEntry *element = _hashForTimers; element != nullptr; element = (tHashTimerEntry*)element->hh.next)
+        {
+            queueTargetTimers(element);
+        }
+    }
+    else
+    {
+        while (!_timerQueue.empty())
+        {
+            dequeueTimer(_timerQueue.back().timer);
+        }
+        _timerQueueEnabled = false;
+    }
+}
+
+void Scheduler::queueTimer(Timer* timer, tHashTimerEntry *element)
+{
+    if (!_timerQueueEnabled || element->paused || timer->_queueIndex >= 0)
+        return;
 
-    _performMutex.unlock();
+    double dueTime = _time;
+    // the first update of a timer only initializes it, it is due now
+    if (timer->_elapsed != -1)
+    {
+        float remaining = (timer->_useDelay ? timer->_delay : timer->_interval) - timer->_elapsed;
+        // a timer is updated at most once per frame
+        dueTime = std::max(_time + remaining, std::nextafter(_time, DBL_MAX));
+    }
+    timer->_lastUpdateTime = _time;
+
+    TimerQueueEntry entry = { dueTime, timer, element };
+    timer->_queueIndex = _timerQueue.size();
+    _timerQueue.push_back(entry);
+    moveQueuedTimer(timer->_queueIndex);
+}
+
+void Scheduler::dequeueTimer(Timer* timer)
+{
+    ssize_t index = timer->_queueIndex;
+    if (index < 0)
+        return;
+
+    // keep the time elapsed since the last update, for a later queueTimer()
+    if (timer->_elapsed != -1)
+    {
+        timer->_elapsed += (float)(_time - timer->_lastUpdateTime);
+    }
+    timer->_queueIndex = -1;
+
+    ssize_t last = _timerQueue.size() - 1;
+    if (index != last)
+    {
+        _timerQueue[index] = _timerQueue[last];
+        _timerQueue[index].timer->_queueIndex = index;
+        _timerQueue.pop_back();
+        moveQueuedTimer(index);
+    }
+    else
+    {
+        _timerQueue.pop_back();
+    }
+}
+
+void Scheduler::queueTargetTimers(tHashTimerEntry *element)
+{
+    for (int i = 0; i < element->timers->num; ++i)
+    {
+        queueTimer(static_cast<Timer*>(element->timers->arr[i]), element);
+    }
+}
+
+void Scheduler::dequeueTargetTimers(tHashTimerEntry *element)
+{
+    for (int i = 0; i < element->timers->num; ++i)
+    {
+        dequeueTimer(static_cast<Timer*>(element->timers->arr[i]));
+    }
+}
+
+void Scheduler::moveQueuedTimer(ssize_t index)
+{
+    TimerQueueEntry entry = _timerQueue[index];
+    ssize_t count = _timerQueue.size();
+
+    // up
+    while (index > 0)
+    {
+        ssize_t parent = (index - 1) / 2;
+        if (_timerQueue[parent].dueTime <= entry.dueTime)
+            break;
+        _timerQueue[index] = _timerQueue[parent];
+        _timerQueue[index].timer->_queueIndex = index;
+        index = parent;
+    }
+    // down
+    for (;;)
+    {
+        ssize_t child = index * 2 + 1;
+        if (child >= count)
+            break;
+        if (child + 1 < count && _timerQueue[child + 1].dueTime < _timerQueue[child].dueTime)
+            ++child;
+        if (entry.dueTime <= _timerQueue[child].dueTime)
+            break;
+        _timerQueue[index] = _timerQueue[child];
+        _timerQueue[index].timer->_queueIndex = index;
+        index = child;
+    }
+    _timerQueue[index] = entry;
+    entry.timer->_queueIndex = index;
+}
+
+void Scheduler::updateTimerQueue()
+{
+    while (!_timerQueue.empty() && _timerQueue[0].dueTime <= _time)
+    {
+        Timer* timer = _timerQueue[0].timer;
+        tHashTimerEntry* elt = _timerQueue[0].element;
+
+        float elapsed = (float)(_time - timer->_lastUpdateTime);
+        // the elapsed time is passed to update(), not added by dequeueTimer()
+        timer->_lastUpdateTime = _time;
+        dequeueTimer(timer);
+
+        _currentTarget = elt;
+        _currentTargetSalvaged = false;
+        elt->currentTimer = timer;
+        elt->currentTimerSalvaged = false;
+
+        timer->update(elapsed);
+
+        if (elt->currentTimerSalvaged)
+        {
+            // unscheduled by its own callback, see the loop of the default mode
+            timer->release();
+        }
+        else
+        {
+            queueTimer(timer, elt);
+        }
+        elt->currentTimer = nullptr;
+
+        if (_currentTargetSalvaged && elt->timers->num == 0)
+        {
+            removeHashElement(elt);
+        }
+    }
+    _currentTarget = nullptr;
+}
+
+void Scheduler::performFunctionInCocosThread(const std::function<void ()> &function)
+{
+    _functionQueue.post(function);
 }
 
 // main loop
@@ -870,42 +1045,51 @@ void Scheduler::update(float dt)
         }
     }
 
+    _time += dt;
+
     // Iterate over all the custom selectors
-    for (tHashTimerEntry *elt = _hashForTimers; elt != nullptr; )
+    if (_timerQueueEnabled)
     {
-        _currentTarget = elt;
-        _currentTargetSalvaged = false;
-
-        if (! _currentTarget->paused)
+        updateTimerQueue();
+    }
+    else
+    {
+        for (tHashTimerEntry *elt = _hashForTimers; elt != nullptr; )
         {
-            // The 'timers' array may change while inside this loop
-            for (elt->timerIndex = 0; elt->timerIndex < elt->timers->num; ++(elt->timerIndex))
+            _currentTarget = elt;
+            _currentTargetSalvaged = false;
+
+            if (! _currentTarget->paused)
             {
-                elt->currentTimer = (Timer*)(elt->timers->arr[elt->timerIndex]);
-                elt->currentTimerSalvaged = false;
+                // The 'timers' array may change while inside this loop
+                for (elt->timerIndex = 0; elt->timerIndex < elt->timers->num; ++(elt->timerIndex))
+                {
+                    elt->currentTimer = (Timer*)(elt->timers->arr[elt->timerIndex]);
+                    elt->currentTimerSalvaged = false;
 
-                elt->currentTimer->update(dt);
+                    elt->currentTimer->update(dt);
 
-                if (elt->currentTimerSalvaged)
-                {
-                    // The currentTimer told the remove itself. To prevent the timer from
-                    // accidentally deallocating itself before finishing its step, we retained
-                    // it. Now that step is done, it's safe to release it.
-                    elt->currentTimer->release();
-                }
+                    if (elt->currentTimerSalvaged)
+                    {
+                        // The currentTimer told the remove itself. To prevent the timer from
+                        // accidentally deallocating itself before finishing its step, we retained
+                        // it. Now that step is done, it's safe to release it.
+                        elt->currentTimer->release();
+                    }
 
-                elt->currentTimer = nullptr;
+                    elt->currentTimer = nullptr;
+                }
             }
-        }
 
-        // elt, at this moment, is still valid
-        // so it is safe to ask this here (issue #490)
-        elt = (tHashTimerEntry *)elt->hh.next;
+            // elt, at this moment, is still valid
+            // so it is safe to ask this here (issue #490)
+            elt = (tHashTimerEntry *)elt->hh.next;
 
-        // only delete currentTarget if no actions were scheduled during the cycle (issue #481)
-        if (_currentTargetSalvaged && _currentTarget->timers->num == 0)
-        {
-            removeHashElement(_currentTarget);
+            // only delete currentTarget if no actions were scheduled during the cycle (issue #481)
+            if (_currentTargetSalvaged && _currentTarget->timers->num == 0)
+            {
+                removeHashElement(_currentTarget);
+            }
         }
     }
 
@@ -966,19 +1150,8 @@ void Scheduler::update(float dt)
     // Functions allocated from another thread
     //
 
-    // Testing size is faster than locking / unlocking.
-    // And almost never there will be functions scheduled to be called.
-    if( !_functionsToPerform.empty() ) {
-        _performMutex.lock();
-        // fixed #4123: Save the callback functions, they must be invoked after '_performMutex.unlock()', otherwise if new functions are added in callback, it will cause thread deadlock.
-        auto temp = _functionsToPerform;
-        _functionsToPerform.clear();
-        _performMutex.unlock();
-        for( const auto &function : temp ) {
-            function();
-        }
-        
-    }
+    // Functions posted by the callbacks themselves run next frame.
+    _functionQueue.run(_performFunctionBudget);
 }
 
 void Scheduler::schedule(SEL_SCHEDULE selector, Ref *target, float interval, unsigned int repeat, float delay, bool paused)
@@ -1017,6 +1190,11 @@ void Scheduler::schedule(SEL_SCHEDULE selector, Ref *target, float interval, uns
             {
                 CCLOG("CCScheduler#scheduleSelector. Selector already scheduled. Updating interval from: %.4f to %.4f", timer->getInterval(), interval);
                 timer->setInterval(interval);
+                if (timer->_queueIndex >= 0)
+                {
+                    dequeueTimer(timer);
+                    queueTimer(timer, element);
+                }
                 return;
             }
         }
@@ -1027,6 +1205,7 @@ void Scheduler::schedule(SEL_SCHEDULE selector, Ref *target, float interval, uns
     timer->initWithSelector(this, selector, target, interval, repeat, delay);
     ccArrayAppendObject(element->timers, timer);
     timer->release();
+    queueTimer(timer, element);
 }
 
 void Scheduler::schedule(SEL_SCHEDULE selector, Ref *target, float interval, bool paused)
@@ -1097,6 +1276,7 @@ void Scheduler::unschedule(SEL_SCHEDULE selector, Ref *target)
                     element->currentTimerSalvaged = true;
                 }
                 
+                dequeueTimer(timer);
                 ccArrayRemoveObjectAtIndex(element->timers, i, true);
                 
                 // update timerIndex in case we are in tick:, looping over the actions
@@ -34,6 +34,7 @@ THE SOFTWARE.
 
 #include "base/CCRef.h"
 #include "base/CCVector.h"
+#include "base/CCFunctionQueue.h"
 #include "base/uthash.h"
 
 NS_CC_BEGIN
@@ -79,6 +80,12 @@ protected:
     unsigned int _repeat; //0 = once, 1 is 2 x executed
     float _delay;
     float _interval;
+
+    // timer queue of the scheduler, see Scheduler::setTimerQueueEnabled()
+    ssize_t _queueIndex;        // index in the queue, -1 if it isn't queued
+    double _lastUpdateTime;     // scheduler time of the last update
+
+    friend class Scheduler;
 };
 
 
@@ -363,6 +370,33 @@ public:
      @since v3.0
      */
     void performFunctionInCocosThread( const std::function<void()> &function);
+
+    /** Same as the std::function version, a callable that fits FunctionQueue::TASK_STORAGE_SIZE is posted without an allocation.
+     */
+    template <typename F>
+    void performFunctionInCocosThread(F&& function) { _functionQueue.post(std::forward<F>(function)); }
+
+    /** Seconds per frame after which the remaining functions of performFunctionInCocosThread() wait for the next frame.
+     0, the default, runs all the functions posted before the frame.
+     */
+    void setPerformFunctionBudget(float seconds) { _performFunctionBudget = seconds; }
+    float getPerformFunctionBudget() const { return _performFunctionBudget; }
+
+    /** Number of functions waiting to be performed in the cocos2d thread */
+    unsigned int getPerformFunctionQueueDepth() const { return _functionQueue.getDepth(); }
+
+    /** Counters and latency of performFunctionInCocosThread(), read them from the cocos2d thread */
+    const FunctionQueue::Stats& getPerformFunctionStats() const { return _functionQueue.getStats(); }
+    void resetPerformFunctionStats() { _functionQueue.resetStats(); }
+
+    /** Keeps the custom selector and callback timers in a queue ordered by their next trigger time.
+     Each frame only updates the timers that are due, instead of every timer of every target,
+     so thousands of long timers cost nearly nothing. Due timers are triggered in the order of their trigger time,
+     the trigger time may differ by a frame from the default mode because of float rounding.
+     Disabled by default. Don't call it from a scheduled callback.
+     */
+    void setTimerQueueEnabled(bool enabled);
+    bool isTimerQueueEnabled() const { return _timerQueueEnabled; }
     
     /////////////////////////////////////
     
@@ -431,6 +465,15 @@ protected:
     void removeHashElement(struct _hashSelectorEntry *element);
     void removeUpdateFromHash(struct _listEntry *entry);
 
+    // timer queue specific
+
+    void queueTimer(Timer* timer, struct _hashSelectorEntry *element);
+    void dequeueTimer(Timer* timer);
+    void queueTargetTimers(struct _hashSelectorEntry *element);
+    void dequeueTargetTimers(struct _hashSelectorEntry *element);
+    void moveQueuedTimer(ssize_t index);
+    void updateTimerQueue();
+
     // update specific
 
     void priorityIn(struct _listEntry **list, const ccSchedulerFunc& callback, void *target, int priority, bool paused);
@@ -458,9 +501,20 @@ protected:
     Vector<SchedulerScriptHandlerEntry*> _scriptHandlerEntries;
 #endif
     
+    // Used by the timer queue, a binary min heap on dueTime
+    struct TimerQueueEntry
+    {
+        double dueTime;
+        Timer* timer;
+        struct _hashSelectorEntry* element;
+    };
+    std::vector<TimerQueueEntry> _timerQueue;
+    double _time;                   // sum of the scaled delta times
+    bool _timerQueueEnabled;
+
     // Used for "perform Function"
-    std::vector<std::function<void()>> _functionsToPerform;
-    std::mutex _performMutex;
+    FunctionQueue _functionQueue;
+    float _performFunctionBudget;
 };
 
 // end of global group
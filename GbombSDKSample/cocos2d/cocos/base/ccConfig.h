@@ -248,6 +248,31 @@ To enable set it to a value different than 0. Disabled by default.
 #define CC_NODE_DEBUG_VERIFY_EVENT_LISTENERS 0
 #endif
 
+/** @def CC_ENABLE_LEGACY_MATRIX_STACK
+ If enabled, Node::visit() loads the model view transform of every visited node on the deprecated
+ model view matrix stack of the Director, so code reading Director::getMatrix() while visiting keeps working.
+ If disabled, the stack is only used by the nodes that call Node::setLegacyMatrixStackRequired(true),
+ which saves two matrix copies per visited node. RenderTexture and cocostudio::Armature require it.
+ Nodes drawn by a custom draw() that reads Director::getMatrix() must require it too.
+ It can be changed at runtime with Node::setLegacyMatrixStackEnabled().
+ 
+ To disable set it to 0. Enabled by default.
+ */
+#ifndef CC_ENABLE_LEGACY_MATRIX_STACK
+#define CC_ENABLE_LEGACY_MATRIX_STACK 1
+#endif
+
+/** @def CC_ENABLE_REF_POOL
+ If enabled, the game classes declaring CC_REF_POOL() are allocated from a RefPool: their memory is
+ recycled for the next object of the class instead of going back to the heap. The engine classes
+ don't declare it. The pools are trimmed by Director::purgeCachedData().
+ 
+ To disable set it to 0. Enabled by default.
+ */
+#ifndef CC_ENABLE_REF_POOL
+#define CC_ENABLE_REF_POOL 1
+#endif
+
 /** @def CC_ENABLE_PROFILERS
  If enabled, will activate various profilers within cocos2d. This statistical data will be output to the console
  once per second showing average time (in milliseconds) required to execute the specific routine(s).
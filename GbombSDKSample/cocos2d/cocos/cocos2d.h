@@ -40,6 +40,7 @@ THE SOFTWARE.
 // base
 #include "base/CCRef.h"
 #include "base/CCRefPtr.h"
+#include "base/CCRefPool.h"
 #include "base/CCVector.h"
 #include "base/CCMap.h"
 #include "base/CCAutoreleasePool.h"
@@ -52,6 +53,7 @@ THE SOFTWARE.
 #include "base/CCConfiguration.h"
 #include "base/CCDirector.h"
 #include "base/CCScheduler.h"
+#include "base/CCJobSystem.h"
 #include "base/base64.h"
 #include "base/ZipUtils.h"
 #include "base/CCProfiling.h"
@@ -244,6 +246,7 @@ THE SOFTWARE.
 #include "2d/CCAnimationCache.h"
 #include "2d/CCSprite.h"
 #include "2d/CCSpriteBatchNode.h"
+#include "2d/CCInstancedSpriteNode.h"
 #include "2d/CCSpriteFrame.h"
 #include "2d/CCSpriteFrameCache.h"
 
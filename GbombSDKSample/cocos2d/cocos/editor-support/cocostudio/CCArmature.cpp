@@ -90,6 +90,8 @@ Armature::Armature()
     , _armatureTransformDirty(true)
     , _animation(nullptr)
 {
+    // Skin::draw() reads the model view matrix of the Director stack
+    setLegacyMatrixStackRequired(true);
 }
 
 
@@ -479,8 +481,12 @@ void Armature::visit(cocos2d::Renderer *renderer, const Mat4 &parentTransform, u
     // but it is deprecated and your code should not rely on it
     Director* director = Director::getInstance();
     CCASSERT(nullptr != director, "Director is null when seting matrix stack");
-    director->pushMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW);
-    director->loadMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW, _modelViewTransform);
+    bool legacyMatrixStack = usesLegacyMatrixStack();
+    if (legacyMatrixStack)
+    {
+        director->pushMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW);
+        director->loadMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW, _modelViewTransform);
+    }
 
 
     sortAllChildren();
@@ -490,7 +496,8 @@ void Armature::visit(cocos2d::Renderer *renderer, const Mat4 &parentTransform, u
     // Please refer to https://github.com/cocos2d/cocos2d-x/pull/6920
     // setOrderOfArrival(0);
 
-    director->popMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW);
+    if (legacyMatrixStack)
+        director->popMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW);
 }
 
 Rect Armature::getBoundingBox() const
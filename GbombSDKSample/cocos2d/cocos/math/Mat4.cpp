@@ -904,6 +904,16 @@ void Mat4::transformPoint(const Vec3& point, Vec3* dst) const
     transformVector(point.x, point.y, point.z, 1.0f, dst);
 }
 
+void Mat4::transformPoints(const Vec3* src, size_t srcStride, Vec3* dst, size_t dstStride, size_t count) const
+{
+    GP_ASSERT(src && dst);
+#ifdef __SSE__
+    MathUtil::transformVec3Points(col, (const float*)src, srcStride, (float*)dst, dstStride, count);
+#else
+    MathUtil::transformVec3Points(m, (const float*)src, srcStride, (float*)dst, dstStride, count);
+#endif
+}
+
 void Mat4::transformVector(Vec3* vector) const
 {
     GP_ASSERT(vector);
@@ -772,6 +772,21 @@ public:
      */
     void transformPoint(const Vec3& point, Vec3* dst) const;
 
+    /**
+     * Transforms an array of points by this matrix.
+     *
+     * Points are read srcStride bytes apart and written dstStride bytes apart,
+     * so the positions of interleaved vertices can be transformed in one call.
+     * dst may be equal to src.
+     *
+     * @param src The first point to transform.
+     * @param srcStride The number of bytes from one source point to the next.
+     * @param dst The first point to store the result in.
+     * @param dstStride The number of bytes from one destination point to the next.
+     * @param count The number of points.
+     */
+    void transformPoints(const Vec3* src, size_t srcStride, Vec3* dst, size_t dstStride, size_t count) const;
+
     /**
      * Transforms the specified vector by this matrix by
      * treating the fourth (w) coordinate as zero.
@@ -87,6 +87,8 @@ private:
     inline static void transposeMatrix(const __m128 m[4], __m128 dst[4]);
         
     inline static void transformVec4(const __m128 m[4], const __m128& v, __m128& dst);
+
+    inline static void transformVec3Points(const __m128 m[4], const float* src, size_t srcStride, float* dst, size_t dstStride, size_t count);
 #endif
     inline static void addMatrix(const float* m, float scalar, float* dst);
 
@@ -106,6 +108,8 @@ private:
 
     inline static void transformVec4(const float* m, const float* v, float* dst);
 
+    inline static void transformVec3Points(const float* m, const float* src, size_t srcStride, float* dst, size_t dstStride, size_t count);
+
     inline static void crossVec3(const float* v1, const float* v2, float* dst);
 
     MathUtil();
@@ -220,6 +220,38 @@ inline void MathUtil::transformVec4(const float* m, const float* v, float* dst)
     );
 }
 
+inline void MathUtil::transformVec3Points(const float* m, const float* src, size_t srcStride, float* dst, size_t dstStride, size_t count)
+{
+    if (count == 0)
+        return;
+
+    // x and y are loaded and stored with a post increment of 8 bytes, z with the rest of the stride
+    size_t srcStep = srcStride - 8;
+    size_t dstStep = dstStride - 8;
+    asm volatile(
+        "vld1.32    {d18 - d21},    [%3]!   \n\t"    // M[m0-m7]
+        "vld1.32    {d22 - d25},    [%3]    \n\t"    // M[m8-m15]
+
+        "1:                                 \n\t"
+        "vld1.32    {d0},           [%1]!   \n\t"    // V[x, y]
+        "vld1.32    {d1[0]},        [%1], %4 \n\t"   // V[z]
+
+        "vmov       q13, q12                \n\t"    // DST->V = M[m12-m15]
+        "vmla.f32   q13, q9, d0[0]          \n\t"    // DST->V += M[m0-m3] * V[x]
+        "vmla.f32   q13, q10, d0[1]         \n\t"    // DST->V += M[m4-m7] * V[y]
+        "vmla.f32   q13, q11, d1[0]         \n\t"    // DST->V += M[m8-m11] * V[z]
+
+        "vst1.32    {d26},          [%0]!   \n\t"    // DST->V[x, y]
+        "vst1.32    {d27[0]},       [%0], %5 \n\t"   // DST->V[z]
+
+        "subs       %2, %2, #1              \n\t"
+        "bne        1b                      \n\t"
+        : "+r"(dst), "+r"(src), "+r"(count), "+r"(m)
+        : "r"(srcStep), "r"(dstStep)
+        : "q0", "q9", "q10", "q11", "q12", "q13", "cc", "memory"
+    );
+}
+
 inline void MathUtil::crossVec3(const float* v1, const float* v2, float* dst)
 {
     asm volatile(
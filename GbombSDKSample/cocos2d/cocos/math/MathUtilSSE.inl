@@ -149,4 +149,33 @@ inline void MathUtil::transformVec4(const __m128 m[4], const __m128& v, __m128&
           );
 }
 
+inline void MathUtil::transformVec3Points(const __m128 m[4], const float* src, size_t srcStride, float* dst, size_t dstStride, size_t count)
+{
+    const __m128 m0 = m[0];
+    const __m128 m1 = m[1];
+    const __m128 m2 = m[2];
+    const __m128 m3 = m[3];
+    // a single load reads past z, only allowed if the point isn't packed
+    const bool wideLoad = srcStride >= 4 * sizeof(float);
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        __m128 v = wideLoad ? _mm_loadu_ps(src) : _mm_set_ps(0.0f, src[2], src[1], src[0]);
+        __m128 x = _mm_shuffle_ps(v, v, _MM_SHUFFLE(0, 0, 0, 0));
+        __m128 y = _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 1, 1, 1));
+        __m128 z = _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 2, 2, 2));
+
+        __m128 r = _mm_add_ps(
+                    _mm_add_ps(_mm_mul_ps(m0, x), _mm_mul_ps(m1, y)),
+                    _mm_add_ps(_mm_mul_ps(m2, z), m3)
+                   );
+
+        _mm_storel_pi((__m64*)dst, r);
+        _mm_store_ss(dst + 2, _mm_movehl_ps(r, r));
+
+        src = (const float*)((const char*)src + srcStride);
+        dst = (float*)((char*)dst + dstStride);
+    }
+}
+
 NS_CC_MATH_END
@@ -48,6 +48,8 @@ bool GroupCommandManager::init()
 
 int GroupCommandManager::getGroupID()
 {
+    std::lock_guard<std::mutex> lock(_groupMappingMutex);
+
     //Reuse old id
     for(auto it = _groupMapping.begin(); it != _groupMapping.end(); ++it)
     {
@@ -68,6 +70,7 @@ int GroupCommandManager::getGroupID()
 
 void GroupCommandManager::releaseGroupID(int groupID)
 {
+    std::lock_guard<std::mutex> lock(_groupMappingMutex);
     _groupMapping[groupID] = false;
 }
 
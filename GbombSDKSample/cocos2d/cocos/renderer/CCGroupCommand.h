@@ -27,6 +27,7 @@
 #define _CC_GROUPCOMMAND_H_
 
 #include <unordered_map>
+#include <mutex>
 
 #include "base/CCRef.h"
 #include "CCRenderCommand.h"
@@ -45,6 +46,8 @@ protected:
     ~GroupCommandManager();
     bool init();
     std::unordered_map<int, bool> _groupMapping;
+    // group commands may be initialized by nodes visited on recording threads
+    std::mutex _groupMappingMutex;
 };
 
 class CC_DLL GroupCommand : public RenderCommand
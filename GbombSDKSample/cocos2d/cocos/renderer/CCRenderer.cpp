@@ -25,6 +25,7 @@
 #include "renderer/CCRenderer.h"
 
 #include <algorithm>
+#include <cfloat>
 
 #include "renderer/CCTrianglesCommand.h"
 #include "renderer/CCQuadCommand.h"
@@ -40,6 +41,7 @@
 #include "base/CCEventDispatcher.h"
 #include "base/CCEventListenerCustom.h"
 #include "base/CCEventType.h"
+#include "base/CCJobSystem.h"
 #include "base/CCCamera.h"
 #include "2d/CCScene.h"
 
@@ -51,6 +53,256 @@ static bool compareRenderCommand(RenderCommand* a, RenderCommand* b)
     return a->getGlobalOrder() < b->getGlobalOrder();
 }
 
+static bool compareTransparentRenderCommand(RenderCommand* a, RenderCommand* b)
+{
+    return a->getGlobalOrder() > b->getGlobalOrder();
+}
+
+// queues smaller than this are sorted with std::stable_sort
+static const size_t RADIX_SORT_THRESHOLD = 256;
+
+// maps a float to an unsigned int with the same order, so global orders can be radix sorted
+static inline uint32_t sortKeyForGlobalOrder(float globalOrder)
+{
+    uint32_t bits;
+    memcpy(&bits, &globalOrder, sizeof(bits));
+    return (bits & 0x80000000) ? ~bits : (bits | 0x80000000);
+}
+
+// stable sort of the commands by global order, ascending or descending
+static void sortRenderCommands(std::vector<RenderCommand*>& commands, std::vector<RenderSortEntry>& buffer, bool descending)
+{
+    const size_t count = commands.size();
+    auto compare = descending ? compareTransparentRenderCommand : compareRenderCommand;
+
+    // the order rarely changes from one frame to the next
+    if (std::is_sorted(std::begin(commands), std::end(commands), compare))
+        return;
+
+    if (count < RADIX_SORT_THRESHOLD)
+    {
+        std::stable_sort(std::begin(commands), std::end(commands), compare);
+        return;
+    }
+
+    // LSD radix sort, one byte of the key per pass
+    buffer.resize(count * 2);
+    RenderSortEntry* src = buffer.data();
+    RenderSortEntry* dst = src + count;
+    for (size_t i = 0; i < count; ++i)
+    {
+        uint32_t key = sortKeyForGlobalOrder(commands[i]->getGlobalOrder());
+        src[i].key = descending ? ~key : key;
+        src[i].command = commands[i];
+    }
+
+    for (int shift = 0; shift < 32; shift += 8)
+    {
+        size_t offsets[256] = {0};
+        for (size_t i = 0; i < count; ++i)
+            ++offsets[(src[i].key >> shift) & 0xff];
+
+        // skip the pass if every key has the same byte here, usual for the high bytes
+        if (offsets[(src[0].key >> shift) & 0xff] == count)
+            continue;
+
+        size_t offset = 0;
+        for (int digit = 0; digit < 256; ++digit)
+        {
+            size_t digitCount = offsets[digit];
+            offsets[digit] = offset;
+            offset += digitCount;
+        }
+        for (size_t i = 0; i < count; ++i)
+            dst[offsets[(src[i].key >> shift) & 0xff]++] = src[i];
+
+        std::swap(src, dst);
+    }
+
+    for (size_t i = 0; i < count; ++i)
+        commands[i] = src[i].command;
+}
+
+// a command is only compared with the last few batches when it looks for a batch of its material
+static const int BATCH_REORDER_WINDOW = 16;
+
+static inline bool isTrianglesCommand(RenderCommand* command)
+{
+    auto commandType = command->getType();
+    return RenderCommand::Type::QUAD_COMMAND == commandType || RenderCommand::Type::TRIANGLES_COMMAND == commandType;
+}
+
+// screen space bounds of the command, false if it is empty or partly behind the camera
+static bool computeBatchBounds(const TrianglesCommand* cmd, const Mat4& projection, RenderBatchBounds& bounds)
+{
+    ssize_t count = cmd->getVertexCount();
+    if (count <= 0)
+        return false;
+
+    const V3F_C4B_T2F* verts = cmd->getVertices();
+    Vec3 localMin = verts[0].vertices;
+    Vec3 localMax = localMin;
+    for (ssize_t i = 1; i < count; ++i)
+    {
+        const Vec3& v = verts[i].vertices;
+        localMin.x = std::min(localMin.x, v.x);
+        localMin.y = std::min(localMin.y, v.y);
+        localMin.z = std::min(localMin.z, v.z);
+        localMax.x = std::max(localMax.x, v.x);
+        localMax.y = std::max(localMax.y, v.y);
+        localMax.z = std::max(localMax.z, v.z);
+    }
+
+    Mat4 mvp = projection * cmd->getModelView();
+    bounds.minX = bounds.minY = FLT_MAX;
+    bounds.maxX = bounds.maxY = -FLT_MAX;
+    for (int corner = 0; corner < 8; ++corner)
+    {
+        Vec4 p((corner & 1) ? localMax.x : localMin.x,
+               (corner & 2) ? localMax.y : localMin.y,
+               (corner & 4) ? localMax.z : localMin.z,
+               1);
+        mvp.transformVector(&p);
+        if (p.w <= 0)
+            return false;
+
+        float x = p.x / p.w;
+        float y = p.y / p.w;
+        bounds.minX = std::min(bounds.minX, x);
+        bounds.minY = std::min(bounds.minY, y);
+        bounds.maxX = std::max(bounds.maxX, x);
+        bounds.maxY = std::max(bounds.maxY, y);
+    }
+    bounds.materialID = cmd->getMaterialID();
+    return true;
+}
+
+static inline bool overlaps(const RenderBatchBounds& a, const RenderBatchBounds& b)
+{
+    return a.minX < b.maxX && b.minX < a.maxX && a.minY < b.maxY && b.minY < a.maxY;
+}
+
+static ssize_t countBatches(RenderCommand** commands, size_t count)
+{
+    ssize_t batches = 0;
+    uint32_t lastMaterialID = TrianglesCommand::MATERIAL_ID_DO_NOT_BATCH;
+    for (size_t i = 0; i < count; ++i)
+    {
+        uint32_t materialID = static_cast<TrianglesCommand*>(commands[i])->getMaterialID();
+        if (materialID != lastMaterialID || materialID == TrianglesCommand::MATERIAL_ID_DO_NOT_BATCH)
+            ++batches;
+        lastMaterialID = materialID;
+    }
+    return batches;
+}
+
+// reorders a run of triangles commands of the same global order, returns the number of batches saved
+static ssize_t batchRunByMaterial(RenderCommand** commands, size_t count, const Mat4& projection,
+                                  std::vector<RenderBatchBounds>& batches, std::vector<RenderSortEntry>& entries)
+{
+    batches.clear();
+    entries.resize(count);
+    bool moved = false;
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        auto cmd = static_cast<TrianglesCommand*>(commands[i]);
+        uint32_t materialID = cmd->getMaterialID();
+
+        RenderBatchBounds bounds;
+        bool movable = materialID != TrianglesCommand::MATERIAL_ID_DO_NOT_BATCH && computeBatchBounds(cmd, projection, bounds);
+
+        // join the closest batch of the same material, unless a batch in between is drawn under this command
+        int target = -1;
+        if (movable)
+        {
+            int last = (int)batches.size() - 1;
+            for (int b = last; b >= 0 && b > last - BATCH_REORDER_WINDOW; --b)
+            {
+                if (batches[b].materialID == materialID)
+                {
+                    target = b;
+                    break;
+                }
+                if (overlaps(batches[b], bounds))
+                    break;
+            }
+        }
+
+        if (target >= 0)
+        {
+            auto& batch = batches[target];
+            batch.minX = std::min(batch.minX, bounds.minX);
+            batch.minY = std::min(batch.minY, bounds.minY);
+            batch.maxX = std::max(batch.maxX, bounds.maxX);
+            batch.maxY = std::max(batch.maxY, bounds.maxY);
+            ++batch.commandCount;
+            moved = moved || target != (int)batches.size() - 1;
+        }
+        else
+        {
+            if (!movable)
+            {
+                // nothing may be moved across a command whose bounds are unknown
+                bounds.materialID = materialID;
+                bounds.minX = bounds.minY = -FLT_MAX;
+                bounds.maxX = bounds.maxY = FLT_MAX;
+            }
+            bounds.commandCount = 1;
+            target = (int)batches.size();
+            batches.push_back(bounds);
+        }
+        entries[i].key = target;
+        entries[i].command = cmd;
+    }
+
+    if (!moved)
+        return 0;
+
+    ssize_t batchesBefore = countBatches(commands, count);
+
+    // stable counting sort by batch, commandCount becomes the offset of the batch
+    uint32_t offset = 0;
+    for (auto& batch : batches)
+    {
+        uint32_t batchCount = batch.commandCount;
+        batch.commandCount = offset;
+        offset += batchCount;
+    }
+    for (size_t i = 0; i < count; ++i)
+        commands[batches[entries[i].key].commandCount++] = entries[i].command;
+
+    return batchesBefore - countBatches(commands, count);
+}
+
+// finds the runs of triangles commands sharing a global order and reorders each of them by material
+static ssize_t batchCommandsByMaterial(std::vector<RenderCommand*>& commands, const Mat4& projection,
+                                       std::vector<RenderBatchBounds>& batches, std::vector<RenderSortEntry>& entries)
+{
+    ssize_t saved = 0;
+    const size_t count = commands.size();
+    size_t begin = 0;
+    while (begin < count)
+    {
+        if (!isTrianglesCommand(commands[begin]))
+        {
+            ++begin;
+            continue;
+        }
+
+        float globalOrder = commands[begin]->getGlobalOrder();
+        size_t end = begin + 1;
+        while (end < count && isTrianglesCommand(commands[end]) && commands[end]->getGlobalOrder() == globalOrder)
+            ++end;
+
+        // a run of two or fewer commands can't be improved
+        if (end - begin > 2)
+            saved += batchRunByMaterial(&commands[begin], end - begin, projection, batches, entries);
+        begin = end;
+    }
+    return saved;
+}
+
 // queue
 
 void RenderQueue::push_back(RenderCommand* command)
@@ -72,8 +324,8 @@ ssize_t RenderQueue::size() const
 void RenderQueue::sort()
 {
     // Don't sort _queue0, it already comes sorted
-    std::sort(std::begin(_queueNegZ), std::end(_queueNegZ), compareRenderCommand);
-    std::sort(std::begin(_queuePosZ), std::end(_queuePosZ), compareRenderCommand);
+    sortRenderCommands(_queueNegZ, _sortBuffer, false);
+    sortRenderCommands(_queuePosZ, _sortBuffer, false);
 }
 
 RenderCommand* RenderQueue::operator[](ssize_t index) const
@@ -95,6 +347,13 @@ RenderCommand* RenderQueue::operator[](ssize_t index) const
     return nullptr;
 }
 
+ssize_t RenderQueue::batchByMaterial(const Mat4& projection)
+{
+    return batchCommandsByMaterial(_queueNegZ, projection, _batchBuffer, _sortBuffer)
+         + batchCommandsByMaterial(_queue0, projection, _batchBuffer, _sortBuffer)
+         + batchCommandsByMaterial(_queuePosZ, projection, _batchBuffer, _sortBuffer);
+}
+
 void RenderQueue::clear()
 {
     _queueNegZ.clear();
@@ -102,12 +361,6 @@ void RenderQueue::clear()
     _queuePosZ.clear();
 }
 
-// helper
-static bool compareTransparentRenderCommand(RenderCommand* a, RenderCommand* b)
-{
-    return a->getGlobalOrder() > b->getGlobalOrder();
-}
-
 void TransparentRenderQueue::push_back(RenderCommand* command)
 {
     _queueCmd.push_back(command);
@@ -115,7 +368,7 @@ void TransparentRenderQueue::push_back(RenderCommand* command)
 
 void TransparentRenderQueue::sort()
 {
-    std::sort(std::begin(_queueCmd), std::end(_queueCmd), compareTransparentRenderCommand);
+    sortRenderCommands(_queueCmd, _sortBuffer, true);
 }
 
 RenderCommand* TransparentRenderQueue::operator[](ssize_t index) const
@@ -133,19 +386,48 @@ void TransparentRenderQueue::clear()
 //
 static const int DEFAULT_RENDER_QUEUE = 0;
 
+// uploads size bytes of data into the bound buffer, reallocating it to capacity bytes if it is too small
+static void uploadBuffer(GLenum target, GLsizeiptr size, GLsizeiptr capacity, const GLvoid* data, GLsizeiptr& allocatedSize)
+{
+    if (size > allocatedSize)
+    {
+        glBufferData(target, capacity, nullptr, GL_DYNAMIC_DRAW);
+        allocatedSize = capacity;
+    }
+    glBufferSubData(target, 0, size, data);
+}
+
 //
 // constructors, destructors, init
 //
 Renderer::Renderer()
 :_lastMaterialID(0)
 ,_lastBatchedMeshCommand(nullptr)
+,_useIndices32(false)
+,_supportsIndices32(false)
+,_maxBatchVertices(MAX_VBO_SIZE)
+,_maxBatchIndices(MAX_INDEX_VBO_SIZE)
+,_vertexBufferCount(3)
+,_currentVertexBuffer(0)
 ,_filledVertex(0)
 ,_filledIndex(0)
 ,_glViewAssigned(false)
+,_drawnBatches(0)
+,_drawnVertices(0)
+,_savedBatches(0)
+,_uploadedBytes(0)
+,_bufferUploads(0)
+,_peakBatchVertices(0)
+,_peakBatchIndices(0)
+,_bufferGrowths(0)
+,_batchReorderingEnabled(false)
 ,_isRendering(false)
 #if CC_ENABLE_CACHE_TEXTURE_DATA
 ,_cacheTextureListener(nullptr)
 #endif
+,_parallelRecordingEnabled(false)
+,_recordingJobSystem(nullptr)
+,_recordingInParallel(false)
 {
     _groupCommandManager = new (std::nothrow) GroupCommandManager();
     
@@ -154,6 +436,8 @@ Renderer::Renderer()
     RenderQueue defaultRenderQueue;
     _renderGroups.push_back(defaultRenderQueue);
     _batchedCommands.reserve(BATCH_QUADCOMMAND_RESEVER_SIZE);
+    _verts.resize(INITIAL_VBO_SIZE);
+    _indices.resize(INITIAL_VBO_SIZE * 6 / 4);
 }
 
 Renderer::~Renderer()
@@ -161,13 +445,7 @@ Renderer::~Renderer()
     _renderGroups.clear();
     _groupCommandManager->release();
     
-    glDeleteBuffers(2, _buffersVBO);
-    
-    if (Configuration::getInstance()->supportsShareableVAO())
-    {
-        glDeleteVertexArrays(1, &_quadVAO);
-        GL::bindVAO(0);
-    }
+    deleteBuffers();
 #if CC_ENABLE_CACHE_TEXTURE_DATA
     Director::getInstance()->getEventDispatcher()->removeEventListener(_cacheTextureListener);
 #endif
@@ -191,6 +469,10 @@ void Renderer::initGLView()
 
 void Renderer::setupBuffer()
 {
+    _supportsIndices32 = Configuration::getInstance()->supportsElementIndexUint();
+    _vertexBuffers.resize(_vertexBufferCount);
+    _currentVertexBuffer = 0;
+
     if(Configuration::getInstance()->supportsShareableVAO())
     {
         setupVBOAndVAO();
@@ -203,40 +485,49 @@ void Renderer::setupBuffer()
 
 void Renderer::setupVBOAndVAO()
 {
-    glGenVertexArrays(1, &_quadVAO);
-    GL::bindVAO(_quadVAO);
+    for (auto& buffer : _vertexBuffers)
+    {
+        glGenVertexArrays(1, &buffer.vao);
+        GL::bindVAO(buffer.vao);
 
-    glGenBuffers(2, &_buffersVBO[0]);
+        glGenBuffers(2, &buffer.vbo[0]);
 
-    glBindBuffer(GL_ARRAY_BUFFER, _buffersVBO[0]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(_verts[0]) * VBO_SIZE, _verts, GL_DYNAMIC_DRAW);
+        buffer.size[0] = sizeof(_verts[0]) * _verts.size();
+        glBindBuffer(GL_ARRAY_BUFFER, buffer.vbo[0]);
+        glBufferData(GL_ARRAY_BUFFER, buffer.size[0], nullptr, GL_DYNAMIC_DRAW);
 
-    // vertices
-    glEnableVertexAttribArray(GLProgram::VERTEX_ATTRIB_POSITION);
-    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 3, GL_FLOAT, GL_FALSE, sizeof(V3F_C4B_T2F), (GLvoid*) offsetof( V3F_C4B_T2F, vertices));
+        // vertices
+        glEnableVertexAttribArray(GLProgram::VERTEX_ATTRIB_POSITION);
+        glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 3, GL_FLOAT, GL_FALSE, sizeof(V3F_C4B_T2F), (GLvoid*) offsetof( V3F_C4B_T2F, vertices));
 
-    // colors
-    glEnableVertexAttribArray(GLProgram::VERTEX_ATTRIB_COLOR);
-    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_COLOR, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(V3F_C4B_T2F), (GLvoid*) offsetof( V3F_C4B_T2F, colors));
+        // colors
+        glEnableVertexAttribArray(GLProgram::VERTEX_ATTRIB_COLOR);
+        glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_COLOR, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(V3F_C4B_T2F), (GLvoid*) offsetof( V3F_C4B_T2F, colors));
 
-    // tex coords
-    glEnableVertexAttribArray(GLProgram::VERTEX_ATTRIB_TEX_COORD);
-    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_TEX_COORD, 2, GL_FLOAT, GL_FALSE, sizeof(V3F_C4B_T2F), (GLvoid*) offsetof( V3F_C4B_T2F, texCoords));
+        // tex coords
+        glEnableVertexAttribArray(GLProgram::VERTEX_ATTRIB_TEX_COORD);
+        glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_TEX_COORD, 2, GL_FLOAT, GL_FALSE, sizeof(V3F_C4B_T2F), (GLvoid*) offsetof( V3F_C4B_T2F, texCoords));
 
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _buffersVBO[1]);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(_indices[0]) * INDEX_VBO_SIZE, _indices, GL_STATIC_DRAW);
+        buffer.size[1] = sizeof(_indices[0]) * _indices.size();
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffer.vbo[1]);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, buffer.size[1], nullptr, GL_DYNAMIC_DRAW);
 
-    // Must unbind the VAO before changing the element buffer.
-    GL::bindVAO(0);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
+        // Must unbind the VAO before changing the element buffer.
+        GL::bindVAO(0);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
 
     CHECK_GL_ERROR_DEBUG();
 }
 
 void Renderer::setupVBO()
 {
-    glGenBuffers(2, &_buffersVBO[0]);
+    for (auto& buffer : _vertexBuffers)
+    {
+        buffer.vao = 0;
+        glGenBuffers(2, &buffer.vbo[0]);
+    }
 
     mapBuffers();
 }
@@ -246,19 +537,110 @@ void Renderer::mapBuffers()
     // Avoid changing the element buffer for whatever VAO might be bound.
     GL::bindVAO(0);
 
-    glBindBuffer(GL_ARRAY_BUFFER, _buffersVBO[0]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(_verts[0]) * VBO_SIZE, _verts, GL_DYNAMIC_DRAW);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    for (auto& buffer : _vertexBuffers)
+    {
+        buffer.size[0] = sizeof(_verts[0]) * _verts.size();
+        glBindBuffer(GL_ARRAY_BUFFER, buffer.vbo[0]);
+        glBufferData(GL_ARRAY_BUFFER, buffer.size[0], nullptr, GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
 
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _buffersVBO[1]);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(_indices[0]) * INDEX_VBO_SIZE, _indices, GL_STATIC_DRAW);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+        buffer.size[1] = sizeof(_indices[0]) * _indices.size();
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffer.vbo[1]);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, buffer.size[1], nullptr, GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    }
 
     CHECK_GL_ERROR_DEBUG();
 }
 
+void Renderer::deleteBuffers()
+{
+    bool shareableVAO = Configuration::getInstance()->supportsShareableVAO();
+    for (auto& buffer : _vertexBuffers)
+    {
+        glDeleteBuffers(2, buffer.vbo);
+        if (shareableVAO)
+        {
+            glDeleteVertexArrays(1, &buffer.vao);
+        }
+    }
+    if (shareableVAO)
+    {
+        GL::bindVAO(0);
+    }
+    _vertexBuffers.clear();
+}
+
+void Renderer::setMaxBatchSize(ssize_t maxVertices, ssize_t maxIndices)
+{
+    CCASSERT(!_isRendering, "Cannot change the batch size while rendering");
+    CCASSERT(maxVertices > 0 && maxIndices > 0, "Invalid batch size");
+    _maxBatchVertices = maxVertices;
+    _maxBatchIndices = maxIndices;
+}
+
+void Renderer::setVertexBufferCount(int count)
+{
+    CCASSERT(!_isRendering, "Cannot change the vertex buffer count while rendering");
+    count = std::min(std::max(count, 1), (int)MAX_VERTEX_BUFFER_COUNT);
+    if (count == _vertexBufferCount)
+        return;
+
+    _vertexBufferCount = count;
+    if (_glViewAssigned)
+    {
+        deleteBuffers();
+        setupBuffer();
+    }
+}
+
+bool Renderer::reserveBatchSpace(ssize_t vertexCount, ssize_t indexCount)
+{
+    ssize_t maxVertices = _supportsIndices32 ? _maxBatchVertices : std::min(_maxBatchVertices, (ssize_t)VBO_SIZE);
+    ssize_t vertices = _filledVertex + vertexCount;
+    ssize_t indices = _filledIndex + indexCount;
+    if (vertices > maxVertices || indices > _maxBatchIndices)
+        return false;
+
+    if (vertices > (ssize_t)_verts.size())
+    {
+        _verts.resize(std::min(std::max(vertices, (ssize_t)_verts.size() * 2), maxVertices));
+        ++_bufferGrowths;
+    }
+
+    // 16 bit indices can't address more than VBO_SIZE vertices, switch the batch to 32 bit indices
+    if (vertices > VBO_SIZE && !_useIndices32)
+    {
+        _indices32.resize(std::max(_indices32.size(), _indices.size()));
+        std::copy(_indices.begin(), _indices.begin() + _filledIndex, _indices32.begin());
+        _useIndices32 = true;
+    }
+
+    ssize_t indexCapacity = _useIndices32 ? _indices32.size() : _indices.size();
+    if (indices > indexCapacity)
+    {
+        indexCapacity = std::min(std::max(indices, indexCapacity * 2), _maxBatchIndices);
+        if (_useIndices32)
+            _indices32.resize(indexCapacity);
+        else
+            _indices.resize(indexCapacity);
+        ++_bufferGrowths;
+    }
+    return true;
+}
+
 void Renderer::addCommand(RenderCommand* command)
 {
+    if (_recordingInParallel)
+    {
+        auto recording = getCurrentRecording();
+        if (recording)
+        {
+            addCommand(command, recording->groupStack.top());
+            return;
+        }
+    }
+
     int renderQueue =_commandGroupStack.top();
     addCommand(command, renderQueue);
 }
@@ -268,6 +650,17 @@ void Renderer::addCommand(RenderCommand* command, int renderQueue)
     CCASSERT(!_isRendering, "Cannot add command while rendering");
     CCASSERT(renderQueue >=0, "Invalid render queue");
     CCASSERT(command->getType() != RenderCommand::Type::UNKNOWN_COMMAND, "Invalid Command Type");
+
+    if (_recordingInParallel)
+    {
+        auto recording = getCurrentRecording();
+        if (recording)
+        {
+            recording->commands.push_back(std::make_pair(command, renderQueue));
+            return;
+        }
+    }
+
     if (command->isTransparent())
         _transparentRenderGroups.push_back(command);
     else
@@ -277,12 +670,30 @@ void Renderer::addCommand(RenderCommand* command, int renderQueue)
 void Renderer::pushGroup(int renderQueueID)
 {
     CCASSERT(!_isRendering, "Cannot change render queue while rendering");
+    if (_recordingInParallel)
+    {
+        auto recording = getCurrentRecording();
+        if (recording)
+        {
+            recording->groupStack.push(renderQueueID);
+            return;
+        }
+    }
     _commandGroupStack.push(renderQueueID);
 }
 
 void Renderer::popGroup()
 {
     CCASSERT(!_isRendering, "Cannot change render queue while rendering");
+    if (_recordingInParallel)
+    {
+        auto recording = getCurrentRecording();
+        if (recording)
+        {
+            recording->groupStack.pop();
+            return;
+        }
+    }
     _commandGroupStack.pop();
 }
 
@@ -306,12 +717,13 @@ void Renderer::visitRenderQueue(const RenderQueue& queue)
             flush3D();
             auto cmd = static_cast<TrianglesCommand*>(command);
             //Batch quads
-            if( _filledVertex + cmd->getVertexCount() > VBO_SIZE || _filledIndex + cmd->getIndexCount() > INDEX_VBO_SIZE)
+            if(!reserveBatchSpace(cmd->getVertexCount(), cmd->getIndexCount()))
             {
-                CCASSERT(cmd->getVertexCount()>= 0 && cmd->getVertexCount() < VBO_SIZE, "VBO for vertex is not big enough, please break the data down or use customized render command");
-                CCASSERT(cmd->getIndexCount()>= 0 && cmd->getIndexCount() < INDEX_VBO_SIZE, "VBO for index is not big enough, please break the data down or use customized render command");
                 //Draw batched quads if VBO is full
                 drawBatchedQuads();
+                bool fits = reserveBatchSpace(cmd->getVertexCount(), cmd->getIndexCount());
+                CCASSERT(fits, "VBO is not big enough, please break the data down, raise the batch size or use customized render command");
+                CC_UNUSED_PARAM(fits);
             }
             
             _batchedCommands.push_back(cmd);
@@ -374,6 +786,7 @@ void Renderer::visitTransparentRenderQueue(const TransparentRenderQueue& queue)
     _batchedCommands.clear();
     _filledVertex = 0;
     _filledIndex = 0;
+    _useIndices32 = false;
     
     for (ssize_t index = 0; index < size; ++index)
     {
@@ -382,6 +795,11 @@ void Renderer::visitTransparentRenderQueue(const TransparentRenderQueue& queue)
         if(RenderCommand::Type::QUAD_COMMAND == commandType || RenderCommand::Type::TRIANGLES_COMMAND == commandType)
         {
             auto cmd = static_cast<TrianglesCommand*>(command);
+            if(!reserveBatchSpace(cmd->getVertexCount(), cmd->getIndexCount()))
+            {
+                CCLOGERROR("VBO is not big enough, please break the data down, raise the batch size or use customized render command");
+                continue;
+            }
             _batchedCommands.push_back(cmd);
             fillVerticesAndIndices(cmd);
             drawBatchedQuads();
@@ -434,6 +852,12 @@ void Renderer::render()
         {
             renderqueue.sort();
         }
+        if (_batchReorderingEnabled)
+        {
+            // the projection of the camera being rendered is loaded by Director::drawScene
+            const Mat4& projection = Director::getInstance()->getMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_PROJECTION);
+            _savedBatches += _renderGroups[0].batchByMaterial(projection);
+        }
         visitRenderQueue(_renderGroups[0]);
         flush();
         
@@ -468,6 +892,7 @@ void Renderer::clean()
     _batchedCommands.clear();
     _filledVertex = 0;
     _filledIndex = 0;
+    _useIndices32 = false;
     _lastMaterialID = 0;
     _lastBatchedMeshCommand = nullptr;
     
@@ -476,21 +901,28 @@ void Renderer::clean()
 
 void Renderer::fillVerticesAndIndices(const TrianglesCommand* cmd)
 {
-    memcpy(_verts + _filledVertex, cmd->getVertices(), sizeof(V3F_C4B_T2F) * cmd->getVertexCount());
+    std::copy_n(cmd->getVertices(), cmd->getVertexCount(), &_verts[_filledVertex]);
     const Mat4& modelView = cmd->getModelView();
     
-    for(ssize_t i=0; i< cmd->getVertexCount(); ++i)
-    {
-        V3F_C4B_T2F *q = &_verts[i + _filledVertex];
-        Vec3 *vec1 = (Vec3*)&q->vertices;
-        modelView.transformPoint(vec1);
-    }
+    // transform the positions of the whole command in one batch
+    modelView.transformPoints(&cmd->getVertices()->vertices, sizeof(V3F_C4B_T2F),
+                              &_verts[_filledVertex].vertices, sizeof(V3F_C4B_T2F), cmd->getVertexCount());
     
     const unsigned short* indices = cmd->getIndices();
     //fill index
-    for(ssize_t i=0; i< cmd->getIndexCount(); ++i)
+    if (_useIndices32)
     {
-        _indices[_filledIndex + i] = _filledVertex + indices[i];
+        for(ssize_t i=0; i< cmd->getIndexCount(); ++i)
+        {
+            _indices32[_filledIndex + i] = _filledVertex + indices[i];
+        }
+    }
+    else
+    {
+        for(ssize_t i=0; i< cmd->getIndexCount(); ++i)
+        {
+            _indices[_filledIndex + i] = _filledVertex + indices[i];
+        }
     }
     
     _filledVertex += cmd->getVertexCount();
@@ -510,37 +942,26 @@ void Renderer::drawBatchedQuads()
         return;
     }
 
+    // use the buffers in turn, the GPU may still be drawing from the previous ones
+    auto& buffer = _vertexBuffers[_currentVertexBuffer];
+    _currentVertexBuffer = (_currentVertexBuffer + 1) % _vertexBuffers.size();
+
+    GLenum indexType = _useIndices32 ? GL_UNSIGNED_INT : GL_UNSIGNED_SHORT;
+    GLsizeiptr indexSize = _useIndices32 ? sizeof(_indices32[0]) : sizeof(_indices[0]);
+    const GLvoid* indexData = _useIndices32 ? (const GLvoid*)_indices32.data() : (const GLvoid*)_indices.data();
+
     if (Configuration::getInstance()->supportsShareableVAO())
     {
         //Bind VAO
-        GL::bindVAO(_quadVAO);
-        //Set VBO data
-        glBindBuffer(GL_ARRAY_BUFFER, _buffersVBO[0]);
-
-        // option 1: subdata
-//        glBufferSubData(GL_ARRAY_BUFFER, sizeof(_quads[0])*start, sizeof(_quads[0]) * n , &_quads[start] );
-
-        // option 2: data
-//        glBufferData(GL_ARRAY_BUFFER, sizeof(quads_[0]) * (n-start), &quads_[start], GL_DYNAMIC_DRAW);
-
-        // option 3: orphaning + glMapBuffer
-        glBufferData(GL_ARRAY_BUFFER, sizeof(_verts[0]) * _filledVertex, nullptr, GL_DYNAMIC_DRAW);
-        void *buf = glMapBuffer(GL_ARRAY_BUFFER, GL_WRITE_ONLY);
-        memcpy(buf, _verts, sizeof(_verts[0])* _filledVertex);
-        glUnmapBuffer(GL_ARRAY_BUFFER);
-
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
-        
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _buffersVBO[1]);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(_indices[0]) * _filledIndex, _indices, GL_STATIC_DRAW);
+        GL::bindVAO(buffer.vao);
     }
-    else
+    //Set VBO data
+    glBindBuffer(GL_ARRAY_BUFFER, buffer.vbo[0]);
+    uploadBuffer(GL_ARRAY_BUFFER, sizeof(_verts[0]) * _filledVertex, sizeof(_verts[0]) * _verts.size(), _verts.data(), buffer.size[0]);
+
+    if (!Configuration::getInstance()->supportsShareableVAO())
     {
 #define kQuadSize sizeof(_verts[0])
-        glBindBuffer(GL_ARRAY_BUFFER, _buffersVBO[0]);
-
-        glBufferData(GL_ARRAY_BUFFER, sizeof(_verts[0]) * _filledVertex , _verts, GL_DYNAMIC_DRAW);
-
         GL::enableVertexAttribs(GL::VERTEX_ATTRIB_FLAG_POS_COLOR_TEX);
 
         // vertices
@@ -551,11 +972,21 @@ void Renderer::drawBatchedQuads()
 
         // tex coords
         glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_TEX_COORD, 2, GL_FLOAT, GL_FALSE, kQuadSize, (GLvoid*) offsetof(V3F_C4B_T2F, texCoords));
-
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _buffersVBO[1]);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(_indices[0]) * _filledIndex, _indices, GL_STATIC_DRAW);
+    }
+    else
+    {
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
     }
 
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffer.vbo[1]);
+    size_t indexCapacity = _useIndices32 ? _indices32.size() : _indices.size();
+    uploadBuffer(GL_ELEMENT_ARRAY_BUFFER, indexSize * _filledIndex, indexSize * indexCapacity, indexData, buffer.size[1]);
+
+    _uploadedBytes += sizeof(_verts[0]) * _filledVertex + indexSize * _filledIndex;
+    ++_bufferUploads;
+    _peakBatchVertices = std::max(_peakBatchVertices, (ssize_t)_filledVertex);
+    _peakBatchIndices = std::max(_peakBatchIndices, (ssize_t)_filledIndex);
+
     //Start drawing verties in batch
     for(const auto& cmd : _batchedCommands)
     {
@@ -565,7 +996,7 @@ void Renderer::drawBatchedQuads()
             //Draw quads
             if(indexToDraw > 0)
             {
-                glDrawElements(GL_TRIANGLES, (GLsizei) indexToDraw, GL_UNSIGNED_SHORT, (GLvoid*) (startIndex*sizeof(_indices[0])) );
+                glDrawElements(GL_TRIANGLES, (GLsizei) indexToDraw, indexType, (GLvoid*) (startIndex*indexSize) );
                 _drawnBatches++;
                 _drawnVertices += indexToDraw;
 
@@ -584,7 +1015,7 @@ void Renderer::drawBatchedQuads()
     //Draw any remaining quad
     if(indexToDraw > 0)
     {
-        glDrawElements(GL_TRIANGLES, (GLsizei) indexToDraw, GL_UNSIGNED_SHORT, (GLvoid*) (startIndex*sizeof(_indices[0])) );
+        glDrawElements(GL_TRIANGLES, (GLsizei) indexToDraw, indexType, (GLvoid*) (startIndex*indexSize) );
         _drawnBatches++;
         _drawnVertices += indexToDraw;
     }
@@ -603,6 +1034,7 @@ void Renderer::drawBatchedQuads()
     _batchedCommands.clear();
     _filledVertex = 0;
     _filledIndex = 0;
+    _useIndices32 = false;
 }
 
 void Renderer::flush()
@@ -626,6 +1058,90 @@ void Renderer::flush3D()
     }
 }
 
+// parallel recording
+
+CommandRecording* Renderer::getCurrentRecording() const
+{
+    if (!_recordingJobSystem)
+        return nullptr;
+    return _recordingSlots[_recordingJobSystem->getThreadIndex()];
+}
+
+std::stack<Mat4>* Renderer::getRecordingMatrixStacks() const
+{
+    if (_recordingInParallel)
+    {
+        auto recording = getCurrentRecording();
+        if (recording)
+            return recording->matrixStacks;
+    }
+    return nullptr;
+}
+
+void Renderer::recordInParallel(ssize_t count, const std::function<void(ssize_t)>& task)
+{
+    JobSystem* jobSystem = _parallelRecordingEnabled ? Director::getInstance()->getJobSystem() : nullptr;
+    // nested calls come from a recording task, their commands already go to its recording
+    if (!jobSystem || count < 2 || _recordingInParallel)
+    {
+        for (ssize_t i = 0; i < count; ++i)
+            task(i);
+        return;
+    }
+
+    // every task starts from the state a serial visit would have at this point
+    if (static_cast<ssize_t>(_recordings.size()) < count)
+        _recordings.resize(count);
+
+    auto director = Director::getInstance();
+    Mat4 matrices[3] = {
+        director->getMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW),
+        director->getMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_PROJECTION),
+        director->getMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_TEXTURE)
+    };
+    int renderQueue = _commandGroupStack.top();
+
+    for (ssize_t i = 0; i < count; ++i)
+    {
+        auto& recording = _recordings[i];
+        recording.commands.clear();
+        recording.groupStack = std::stack<int>();
+        recording.groupStack.push(renderQueue);
+        for (int j = 0; j < 3; ++j)
+        {
+            recording.matrixStacks[j] = std::stack<Mat4>();
+            recording.matrixStacks[j].push(matrices[j]);
+        }
+    }
+
+    _recordingJobSystem = jobSystem;
+    _recordingSlots.assign(jobSystem->getWorkerCount() + 1, nullptr);
+    _recordingInParallel = true;
+
+    jobSystem->parallelFor(count, 1, [this, &task](size_t begin, size_t end) {
+        CommandRecording*& current = _recordingSlots[_recordingJobSystem->getThreadIndex()];
+        for (size_t i = begin; i < end; ++i)
+        {
+            // a thread waiting for jobs inside a task may run another task, which must not take over its recording
+            CommandRecording* previous = current;
+            current = &_recordings[i];
+            task(i);
+            current = previous;
+        }
+    });
+
+    _recordingInParallel = false;
+
+    // merge in task order
+    for (ssize_t i = 0; i < count; ++i)
+    {
+        for (const auto& recorded : _recordings[i].commands)
+        {
+            addCommand(recorded.first, recorded.second);
+        }
+    }
+}
+
 // helpers
 
 bool Renderer::checkVisibility(const Mat4 &transform, const Size &size)
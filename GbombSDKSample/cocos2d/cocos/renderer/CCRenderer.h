@@ -28,6 +28,8 @@
 
 #include <vector>
 #include <stack>
+#include <atomic>
+#include <functional>
 
 #include "platform/CCPlatformMacros.h"
 #include "renderer/CCRenderCommand.h"
@@ -37,14 +39,35 @@
 NS_CC_BEGIN
 
 class EventListenerCustom;
+class JobSystem;
 class QuadCommand;
 class TrianglesCommand;
 class MeshCommand;
 
+/** Entry used to radix sort `RenderCommand` objects by global order */
+struct RenderSortEntry
+{
+    uint32_t key;
+    RenderCommand* command;
+};
+
+/** Screen space bounds of the commands drawn in one batch, used to reorder `TrianglesCommand` objects by material */
+struct RenderBatchBounds
+{
+    uint32_t materialID;
+    uint32_t commandCount;
+    float minX;
+    float minY;
+    float maxX;
+    float maxY;
+};
+
 /** Class that knows how to sort `RenderCommand` objects.
  Since the commands that have `z == 0` are "pushed back" in
  the correct order, the only `RenderCommand` objects that need to be sorted,
  are the ones that have `z < 0` and `z > 0`.
+ The sort is stable, it is skipped when the commands are already in order,
+ and big queues are radix sorted.
 */
 class RenderQueue {
 
@@ -55,10 +78,18 @@ public:
     RenderCommand* operator[](ssize_t index) const;
     void clear();
 
+    /** Moves quads and triangles that share a global order next to the earlier commands with the same material,
+     as long as they don't overlap on screen any command they are moved ahead of. The output looks the same.
+     `projection` is the matrix the commands are drawn with. Returns the number of batches saved.
+     */
+    ssize_t batchByMaterial(const Mat4& projection);
+
 protected:
     std::vector<RenderCommand*> _queueNegZ;
     std::vector<RenderCommand*> _queue0;
     std::vector<RenderCommand*> _queuePosZ;
+    std::vector<RenderSortEntry> _sortBuffer;
+    std::vector<RenderBatchBounds> _batchBuffer;
 };
 
 //render queue for transparency object, NOTE that the _globalOrder of RenderCommand is the distance to the camera when added to the transparent queue
@@ -75,6 +106,7 @@ public:
     
 protected:
     std::vector<RenderCommand*> _queueCmd;
+    std::vector<RenderSortEntry> _sortBuffer;
 };
 
 struct RenderStackElement
@@ -83,6 +115,19 @@ struct RenderStackElement
     ssize_t currentIndex;
 };
 
+/** Commands added by one task of `Renderer::recordInParallel`.
+ Each recording has its own group stack and its own copy of the Director matrix stacks,
+ so the task doesn't touch any state shared with the other threads recording.
+ */
+struct CommandRecording
+{
+    // command and the ID of the render queue it was added to
+    std::vector<std::pair<RenderCommand*, int>> commands;
+    std::stack<int> groupStack;
+    // modelview, projection and texture, in MATRIX_STACK_TYPE order
+    std::stack<Mat4> matrixStacks[3];
+};
+
 class GroupCommandManager;
 
 /* Class responsible for the rendering in.
@@ -94,6 +139,12 @@ class CC_DLL Renderer
 public:
     static const int VBO_SIZE = 65536;
     static const int INDEX_VBO_SIZE = VBO_SIZE * 6 / 4;
+    /** The batch buffers start with room for this many vertices and grow on demand */
+    static const int INITIAL_VBO_SIZE = 4096;
+    /** Default limit of the batch buffers. Past VBO_SIZE vertices a batch needs 32 bit indices, without them the limit is VBO_SIZE */
+    static const int MAX_VBO_SIZE = VBO_SIZE * 4;
+    static const int MAX_INDEX_VBO_SIZE = MAX_VBO_SIZE * 6 / 4;
+    static const int MAX_VERTEX_BUFFER_COUNT = 4;
     
     static const int BATCH_QUADCOMMAND_RESEVER_SIZE = 64;
 
@@ -132,14 +183,70 @@ public:
     ssize_t getDrawnVertices() const { return _drawnVertices; }
     /* RenderCommands (except) QuadCommand should update this value */
     void addDrawnVertices(ssize_t number) { _drawnVertices += number; };
+    /* returns the number of batches saved by batch reordering in the last frame */
+    ssize_t getSavedBatches() const { return _savedBatches; }
     /* clear draw stats */
-    void clearDrawStats() { _drawnBatches = _drawnVertices = 0; }
+    void clearDrawStats() { _drawnBatches = _drawnVertices = _savedBatches = _uploadedBytes = _bufferUploads = 0; }
+
+    /** Sets the largest batch of quads and triangles, in vertices and indices, drawn at once. Default MAX_VBO_SIZE and MAX_INDEX_VBO_SIZE.
+     Batches of more than VBO_SIZE vertices are drawn with 32 bit indices, the limit is VBO_SIZE if the GPU doesn't support them.
+     The buffers start small and grow up to the limit only when a batch needs it, so a high limit costs no memory
+     to the scenes that don't batch that much. Lower it to cap the memory of the buffers.
+     */
+    void setMaxBatchSize(ssize_t maxVertices, ssize_t maxIndices);
+    ssize_t getMaxBatchVertices() const { return _maxBatchVertices; }
+    ssize_t getMaxBatchIndices() const { return _maxBatchIndices; }
+
+    /** Sets how many vertex and index buffer pairs are used in turn, so a buffer is not written again while the GPU may still draw from it.
+     2 is double buffering, 3 triple buffering, the default.
+     */
+    void setVertexBufferCount(int count);
+    int getVertexBufferCount() const { return _vertexBufferCount; }
+
+    /* returns the bytes uploaded to the vertex and index buffers in the last frame */
+    ssize_t getUploadedBytes() const { return _uploadedBytes; }
+    /* returns the number of batch uploads in the last frame */
+    ssize_t getBufferUploads() const { return _bufferUploads; }
+    /* returns the most vertices drawn in one batch since the upload stats were reset */
+    ssize_t getPeakBatchVertices() const { return _peakBatchVertices; }
+    /* returns the most indices drawn in one batch since the upload stats were reset */
+    ssize_t getPeakBatchIndices() const { return _peakBatchIndices; }
+    /* returns how many times the batch buffers grew since the upload stats were reset */
+    ssize_t getBufferGrowths() const { return _bufferGrowths; }
+    /* clear peak and growth stats, per frame stats are cleared by clearDrawStats */
+    void resetUploadStats() { _peakBatchVertices = _peakBatchIndices = _bufferGrowths = 0; }
+
+    /** Enables reordering quads and triangles of the same global order by material, so more of them are drawn in one batch.
+     A command is only moved ahead of commands it doesn't overlap on screen. It is off by default.
+     Only the default render queue is reordered, `RenderTexture` and `ClippingNode` contents keep their order.
+     */
+    void setBatchReorderingEnabled(bool enabled) { _batchReorderingEnabled = enabled; }
+    bool isBatchReorderingEnabled() const { return _batchReorderingEnabled; }
 
     inline GroupCommandManager* getGroupCommandManager() const { return _groupCommandManager; };
 
     /** returns whether or not a rectangle is visible or not */
     bool checkVisibility(const Mat4& transform, const Size& size);
 
+    /** Lets `recordInParallel` run its tasks on the workers of `Director::getJobSystem()`.
+     Disabled by default, every command is then added on the calling thread.
+     */
+    void setParallelRecordingEnabled(bool enabled) { _parallelRecordingEnabled = enabled; }
+    bool isParallelRecordingEnabled() const { return _parallelRecordingEnabled; }
+
+    /** Runs task(0) ... task(count - 1) on the workers of the job system and on the calling thread.
+     Commands added by each task are recorded in a list of its own, and the lists are merged into the
+     render queues in task order when all the tasks are done. The result is the same as running the tasks in order.
+     Nested calls, and calls while parallel recording is disabled, run the tasks in order on the calling thread.
+     */
+    void recordInParallel(ssize_t count, const std::function<void(ssize_t)>& task);
+
+    /** Returns whether the calling thread is running a task of `recordInParallel` */
+    bool isRecordingInParallel() const { return _recordingInParallel && getCurrentRecording() != nullptr; }
+
+    /** Returns the matrix stacks the Director should use on the calling thread, nullptr if it is not recording in parallel */
+    std::stack<Mat4>* getRecordingMatrixStacks() const;
+
 protected:
 
     //Setup VBO or VAO based on OpenGL extensions
@@ -147,6 +254,10 @@ protected:
     void setupVBOAndVAO();
     void setupVBO();
     void mapBuffers();
+    void deleteBuffers();
+
+    // grows the batch buffers if needed, false if the command doesn't fit in the current batch
+    bool reserveBatchSpace(ssize_t vertexCount, ssize_t indexCount);
 
     void drawBatchedQuads();
 
@@ -163,6 +274,8 @@ protected:
 
     void fillVerticesAndIndices(const TrianglesCommand* cmd);
 
+    CommandRecording* getCurrentRecording() const;
+
     std::stack<int> _commandGroupStack;
     
     std::vector<RenderQueue> _renderGroups;
@@ -173,10 +286,25 @@ protected:
     MeshCommand*              _lastBatchedMeshCommand;
     std::vector<TrianglesCommand*> _batchedCommands;
 
-    V3F_C4B_T2F _verts[VBO_SIZE];
-    GLushort _indices[INDEX_VBO_SIZE];
-    GLuint _quadVAO;
-    GLuint _buffersVBO[2]; //0: vertex  1: indices
+    std::vector<V3F_C4B_T2F> _verts;
+    std::vector<GLushort> _indices;
+    // used instead of _indices by a batch of more than VBO_SIZE vertices
+    std::vector<GLuint> _indices32;
+    bool _useIndices32;
+    bool _supportsIndices32;
+    ssize_t _maxBatchVertices;
+    ssize_t _maxBatchIndices;
+
+    struct VertexBuffer
+    {
+        GLuint vao;
+        GLuint vbo[2]; //0: vertex  1: indices
+        // bytes allocated for each vbo
+        GLsizeiptr size[2];
+    };
+    std::vector<VertexBuffer> _vertexBuffers;
+    int _vertexBufferCount;
+    int _currentVertexBuffer;
 
     int _filledVertex;
     int _filledIndex;
@@ -186,6 +314,13 @@ protected:
     // stats
     ssize_t _drawnBatches;
     ssize_t _drawnVertices;
+    ssize_t _savedBatches;
+    ssize_t _uploadedBytes;
+    ssize_t _bufferUploads;
+    ssize_t _peakBatchVertices;
+    ssize_t _peakBatchIndices;
+    ssize_t _bufferGrowths;
+    bool _batchReorderingEnabled;
     //the flag for checking whether renderer is rendering
     bool _isRendering;
     
@@ -194,6 +329,14 @@ protected:
 #if CC_ENABLE_CACHE_TEXTURE_DATA
     EventListenerCustom* _cacheTextureListener;
 #endif
+
+    // parallel recording
+    bool _parallelRecordingEnabled;
+    JobSystem* _recordingJobSystem;
+    // the recording of each thread of _recordingJobSystem, indexed by JobSystem::getThreadIndex()
+    std::vector<CommandRecording*> _recordingSlots;
+    std::vector<CommandRecording> _recordings;
+    std::atomic<bool> _recordingInParallel;
 };
 
 NS_CC_END
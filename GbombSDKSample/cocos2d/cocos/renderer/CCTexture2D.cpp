@@ -545,6 +545,27 @@ bool Texture2D::initWithData(const void *data, ssize_t dataLen, Texture2D::Pixel
     return initWithMipmaps(&mipmap, 1, pixelFormat, pixelsWide, pixelsHigh);
 }
 
+// rows of uncompressed data are tightly packed
+static void setUnpackAlignment(unsigned int bytesPerRow)
+{
+    if(bytesPerRow % 8 == 0)
+    {
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 8);
+    }
+    else if(bytesPerRow % 4 == 0)
+    {
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    }
+    else if(bytesPerRow % 2 == 0)
+    {
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 2);
+    }
+    else
+    {
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    }
+}
+
 bool Texture2D::initWithMipmaps(MipmapInfo* mipmaps, int mipmapsNum, PixelFormat pixelFormat, int pixelsWide, int pixelsHigh)
 {
 
@@ -580,24 +601,7 @@ bool Texture2D::initWithMipmaps(MipmapInfo* mipmaps, int mipmapsNum, PixelFormat
     //Set the row align only when mipmapsNum == 1 and the data is uncompressed
     if (mipmapsNum == 1 && !info.compressed)
     {
-        unsigned int bytesPerRow = pixelsWide * info.bpp / 8;
-
-        if(bytesPerRow % 8 == 0)
-        {
-            glPixelStorei(GL_UNPACK_ALIGNMENT, 8);
-        }
-        else if(bytesPerRow % 4 == 0)
-        {
-            glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
-        }
-        else if(bytesPerRow % 2 == 0)
-        {
-            glPixelStorei(GL_UNPACK_ALIGNMENT, 2);
-        }
-        else
-        {
-            glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-        }
+        setUnpackAlignment(pixelsWide * info.bpp / 8);
     }else
     {
         glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
@@ -694,6 +698,11 @@ bool Texture2D::updateWithData(const void *data,int offsetX,int offsetY,int widt
     {
         GL::bindTexture2D(_name);
         const PixelFormatInfo& info = _pixelFormatInfoTables.at(_pixelFormat);
+        if (!info.compressed)
+        {
+            // another texture may have changed it since this one was created
+            setUnpackAlignment(width * info.bpp / 8);
+        }
         glTexSubImage2D(GL_TEXTURE_2D,0,offsetX,offsetY,width,height,info.format, info.type,data);
 
         return true;
@@ -1035,6 +1044,36 @@ Texture2D::PixelFormat Texture2D::convertDataToFormat(const unsigned char* data,
     }
 }
 
+Texture2D::PixelFormat Texture2D::convertImageData(Image *image, PixelFormat format, unsigned char** outData, ssize_t* outDataLen)
+{
+    CCASSERT(image->getNumberOfMipmaps() <= 1 && !image->isCompressed(), "Only uncompressed images without mipmaps can be converted");
+
+    PixelFormat renderFormat = image->getRenderFormat();
+    PixelFormat pixelFormat = ((PixelFormat::NONE == format) || (PixelFormat::AUTO == format)) ? renderFormat : format;
+    return convertDataToFormat(image->getData(), image->getDataLen(), renderFormat, pixelFormat, outData, outDataLen);
+}
+
+bool Texture2D::initWithImageData(Image *image, const unsigned char* data, ssize_t dataLen, PixelFormat format, bool upload)
+{
+    int imageWidth = image->getWidth();
+    int imageHeight = image->getHeight();
+
+    int maxTextureSize = Configuration::getInstance()->getMaxTextureSize();
+    if (imageWidth > maxTextureSize || imageHeight > maxTextureSize)
+    {
+        CCLOG("cocos2d: WARNING: Image (%u x %u) is bigger than the supported %u x %u", imageWidth, imageHeight, maxTextureSize, maxTextureSize);
+        return false;
+    }
+
+    // glTexImage2D allocates the storage when there is no data
+    bool ret = initWithData(upload ? data : nullptr, dataLen, format, imageWidth, imageHeight, Size((float)imageWidth, (float)imageHeight));
+
+    // set the premultiplied tag
+    _hasPremultipliedAlpha = image->hasPremultipliedAlpha();
+
+    return ret;
+}
+
 // implementation Texture2D (Text)
 bool Texture2D::initWithString(const char *text, const std::string& fontName, float fontSize, const Size& dimensions/* = Size(0, 0)*/, TextHAlignment hAlignment/* =  TextHAlignment::CENTER */, TextVAlignment vAlignment/* =  TextVAlignment::TOP */)
 {
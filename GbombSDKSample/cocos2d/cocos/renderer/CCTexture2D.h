@@ -247,6 +247,20 @@ public:
     **/
     bool initWithImage(Image * image, PixelFormat format);
 
+    /** Converts the data of an uncompressed image without mipmaps to the pixel format initWithImage(image, format) would upload.
+     It doesn't use OpenGL, so it may be called on a loading thread. Returns the format of outData.
+     If outData is not the image data, it must be freed with free().
+     @since v3.3
+     */
+    static PixelFormat convertImageData(Image * image, PixelFormat format, unsigned char** outData, ssize_t* outDataLen);
+
+    /** Initializes a texture from an image and the data convertImageData returned for it.
+     If upload is false, only the texture storage is allocated and the pixels are uploaded later with updateWithData,
+     for instance a band of rows per frame.
+     @since v3.3
+     */
+    bool initWithImageData(Image * image, const unsigned char* data, ssize_t dataLen, PixelFormat format, bool upload);
+
     /** Initializes a texture from a string with dimensions, alignment, font name and font size */
     bool initWithString(const char *text,  const std::string &fontName, float fontSize, const Size& dimensions = Size(0, 0), TextHAlignment hAlignment = TextHAlignment::CENTER, TextVAlignment vAlignment = TextVAlignment::TOP);
     /** Initializes a texture from a string using a text definition*/
@@ -31,6 +31,8 @@ THE SOFTWARE.
 #include <stack>
 #include <cctype>
 #include <list>
+#include <algorithm>
+#include <chrono>
 
 #include "renderer/CCTexture2D.h"
 #include "base/ccMacros.h"
@@ -58,13 +60,33 @@ TextureCache * TextureCache::getInstance()
     return Director::getInstance()->getTextureCache();
 }
 
+// heap order of the requests waiting for a loading thread, higher priority first, then first come first served
+static bool compareAsyncStruct(const TextureCache::AsyncStruct* a, const TextureCache::AsyncStruct* b)
+{
+    if (a->priority != b->priority)
+        return a->priority < b->priority;
+    return a->sequence > b->sequence;
+}
+
+static int defaultLoadingThreadCount()
+{
+    // leave a core to the main thread
+    int cores = (int)std::thread::hardware_concurrency();
+    return std::max(1, std::min(4, cores - 1));
+}
+
 TextureCache::TextureCache()
-: _loadingThread(nullptr)
-, _asyncStructQueue(nullptr)
-, _imageInfoQueue(nullptr)
+: _loadingThreadCount(defaultLoadingThreadCount())
+, _asyncSequence(0)
 , _needQuit(false)
 , _asyncRefCount(0)
+, _asyncUploadBudget(4)
+, _asyncUploadByteBudget(2 * 1024 * 1024)
+, _uploadingImageInfo(nullptr)
+, _uploadingTexture(nullptr)
+, _uploadedRows(0)
 {
+    resetAsyncUploadStats();
 }
 
 TextureCache::~TextureCache()
@@ -74,7 +96,22 @@ TextureCache::~TextureCache()
     for( auto it=_textures.begin(); it!=_textures.end(); ++it)
         (it->second)->release();
 
-    CC_SAFE_DELETE(_loadingThread);
+    stopLoadingThreads();
+
+    // the loading threads are stopped, every request left is either waiting, decoded or being uploaded
+    for (auto asyncStruct : _asyncStructQueue)
+        delete asyncStruct;
+    for (auto imageInfo : _imageInfoQueue)
+    {
+        delete imageInfo->asyncStruct;
+        releaseImageInfo(imageInfo);
+    }
+    if (_uploadingImageInfo)
+    {
+        delete _uploadingImageInfo->asyncStruct;
+        releaseImageInfo(_uploadingImageInfo);
+    }
+    CC_SAFE_RELEASE(_uploadingTexture);
 }
 
 void TextureCache::destroyInstance()
@@ -96,6 +133,11 @@ std::string TextureCache::getDescription() const
 }
 
 void TextureCache::addImageAsync(const std::string &path, const std::function<void(Texture2D*)>& callback)
+{
+    addImageAsync(path, callback, 0);
+}
+
+void TextureCache::addImageAsync(const std::string &path, const std::function<void(Texture2D*)>& callback, int priority)
 {
     Texture2D *texture = nullptr;
 
@@ -111,16 +153,25 @@ void TextureCache::addImageAsync(const std::string &path, const std::function<vo
         return;
     }
 
-    // lazy init
-    if (_asyncStructQueue == nullptr)
-    {             
-        _asyncStructQueue = new queue<AsyncStruct*>();
-        _imageInfoQueue   = new deque<ImageInfo*>();        
-
-        // create a new thread to load images
-        _loadingThread = new std::thread(&TextureCache::loadImage, this);
+    // the file is already being loaded, wait for the same image
+    auto found = _asyncStructs.find(fullpath);
+    if (found != _asyncStructs.end())
+    {
+        AsyncStruct *data = found->second;
+        data->callbacks.push_back(callback);
+        if (priority > data->priority)
+        {
+            std::lock_guard<std::mutex> lock(_asyncStructQueueMutex);
+            data->priority = priority;
+            std::make_heap(_asyncStructQueue.begin(), _asyncStructQueue.end(), compareAsyncStruct);
+        }
+        return;
+    }
 
-        _needQuit = false;
+    // lazy init
+    if (_loadingThreads.empty())
+    {
+        startLoadingThreads();
     }
 
     if (0 == _asyncRefCount)
@@ -131,11 +182,13 @@ void TextureCache::addImageAsync(const std::string &path, const std::function<vo
     ++_asyncRefCount;
 
     // generate async struct
-    AsyncStruct *data = new (std::nothrow) AsyncStruct(fullpath, callback);
+    AsyncStruct *data = new (std::nothrow) AsyncStruct(fullpath, callback, priority, _asyncSequence++);
+    _asyncStructs[fullpath] = data;
 
     // add async struct into queue
     _asyncStructQueueMutex.lock();
-    _asyncStructQueue->push(data);
+    _asyncStructQueue.push_back(data);
+    std::push_heap(_asyncStructQueue.begin(), _asyncStructQueue.end(), compareAsyncStruct);
     _asyncStructQueueMutex.unlock();
 
     _sleepCondition.notify_one();
@@ -143,174 +196,376 @@ void TextureCache::addImageAsync(const std::string &path, const std::function<vo
 
 void TextureCache::unbindImageAsync(const std::string& filename)
 {
-    _imageInfoMutex.lock();
-    if (_imageInfoQueue && !_imageInfoQueue->empty())
+    std::string fullpath = FileUtils::getInstance()->fullPathForFilename(filename);
+    auto found = _asyncStructs.find(fullpath);
+    if (found != _asyncStructs.end())
     {
-        std::string fullpath = FileUtils::getInstance()->fullPathForFilename(filename);
-        auto found = std::find_if(_imageInfoQueue->begin(), _imageInfoQueue->end(), [&fullpath](ImageInfo* ptr)->bool{ return ptr->asyncStruct->filename == fullpath; });
-        if (found != _imageInfoQueue->end())
-        {
-            (*found)->asyncStruct->callback = nullptr;
-        }
+        found->second->callbacks.clear();
     }
-    _imageInfoMutex.unlock();
 }
 
 void TextureCache::unbindAllImageAsync()
 {
-    _imageInfoMutex.lock();
-    if (_imageInfoQueue && !_imageInfoQueue->empty())
+    for (auto& pair : _asyncStructs)
     {
-        std::for_each(_imageInfoQueue->begin(), _imageInfoQueue->end(), [](ImageInfo* ptr) { ptr->asyncStruct->callback = nullptr; });
+        pair.second->callbacks.clear();
     }
-    _imageInfoMutex.unlock();
 }
 
-void TextureCache::loadImage()
+bool TextureCache::cancelImageAsync(const std::string& filename)
+{
+    std::string fullpath = FileUtils::getInstance()->fullPathForFilename(filename);
+    auto found = _asyncStructs.find(fullpath);
+    if (found == _asyncStructs.end())
+    {
+        return false;
+    }
+
+    AsyncStruct *asyncStruct = found->second;
+    _asyncStructs.erase(found);
+    asyncStruct->cancelled = true;
+    asyncStruct->callbacks.clear();
+
+    // a request that is being decoded, or is decoded, is dropped by addImageAsyncCallBack
+    bool waiting = false;
+    _asyncStructQueueMutex.lock();
+    auto it = std::find(_asyncStructQueue.begin(), _asyncStructQueue.end(), asyncStruct);
+    if (it != _asyncStructQueue.end())
+    {
+        _asyncStructQueue.erase(it);
+        std::make_heap(_asyncStructQueue.begin(), _asyncStructQueue.end(), compareAsyncStruct);
+        waiting = true;
+    }
+    _asyncStructQueueMutex.unlock();
+
+    if (waiting)
+    {
+        finishImageAsync(asyncStruct);
+    }
+    return true;
+}
+
+void TextureCache::setLoadingThreadCount(int count)
+{
+    count = std::max(1, count);
+    if (count == _loadingThreadCount)
+    {
+        return;
+    }
+
+    _loadingThreadCount = count;
+    // waiting requests stay in the queue for the new threads
+    if (!_loadingThreads.empty())
+    {
+        stopLoadingThreads();
+        startLoadingThreads();
+    }
+}
+
+void TextureCache::startLoadingThreads()
 {
-    AsyncStruct *asyncStruct = nullptr;
+    _needQuit = false;
+    for (int i = 0; i < _loadingThreadCount; ++i)
+    {
+        _loadingThreads.push_back(std::thread(&TextureCache::loadImage, this));
+    }
+}
 
+void TextureCache::stopLoadingThreads()
+{
+    _asyncStructQueueMutex.lock();
+    _needQuit = true;
+    _asyncStructQueueMutex.unlock();
+    _sleepCondition.notify_all();
+
+    for (auto& thread : _loadingThreads)
+    {
+        thread.join();
+    }
+    _loadingThreads.clear();
+}
+
+void TextureCache::loadImage()
+{
     while (true)
     {
-        std::queue<AsyncStruct*> *pQueue = _asyncStructQueue;
-        _asyncStructQueueMutex.lock();
-        if (pQueue->empty())
+        AsyncStruct *asyncStruct = nullptr;
         {
-            _asyncStructQueueMutex.unlock();
-            if (_needQuit) {
+            std::unique_lock<std::mutex> lock(_asyncStructQueueMutex);
+            _sleepCondition.wait(lock, [this]{ return _needQuit || !_asyncStructQueue.empty(); });
+            if (_needQuit)
+            {
                 break;
             }
-            else {
-                std::unique_lock<std::mutex> lk(_sleepMutex);
-                _sleepCondition.wait(lk);
-                continue;
-            }
+            std::pop_heap(_asyncStructQueue.begin(), _asyncStructQueue.end(), compareAsyncStruct);
+            asyncStruct = _asyncStructQueue.back();
+            _asyncStructQueue.pop_back();
         }
-        else
-        {
-            asyncStruct = pQueue->front();
-            pQueue->pop();
-            _asyncStructQueueMutex.unlock();
-        }        
-
-        Image *image = nullptr;
-        bool generateImage = false;
 
-        auto it = _textures.find(asyncStruct->filename);
-        if( it == _textures.end() )
+        // generate image
+        const std::string& filename = asyncStruct->filename;
+        Image *image = new (std::nothrow) Image();
+        if (image && !image->initWithImageFileThreadSafe(filename))
         {
-           _imageInfoMutex.lock();
-           ImageInfo *imageInfo;
-           size_t pos = 0;
-           size_t infoSize = _imageInfoQueue->size();
-           for (; pos < infoSize; pos++)
-           {
-               imageInfo = (*_imageInfoQueue)[pos];
-               if(imageInfo->asyncStruct->filename.compare(asyncStruct->filename) == 0)
-                   break;
-           }
-           _imageInfoMutex.unlock();
-           if(infoSize == 0 || pos == infoSize)
-               generateImage = true;
+            CC_SAFE_RELEASE_NULL(image);
+            CCLOG("can not load %s", filename.c_str());
         }
 
-        if (generateImage)
-        {
-            const std::string& filename = asyncStruct->filename;
-            // generate image      
-            image = new (std::nothrow) Image();
-            if (image && !image->initWithImageFileThreadSafe(filename))
-            {
-                CC_SAFE_RELEASE(image);
-                CCLOG("can not load %s", filename.c_str());
-                continue;
-            }
-        }    
-
         // generate image info
         ImageInfo *imageInfo = new (std::nothrow) ImageInfo();
         imageInfo->asyncStruct = asyncStruct;
         imageInfo->image = image;
+        imageInfo->data = nullptr;
+        imageInfo->dataLen = 0;
+        imageInfo->pixelFormat = asyncStruct->pixelFormat;
+
+        // convert the pixels here rather than on the main thread
+        if (image && image->getNumberOfMipmaps() <= 1 && !image->isCompressed())
+        {
+            imageInfo->pixelFormat = Texture2D::convertImageData(image, asyncStruct->pixelFormat, &imageInfo->data, &imageInfo->dataLen);
+        }
 
         // put the image info into the queue
         _imageInfoMutex.lock();
-        _imageInfoQueue->push_back(imageInfo);
+        _imageInfoQueue.push_back(imageInfo);
         _imageInfoMutex.unlock();
     }
-    
-	if(_asyncStructQueue != nullptr)
+}
+
+void TextureCache::finishImageAsync(AsyncStruct* asyncStruct)
+{
+    auto found = _asyncStructs.find(asyncStruct->filename);
+    if (found != _asyncStructs.end() && found->second == asyncStruct)
     {
-        delete _asyncStructQueue;
-	    _asyncStructQueue = nullptr;
-        delete _imageInfoQueue;
-	    _imageInfoQueue = nullptr;
+        _asyncStructs.erase(found);
+    }
+    delete asyncStruct;
+
+    --_asyncRefCount;
+    if (0 == _asyncRefCount)
+    {
+        Director::getInstance()->getScheduler()->unschedule(schedule_selector(TextureCache::addImageAsyncCallBack), this);
     }
 }
 
-void TextureCache::addImageAsyncCallBack(float dt)
+void TextureCache::releaseImageInfo(ImageInfo* imageInfo)
+{
+    if (imageInfo->image && imageInfo->data && imageInfo->data != imageInfo->image->getData())
+    {
+        free(imageInfo->data);
+    }
+    CC_SAFE_RELEASE(imageInfo->image);
+    delete imageInfo;
+}
+
+static void addToHistogram(unsigned int* histogram, float milliseconds)
+{
+    int bucket = 0;
+    float limit = 0.25f;
+    while (bucket < TextureCache::AsyncUploadStats::HISTOGRAM_SIZE - 1 && milliseconds >= limit)
+    {
+        ++bucket;
+        limit *= 2;
+    }
+    ++histogram[bucket];
+}
+
+ssize_t TextureCache::uploadImageAsync(ImageInfo* imageInfo, ssize_t byteBudget, Texture2D*& texture)
 {
-    // the image is generated in loading thread
-    std::deque<ImageInfo*> *imagesQueue = _imageInfoQueue;
+    Image *image = imageInfo->image;
+    texture = nullptr;
 
-    _imageInfoMutex.lock();
-    if (imagesQueue->empty())
+    if (imageInfo->data == nullptr)
     {
-        _imageInfoMutex.unlock();
+        // compressed or with mipmaps, uploaded at once
+        texture = new (std::nothrow) Texture2D();
+        if (!texture->initWithImage(image, imageInfo->pixelFormat))
+        {
+            CC_SAFE_RELEASE_NULL(texture);
+        }
+        return image->getDataLen();
     }
-    else
+
+    if (_uploadingImageInfo == nullptr)
     {
-        ImageInfo *imageInfo = imagesQueue->front();
-        imagesQueue->pop_front();
-        _imageInfoMutex.unlock();
+        if (imageInfo->dataLen <= _asyncUploadByteBudget)
+        {
+            texture = new (std::nothrow) Texture2D();
+            if (!texture->initWithImageData(image, imageInfo->data, imageInfo->dataLen, imageInfo->pixelFormat, true))
+            {
+                CC_SAFE_RELEASE_NULL(texture);
+            }
+            return imageInfo->dataLen;
+        }
 
-        AsyncStruct *asyncStruct = imageInfo->asyncStruct;
-        Image *image = imageInfo->image;
+        // too big for a frame, allocate the texture now and upload it in bands of rows
+        _uploadingTexture = new (std::nothrow) Texture2D();
+        if (!_uploadingTexture->initWithImageData(image, imageInfo->data, imageInfo->dataLen, imageInfo->pixelFormat, false))
+        {
+            CC_SAFE_RELEASE_NULL(_uploadingTexture);
+            return 0;
+        }
+        _uploadingImageInfo = imageInfo;
+        _uploadedRows = 0;
+        ++_asyncUploadStats.splitTextures;
+    }
+
+    int height = image->getHeight();
+    ssize_t bytesPerRow = imageInfo->dataLen / height;
+    int rows = (int)std::max((ssize_t)1, byteBudget / bytesPerRow);
+    rows = std::min(rows, height - _uploadedRows);
+
+    _uploadingTexture->updateWithData(imageInfo->data + _uploadedRows * bytesPerRow, 0, _uploadedRows, image->getWidth(), rows);
+    _uploadedRows += rows;
+
+    if (_uploadedRows == height)
+    {
+        texture = _uploadingTexture;
+        _uploadingTexture = nullptr;
+        _uploadingImageInfo = nullptr;
+    }
+    return rows * bytesPerRow;
+}
+
+void TextureCache::addImageAsyncCallBack(float dt)
+{
+    auto start = std::chrono::steady_clock::now();
+    float elapsed = 0;
+    ssize_t uploadedBytes = 0;
+    bool uploaded = false;
+
+    // upload until the time or byte budget of the frame is spent, at least once
+    while (!uploaded || (elapsed < _asyncUploadBudget && uploadedBytes < _asyncUploadByteBudget))
+    {
+        ImageInfo *imageInfo = _uploadingImageInfo;
+        if (imageInfo == nullptr)
+        {
+            // the image is generated in loading thread
+            _imageInfoMutex.lock();
+            if (!_imageInfoQueue.empty())
+            {
+                // highest priority first, priorities are only changed on this thread
+                auto best = _imageInfoQueue.begin();
+                for (auto it = best + 1; it != _imageInfoQueue.end(); ++it)
+                {
+                    if ((*it)->asyncStruct->priority > (*best)->asyncStruct->priority)
+                        best = it;
+                }
+                imageInfo = *best;
+                _imageInfoQueue.erase(best);
+            }
+            _imageInfoMutex.unlock();
+
+            if (imageInfo == nullptr)
+            {
+                break;
+            }
+        }
 
+        AsyncStruct *asyncStruct = imageInfo->asyncStruct;
         const std::string& filename = asyncStruct->filename;
 
         Texture2D *texture = nullptr;
-        if (image)
+        auto it = _textures.find(filename);
+        if (asyncStruct->cancelled || it != _textures.end())
+        {
+            // cancelled, or loaded by addImage in the meantime
+            if (imageInfo == _uploadingImageInfo)
+            {
+                CC_SAFE_RELEASE_NULL(_uploadingTexture);
+                _uploadingImageInfo = nullptr;
+            }
+            if (!asyncStruct->cancelled)
+            {
+                texture = it->second;
+            }
+        }
+        else if (imageInfo->image)
         {
             // generate texture in render thread
-            texture = new (std::nothrow) Texture2D();
+            uploadedBytes += uploadImageAsync(imageInfo, _asyncUploadByteBudget - uploadedBytes, texture);
+            uploaded = true;
+            elapsed = std::chrono::duration_cast<std::chrono::duration<float, std::milli>>(std::chrono::steady_clock::now() - start).count();
 
-            texture->initWithImage(image);
+            if (imageInfo == _uploadingImageInfo)
+            {
+                // more rows to upload
+                continue;
+            }
 
+            if (texture)
+            {
 #if CC_ENABLE_CACHE_TEXTURE_DATA
-            // cache the texture file name
-            VolatileTextureMgr::addImageTexture(texture, filename);
+                // cache the texture file name
+                VolatileTextureMgr::addImageTexture(texture, filename);
 #endif
-            // cache the texture. retain it, since it is added in the map
-            _textures.insert( std::make_pair(filename, texture) );
-            texture->retain();
+                // cache the texture. retain it, since it is added in the map
+                _textures.insert( std::make_pair(filename, texture) );
+                texture->retain();
 
-            texture->autorelease();
+                texture->autorelease();
+            }
         }
-        else
+
+        if (texture && !asyncStruct->cancelled)
         {
-            auto it = _textures.find(asyncStruct->filename);
-            if(it != _textures.end())
-                texture = it->second;
+            auto latency = std::chrono::duration_cast<std::chrono::duration<float, std::milli>>(std::chrono::steady_clock::now() - asyncStruct->requestTime);
+            addToHistogram(_asyncUploadStats.latencyHistogram, latency.count());
+            ++_asyncUploadStats.textures;
         }
-        
-        if (asyncStruct->callback)
+
+        // a callback may add or cancel images, finish the request first
+        auto callbacks = std::move(asyncStruct->callbacks);
+        releaseImageInfo(imageInfo);
+        finishImageAsync(asyncStruct);
+
+        if (texture)
         {
-            asyncStruct->callback(texture);
+            for (const auto& callback : callbacks)
+            {
+                if (callback)
+                {
+                    callback(texture);
+                }
+            }
         }
-        
-        if(image)
-        {
-            image->release();
-        }       
-        delete asyncStruct;
-        delete imageInfo;
+    }
+
+    if (uploaded)
+    {
+        _asyncUploadStats.bytes += uploadedBytes;
+        addToHistogram(_asyncUploadStats.frameTimeHistogram, elapsed);
+    }
+}
 
-        --_asyncRefCount;
-        if (0 == _asyncRefCount)
+void TextureCache::resetAsyncUploadStats()
+{
+    memset(&_asyncUploadStats, 0, sizeof(_asyncUploadStats));
+}
+
+std::string TextureCache::getAsyncUploadStatsInfo() const
+{
+    std::string buffer = StringUtils::format("cocos2d: async textures: %u, uploaded in parts: %u, bytes: %ld\n",
+                                             _asyncUploadStats.textures, _asyncUploadStats.splitTextures, (long)_asyncUploadStats.bytes);
+
+    const char* titles[] = { "cocos2d: request latency:", "cocos2d: upload time per frame:" };
+    const unsigned int* histograms[] = { _asyncUploadStats.latencyHistogram, _asyncUploadStats.frameTimeHistogram };
+    for (int h = 0; h < 2; ++h)
+    {
+        buffer += titles[h];
+        float limit = 0.25f;
+        for (int i = 0; i < AsyncUploadStats::HISTOGRAM_SIZE; ++i, limit *= 2)
         {
-            Director::getInstance()->getScheduler()->unschedule(schedule_selector(TextureCache::addImageAsyncCallBack), this);
+            if (histograms[h][i] == 0)
+                continue;
+            if (i < AsyncUploadStats::HISTOGRAM_SIZE - 1)
+                buffer += StringUtils::format(" <%gms: %u", limit, histograms[h][i]);
+            else
+                buffer += StringUtils::format(" >=%gms: %u", limit / 2, histograms[h][i]);
         }
+        buffer += "\n";
     }
+    return buffer;
 }
 
 Texture2D * TextureCache::addImage(const std::string &path)
@@ -523,10 +778,8 @@ void TextureCache::reloadAllTextures()
 
 void TextureCache::waitForQuit()
 {
-    // notify sub thread to quick
-    _needQuit = true;
-    _sleepCondition.notify_one();
-    if (_loadingThread) _loadingThread->join();
+    // notify sub threads to quit
+    stopLoadingThreads();
 }
 
 std::string TextureCache::getCachedTextureInfo() const
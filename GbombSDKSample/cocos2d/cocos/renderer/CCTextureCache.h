@@ -33,9 +33,11 @@ THE SOFTWARE.
 #include <thread>
 #include <condition_variable>
 #include <queue>
+#include <vector>
 #include <string>
 #include <unordered_map>
 #include <functional>
+#include <chrono>
 
 #include "base/CCRef.h"
 #include "renderer/CCTexture2D.h"
@@ -118,6 +120,61 @@ public:
     * @since v0.8
     */
     virtual void addImageAsync(const std::string &filepath, const std::function<void(Texture2D*)>& callback);
+
+    /* Same as addImageAsync, images of higher priority are decoded and uploaded first.
+     * Requests of the same priority are served in order. Adding a file that is already being loaded
+     * adds the callback to that request and raises its priority if needed.
+     * @since v3.3
+     */
+    virtual void addImageAsync(const std::string &filepath, const std::function<void(Texture2D*)>& callback, int priority);
+
+    /* Cancel the asynchronous loading of an image, its callbacks are not called and no texture is created.
+     * Returns false if the image wasn't being loaded.
+     * @since v3.3
+     */
+    bool cancelImageAsync(const std::string &filename);
+
+    /* Sets the number of threads decoding images for addImageAsync.
+     * The default is one less than the number of cores, between 1 and 4.
+     * @since v3.3
+     */
+    void setLoadingThreadCount(int count);
+    int getLoadingThreadCount() const { return _loadingThreadCount; }
+
+    /* Sets how many milliseconds per frame may be spent creating textures of decoded images.
+     * At least one upload is done every frame. The default is 4 milliseconds.
+     * @since v3.3
+     */
+    void setAsyncUploadBudget(float milliseconds) { _asyncUploadBudget = milliseconds; }
+    float getAsyncUploadBudget() const { return _asyncUploadBudget; }
+
+    /* Sets how many bytes of decoded images may be uploaded per frame. The default is 2 MB.
+     * An uncompressed image bigger than that is uploaded in bands of rows over several frames,
+     * its callbacks are called when the last band is uploaded.
+     * @since v3.3
+     */
+    void setAsyncUploadByteBudget(ssize_t bytes) { _asyncUploadByteBudget = bytes; }
+    ssize_t getAsyncUploadByteBudget() const { return _asyncUploadByteBudget; }
+
+    /* Statistics of the textures created by addImageAsync */
+    struct AsyncUploadStats
+    {
+        // bucket i counts the values under 2^(i - 2) milliseconds, the last bucket counts the rest
+        static const int HISTOGRAM_SIZE = 14;
+
+        // requests by time from addImageAsync to the callbacks
+        unsigned int latencyHistogram[HISTOGRAM_SIZE];
+        // frames by time spent uploading
+        unsigned int frameTimeHistogram[HISTOGRAM_SIZE];
+        unsigned int textures;
+        // textures uploaded over several frames
+        unsigned int splitTextures;
+        ssize_t bytes;
+    };
+    const AsyncUploadStats& getAsyncUploadStats() const { return _asyncUploadStats; }
+    void resetAsyncUploadStats();
+    /* Returns the statistics as text, for CCLOG */
+    std::string getAsyncUploadStatsInfo() const;
     
     /* Unbind a specified bound image asynchronous callback
      * In the case an object who was bound to an image asynchronous callback was destroyed before the callback is invoked,
@@ -192,15 +249,26 @@ public:
 private:
     void addImageAsyncCallBack(float dt);
     void loadImage();
+    void startLoadingThreads();
+    void stopLoadingThreads();
 
 public:
     struct AsyncStruct
     {
     public:
-        AsyncStruct(const std::string& fn, std::function<void(Texture2D*)> f) : filename(fn), callback(f) {}
+        AsyncStruct(const std::string& fn, std::function<void(Texture2D*)> f, int p, unsigned int seq)
+        : filename(fn), priority(p), sequence(seq), cancelled(false)
+        , pixelFormat(Texture2D::getDefaultAlphaPixelFormat()), requestTime(std::chrono::steady_clock::now()) { callbacks.push_back(f); }
 
         std::string filename;
-        std::function<void(Texture2D*)> callback;
+        // callbacks of every addImageAsync of this file, only used on the main thread
+        std::vector<std::function<void(Texture2D*)>> callbacks;
+        int priority;
+        unsigned int sequence;
+        bool cancelled;
+        // the default alpha pixel format when the image was requested
+        Texture2D::PixelFormat pixelFormat;
+        std::chrono::steady_clock::time_point requestTime;
     };
 
 protected:
@@ -208,22 +276,43 @@ protected:
     {
         AsyncStruct *asyncStruct;
         Image        *image;
+        // converted to the pixel format of the texture by the loading thread, nullptr if the image is compressed or has mipmaps
+        unsigned char *data;
+        ssize_t       dataLen;
+        Texture2D::PixelFormat pixelFormat;
     } ImageInfo;
+
+    // called on the main thread when a request is done, successfully or not
+    void finishImageAsync(AsyncStruct* asyncStruct);
+    // uploads the image, or its next band of rows, returns the bytes uploaded and sets texture once it is complete
+    ssize_t uploadImageAsync(ImageInfo* imageInfo, ssize_t byteBudget, Texture2D*& texture);
+    void releaseImageInfo(ImageInfo* imageInfo);
     
-    std::thread* _loadingThread;
+    std::vector<std::thread> _loadingThreads;
+    int _loadingThreadCount;
 
-    std::queue<AsyncStruct*>* _asyncStructQueue;
-    std::deque<ImageInfo*>* _imageInfoQueue;
+    // requests waiting for a loading thread, a heap ordered by priority
+    std::vector<AsyncStruct*> _asyncStructQueue;
+    // requests not finished yet, by full path
+    std::unordered_map<std::string, AsyncStruct*> _asyncStructs;
+    std::deque<ImageInfo*> _imageInfoQueue;
+    unsigned int _asyncSequence;
 
     std::mutex _asyncStructQueueMutex;
     std::mutex _imageInfoMutex;
 
-    std::mutex _sleepMutex;
     std::condition_variable _sleepCondition;
 
     bool _needQuit;
 
     int _asyncRefCount;
+    float _asyncUploadBudget;
+    ssize_t _asyncUploadByteBudget;
+    // image uploaded over several frames and its texture
+    ImageInfo* _uploadingImageInfo;
+    Texture2D* _uploadingTexture;
+    int _uploadedRows;
+    AsyncUploadStats _asyncUploadStats;
 
     std::unordered_map<std::string, Texture2D*> _textures;
 };
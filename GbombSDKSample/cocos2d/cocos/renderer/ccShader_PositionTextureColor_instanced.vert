@@ -0,0 +1,28 @@
+
+const char* ccPositionTextureColor_instanced_vert = STRINGIFY(
+
+// corner of the quad, from (0, 0) to (1, 1)
+attribute vec4 a_position;
+
+// per instance: color, texture rect (left, bottom, right, top), axes and origin of the quad
+attribute vec4 a_color;
+attribute vec4 a_texCoord;
+attribute vec4 a_texCoord1;
+attribute vec2 a_texCoord2;
+
+\n#ifdef GL_ES\n
+varying lowp vec4 v_fragmentColor;
+varying mediump vec2 v_texCoord;
+\n#else\n
+varying vec4 v_fragmentColor;
+varying vec2 v_texCoord;
+\n#endif\n
+
+void main()
+{
+    vec2 position = a_texCoord2 + a_texCoord1.xy * a_position.x + a_texCoord1.zw * a_position.y;
+    gl_Position = CC_MVPMatrix * vec4(position, 0.0, 1.0);
+    v_fragmentColor = a_color;
+    v_texCoord = mix(a_texCoord.xy, a_texCoord.zw, a_position.xy);
+}
+);
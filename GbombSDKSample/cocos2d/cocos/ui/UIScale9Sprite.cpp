@@ -746,8 +746,12 @@ y+=ytranslate;         \
         // but it is deprecated and your code should not rely on it
         Director* director = Director::getInstance();
         CCASSERT(nullptr != director, "Director is null when seting matrix stack");
-        director->pushMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW);
-        director->loadMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW, _modelViewTransform);
+        bool legacyMatrixStack = usesLegacyMatrixStack();
+        if (legacyMatrixStack)
+        {
+            director->pushMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW);
+            director->loadMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW, _modelViewTransform);
+        }
         
         int i = 0;      // used by _children
         int j = 0;      // used by _protectedChildren
@@ -818,7 +822,8 @@ y+=ytranslate;         \
         // Please refer to https://github.com/cocos2d/cocos2d-x/pull/6920
         // setOrderOfArrival(0);
         
-        director->popMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW);
+        if (legacyMatrixStack)
+            director->popMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW);
         
     }
     
@@ -903,7 +908,7 @@ y+=ytranslate;         \
         }
         if( _reorderProtectedChildDirty )
         {
-            std::sort( std::begin(_protectedChildren), std::end(_protectedChildren), nodeComparisonLess );
+            sortNodes(_protectedChildren);
             _reorderProtectedChildDirty = false;
         }
     }
@@ -204,6 +204,8 @@ public:
     
     //override the widget's hitTest function to perfom its own
     virtual bool hitTest(const Vec2 &pt) override;
+    // the ball goes past the ends of the bar
+    virtual bool isHitTestInContentSize() const override { return false; }
     /**
      * Returns the "class name" of widget.
      */
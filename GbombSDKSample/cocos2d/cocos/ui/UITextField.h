@@ -132,6 +132,8 @@ public:
     Size getTouchSize()const;
     void setTouchAreaEnabled(bool enable);
     virtual bool hitTest(const Vec2 &pt);
+    // the touch area can be bigger than the content size
+    virtual bool isHitTestInContentSize() const override { return false; }
     
     void setPlaceHolder(const std::string& value);
     const std::string& getPlaceHolder()const;
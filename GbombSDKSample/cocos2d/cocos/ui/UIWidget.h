@@ -427,6 +427,12 @@ public:
      */
     virtual bool hitTest(const Vec2 &pt);
 
+    /**
+     * Whether hitTest() only accepts the points inside the content size, which lets the EventDispatcher
+     * skip the widget for the touches outside of it. Widgets overriding hitTest() with a bigger area return false.
+     */
+    virtual bool isHitTestInContentSize() const { return true; }
+
     virtual bool onTouchBegan(Touch *touch, Event *unusedEvent);
     virtual void onTouchMoved(Touch *touch, Event *unusedEvent);
     virtual void onTouchEnded(Touch *touch, Event *unusedEvent);
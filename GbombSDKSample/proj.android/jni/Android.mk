@@ -19,7 +19,14 @@ LOCAL_MODULE_FILENAME := libcocos2dcpp
 
 LOCAL_SRC_FILES := hellocpp/main.cpp \
                    ../../Classes/AppDelegate.cpp \
-                   ../../Classes/HelloWorldScene.cpp
+                   ../../Classes/GbombAsyncClient.cpp \
+                   ../../Classes/GbombProductCache.cpp \
+                   ../../Classes/GbombResult.cpp \
+                   ../../Classes/HelloWorldScene.cpp \
+                   ../../Classes/SpriteBenchmarkScene.cpp \
+                   ../../Classes/RenderQueueSortBenchmarkScene.cpp \
+                   ../../Classes/MatrixStackBenchmarkScene.cpp \
+                   ../../Classes/SchedulerBenchmarkScene.cpp
 
 LOCAL_C_INCLUDES := $(LOCAL_PATH)/../../Classes \
 	#$(LOCAL_PATH)/../../../GbombSDKWrapper/jni/include